@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_UNIT_TESTS
+
+class AudioBufferAllocationPolicyTests  : public UnitTest
+{
+public:
+    AudioBufferAllocationPolicyTests()
+        : UnitTest ("AudioBuffer allocation policy", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Aligned channels start on a cache line");
+        {
+            checkAlignedLayouts<float>();
+            checkAlignedLayouts<double>();
+        }
+
+        beginTest ("Packed buffers have no padding");
+        {
+            AudioBuffer<float> buffer (3, 37);
+            expect (buffer.getAllocationPolicy() == AudioBuffer<float>::AllocationPolicy::packed);
+            expectEquals (buffer.getNumPaddedSamples(), 37);
+
+            buffer.setAllocationPolicy (AudioBuffer<float>::AllocationPolicy::aligned);
+            expectEquals (buffer.getNumPaddedSamples(), 48);
+        }
+
+        beginTest ("setSize keeps the policy and the contents");
+        {
+            AudioBuffer<float> buffer (2, 100, AudioBuffer<float>::AllocationPolicy::aligned);
+            fill (buffer);
+
+            buffer.setSize (5, 300, true);
+            expect (buffer.getAllocationPolicy() == AudioBuffer<float>::AllocationPolicy::aligned);
+            expectAligned (buffer);
+            expect (matches (buffer, 2, 100));
+
+            buffer.setSize (3, 50);
+            expectAligned (buffer);
+        }
+
+        beginTest ("setSize can shrink without reallocating");
+        {
+            AudioBuffer<float> buffer (4, 200, AudioBuffer<float>::AllocationPolicy::aligned);
+            fill (buffer);
+            auto* firstChannel = buffer.getReadPointer (0);
+            auto* lastKept = buffer.getReadPointer (2);
+
+            buffer.setSize (3, 150, true, false, true);
+            expect (buffer.getReadPointer (0) == firstChannel);
+            expect (buffer.getReadPointer (2) == lastKept);
+            expect (matches (buffer, 3, 150));
+
+            buffer.setSize (2, 100, false, false, true);
+            expect (buffer.getReadPointer (0) == firstChannel);
+            expectAligned (buffer);
+
+            buffer.setSize (2, 300, false, false, true);
+            expectAligned (buffer);
+        }
+
+        beginTest ("Changing the policy keeps the contents");
+        {
+            AudioBuffer<float> buffer (3, 77);
+            fill (buffer);
+
+            buffer.setAllocationPolicy (AudioBuffer<float>::AllocationPolicy::aligned);
+            expectAligned (buffer);
+            expect (matches (buffer, 3, 77));
+
+            buffer.setAllocationPolicy (AudioBuffer<float>::AllocationPolicy::packed);
+            expect (buffer.getAllocationPolicy() == AudioBuffer<float>::AllocationPolicy::packed);
+            expectEquals (buffer.getNumPaddedSamples(), 77);
+            expect (matches (buffer, 3, 77));
+
+            buffer.setAllocationPolicy (AudioBuffer<float>::AllocationPolicy::aligned);
+            expectAligned (buffer);
+            expect (matches (buffer, 3, 77));
+
+            buffer.clear();
+            buffer.setAllocationPolicy (AudioBuffer<float>::AllocationPolicy::packed);
+            expect (buffer.hasBeenCleared());
+        }
+
+        beginTest ("Copies take the policy, assignments keep their own");
+        {
+            AudioBuffer<float> aligned (2, 45, AudioBuffer<float>::AllocationPolicy::aligned);
+            fill (aligned);
+
+            AudioBuffer<float> copy (aligned);
+            expect (copy.getAllocationPolicy() == AudioBuffer<float>::AllocationPolicy::aligned);
+            expectAligned (copy);
+            expect (matches (copy, 2, 45));
+
+            AudioBuffer<float> packed (1, 10);
+            packed = aligned;
+            expect (packed.getAllocationPolicy() == AudioBuffer<float>::AllocationPolicy::packed);
+            expect (matches (packed, 2, 45));
+
+            AudioBuffer<float> alignedTarget (1, 10, AudioBuffer<float>::AllocationPolicy::aligned);
+            alignedTarget = packed;
+            expectAligned (alignedTarget);
+            expect (matches (alignedTarget, 2, 45));
+
+            AudioBuffer<float> moved (std::move (copy));
+            expectAligned (moved);
+            expect (matches (moved, 2, 45));
+        }
+
+        beginTest ("clear() covers the padding");
+        {
+            AudioBuffer<float> buffer (2, 33, AudioBuffer<float>::AllocationPolicy::aligned);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                FloatVectorOperations::fill (buffer.getWritePointer (ch), 1.0f, buffer.getNumPaddedSamples());
+
+            buffer.clear();
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                for (int i = 0; i < buffer.getNumPaddedSamples(); ++i)
+                    expectEquals (buffer.getReadPointer (ch)[i], 0.0f);
+        }
+    }
+
+private:
+    template <typename Type>
+    void checkAlignedLayouts()
+    {
+        for (int numChannels : { 0, 1, 2, 7, 33 })
+        {
+            for (int numSamples : { 0, 1, 15, 16, 17, 63, 1000 })
+            {
+                AudioBuffer<Type> buffer (numChannels, numSamples, AudioBuffer<Type>::AllocationPolicy::aligned);
+                expectAligned (buffer);
+            }
+        }
+    }
+
+    template <typename Type>
+    void expectAligned (const AudioBuffer<Type>& buffer)
+    {
+        constexpr auto samplesPerLine = (int) (AudioBuffer<Type>::alignedChannelBytes / sizeof (Type));
+        const auto numPadded = buffer.getNumPaddedSamples();
+
+        expect (buffer.getAllocationPolicy() == AudioBuffer<Type>::AllocationPolicy::aligned);
+        expect (numPadded >= buffer.getNumSamples());
+        expect (numPadded % samplesPerLine == 0);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* channel = buffer.getReadPointer (ch);
+            expectEquals ((int) (reinterpret_cast<pointer_sized_uint> (channel) % AudioBuffer<Type>::alignedChannelBytes), 0);
+
+            if (ch > 0)
+                expect (channel - buffer.getReadPointer (ch - 1) >= numPadded);
+        }
+    }
+
+    static void fill (AudioBuffer<float>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, (float) (ch * 1000 + i));
+    }
+
+    static bool matches (const AudioBuffer<float>& buffer, int numChannels, int numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                if (buffer.getSample (ch, i) != (float) (ch * 1000 + i))
+                    return false;
+
+        return true;
+    }
+};
+
+static AudioBufferAllocationPolicyTests audioBufferAllocationPolicyTests;
+
+#endif
+
+} // namespace juce
@@ -80,6 +80,26 @@ template <typename Type>
 class AudioBuffer
 {
 public:
+    //==============================================================================
+    /** How a buffer lays out the channels that it allocates itself. */
+    enum class AllocationPolicy
+    {
+        /** Each channel straight after the one before, taking the least memory. */
+        packed,
+
+        /** Each channel starts on a cache line, and has room for a whole number of
+            cache lines of samples. So vector code can use aligned loads and stores
+            throughout, and can run on into the padding instead of finishing the
+            last few samples one at a time. @see getNumPaddedSamples
+        */
+        aligned
+    };
+
+    /** The alignment of the channels of an AllocationPolicy::aligned buffer: one
+        cache line, which is also the width of the widest SIMD registers.
+    */
+    static constexpr size_t alignedChannelBytes = 64;
+
     //==============================================================================
     /** Creates an empty buffer with 0 channels and 0 length. */
     AudioBuffer() noexcept
@@ -106,6 +126,23 @@ public:
         allocateData();
     }
 
+    /** Creates a buffer with a specified number of channels and samples, laid
+        out with the given policy. This and any later reallocations use it.
+
+        The contents of the buffer will initially be undefined, so use clear() to
+        set all the samples to zero.
+    */
+    AudioBuffer (int numChannelsToAllocate,
+                 int numSamplesToAllocate,
+                 AllocationPolicy policy)
+       : numChannels (numChannelsToAllocate),
+         size (numSamplesToAllocate),
+         allocationPolicy (policy)
+    {
+        jassert (size >= 0 && numChannels >= 0);
+        allocateData();
+    }
+
     /** Creates a buffer using a pre-allocated block of memory.
 
         Note that if the buffer is resized or its number of channels is changed, it
@@ -169,7 +206,8 @@ public:
     AudioBuffer (const AudioBuffer& other)
        : numChannels (other.numChannels),
          size (other.size),
-         allocatedBytes (other.allocatedBytes)
+         allocatedBytes (other.allocatedBytes),
+         allocationPolicy (other.allocationPolicy)
     {
         if (allocatedBytes == 0)
         {
@@ -185,14 +223,21 @@ public:
             }
             else
             {
+                auto numToCopy = getNumWholeChannelSamples (other);
+
                 for (int i = 0; i < numChannels; ++i)
-                    FloatVectorOperations::copy (channels[i], other.channels[i], size);
+                    FloatVectorOperations::copy (channels[i], other.channels[i], numToCopy);
             }
         }
     }
 
     /** Copies another buffer onto this one.
         This buffer's size will be changed to that of the other buffer.
+
+        Unlike the copy constructor, this keeps the buffer's own AllocationPolicy
+        rather than taking the other's, so a buffer that was set up as aligned
+        stays aligned whatever is assigned to it. Call setAllocationPolicy() to
+        change it.
     */
     AudioBuffer& operator= (const AudioBuffer& other)
     {
@@ -207,9 +252,10 @@ public:
             else
             {
                 isClear = false;
+                auto numToCopy = getNumWholeChannelSamples (other);
 
                 for (int i = 0; i < numChannels; ++i)
-                    FloatVectorOperations::copy (channels[i], other.channels[i], size);
+                    FloatVectorOperations::copy (channels[i], other.channels[i], numToCopy);
             }
         }
 
@@ -227,6 +273,7 @@ public:
           size (other.size),
           allocatedBytes (other.allocatedBytes),
           allocatedData (std::move (other.allocatedData)),
+          allocationPolicy (other.allocationPolicy),
           isClear (other.isClear.load())
     {
         if (numChannels < (int) numElementsInArray (preallocatedChannelSpace))
@@ -253,6 +300,7 @@ public:
         size = other.size;
         allocatedBytes = other.allocatedBytes;
         allocatedData = std::move (other.allocatedData);
+        allocationPolicy = other.allocationPolicy;
         isClear = other.isClear.load();
 
         if (numChannels < (int) numElementsInArray (preallocatedChannelSpace))
@@ -284,6 +332,50 @@ public:
     */
     int getNumSamples() const noexcept                              { return size; }
 
+    /** Returns the number of samples there is room for in each channel, which is
+        getNumSamples() rounded up to a whole cache line when the buffer allocated
+        its channels with AllocationPolicy::aligned. Vector code may read and write
+        up to here, but the samples past getNumSamples() are undefined, and aren't
+        kept when the buffer is copied or resized. clear() and the copies of whole
+        channels run on to here themselves, so their vector loops have no scalar
+        tail.
+        @see AllocationPolicy
+    */
+    int getNumPaddedSamples() const noexcept
+    {
+        return allocatedBytes != 0 && allocationPolicy == AllocationPolicy::aligned ? (int) getSamplesPerChannel (size) : size;
+    }
+
+    /** Returns the policy that the buffer lays out its channels with. */
+    AllocationPolicy getAllocationPolicy() const noexcept           { return allocationPolicy; }
+
+    /** Changes how the buffer lays out its channels. If it has allocated its own,
+        they are moved into the new layout, keeping their contents; a buffer that
+        refers to external data uses the policy once it is next resized.
+
+        If the required memory can't be allocated, this will throw a std::bad_alloc exception.
+    */
+    void setAllocationPolicy (AllocationPolicy newPolicy)
+    {
+        if (newPolicy == allocationPolicy)
+            return;
+
+        if (allocatedBytes != 0)
+        {
+            AudioBuffer relaidOut (numChannels, size, newPolicy);
+
+            if (isClear)
+                relaidOut.clear();
+            else
+                for (int i = 0; i < numChannels; ++i)
+                    FloatVectorOperations::copy (relaidOut.channels[i], channels[i], relaidOut.getNumWholeChannelSamples (*this));
+
+            *this = std::move (relaidOut);
+        }
+
+        allocationPolicy = newPolicy;
+    }
+
     /** Returns a pointer to an array of read-only samples in one of the buffer's channels.
         For speed, this doesn't check whether the channel number is out of range,
         so be careful when using it!
@@ -386,10 +478,10 @@ public:
 
         if (newNumSamples != size || newNumChannels != numChannels)
         {
-            auto allocatedSamplesPerChannel = ((size_t) newNumSamples + 3) & ~3u;
-            auto channelListSize = ((static_cast<size_t> (1 + newNumChannels) * sizeof (Type*)) + 15) & ~15u;
+            auto allocatedSamplesPerChannel = getSamplesPerChannel (newNumSamples);
+            auto channelListSize = getChannelListSize (newNumChannels);
             auto newTotalBytes = ((size_t) newNumChannels * (size_t) allocatedSamplesPerChannel * sizeof (Type))
-                                    + channelListSize + 32;
+                                    + channelListSize + getAlignmentSlack();
 
             if (keepExistingContent)
             {
@@ -404,8 +496,8 @@ public:
 
                     auto numSamplesToCopy = (size_t) jmin (newNumSamples, size);
 
-                    auto newChannels = unalignedPointerCast<Type**> (newData.get());
-                    auto newChan     = unalignedPointerCast<Type*> (newData + channelListSize);
+                    auto newChannels = unalignedPointerCast<Type**> (getAlignedStart (newData));
+                    auto newChan     = unalignedPointerCast<Type*> (getAlignedStart (newData) + channelListSize);
 
                     for (int j = 0; j < newNumChannels; ++j)
                     {
@@ -437,10 +529,10 @@ public:
                 {
                     allocatedBytes = newTotalBytes;
                     allocatedData.allocate (newTotalBytes, clearExtraSpace || isClear);
-                    channels = unalignedPointerCast<Type**> (allocatedData.get());
                 }
 
-                auto* chan = unalignedPointerCast<Type*> (allocatedData + channelListSize);
+                channels = unalignedPointerCast<Type**> (getAlignedStart (allocatedData));
+                auto* chan = unalignedPointerCast<Type*> (getAlignedStart (allocatedData) + channelListSize);
 
                 for (int i = 0; i < newNumChannels; ++i)
                 {
@@ -554,8 +646,10 @@ public:
     {
         if (! isClear)
         {
+            auto numToClear = getNumPaddedSamples();
+
             for (int i = 0; i < numChannels; ++i)
-                FloatVectorOperations::clear (channels[i], size);
+                FloatVectorOperations::clear (channels[i], numToClear);
 
             isClear = true;
         }
@@ -1118,8 +1212,47 @@ private:
     Type** channels;
     HeapBlock<char, true> allocatedData;
     Type* preallocatedChannelSpace[32];
+    AllocationPolicy allocationPolicy = AllocationPolicy::packed;
     std::atomic<bool> isClear { false };
 
+    // The layout that setSize() allocates with: packed channels are rounded up to
+    // four samples after a 16-byte aligned list, aligned ones to whole cache lines
+    size_t getSamplesPerChannel (int numSamples) const noexcept
+    {
+        if (allocationPolicy == AllocationPolicy::aligned)
+        {
+            constexpr auto samplesPerLine = alignedChannelBytes / sizeof (Type);
+            return ((size_t) numSamples + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+        }
+
+        return ((size_t) numSamples + 3) & ~3u;
+    }
+
+    size_t getChannelListSize (int numChans) const noexcept
+    {
+        auto alignment = allocationPolicy == AllocationPolicy::aligned ? alignedChannelBytes : (size_t) 16;
+        return ((static_cast<size_t> (1 + numChans) * sizeof (Type*)) + alignment - 1) & ~(alignment - 1);
+    }
+
+    // The samples that a copy of whole channels between two buffers may cover:
+    // into the padding, if both of them have it
+    int getNumWholeChannelSamples (const AudioBuffer& other) const noexcept
+    {
+        return jmin (getNumPaddedSamples(), other.getNumPaddedSamples());
+    }
+
+    // Aligned buffers are laid out from the first cache line of the block
+    size_t getAlignmentSlack() const noexcept
+    {
+        return allocationPolicy == AllocationPolicy::aligned ? alignedChannelBytes : 32;
+    }
+
+    char* getAlignedStart (HeapBlock<char, true>& block) const noexcept
+    {
+        return allocationPolicy == AllocationPolicy::aligned ? snapPointerToAlignment (block.get(), alignedChannelBytes)
+                                                             : block.get();
+    }
+
     void allocateData()
     {
        #if ! JUCE_PROJUCER_LIVE_BUILD && (! JUCE_GCC || (__GNUC__ * 100 + __GNUC_MINOR__) >= 409)
@@ -1128,6 +1261,27 @@ private:
        #endif
         jassert (size >= 0);
 
+        if (allocationPolicy == AllocationPolicy::aligned)
+        {
+            auto samplesPerChannel = getSamplesPerChannel (size);
+            auto channelListSize = getChannelListSize (numChannels);
+
+            allocatedBytes = (size_t) numChannels * samplesPerChannel * sizeof (Type) + channelListSize + getAlignmentSlack();
+            allocatedData.malloc (allocatedBytes);
+            channels = unalignedPointerCast<Type**> (getAlignedStart (allocatedData));
+            auto chan = unalignedPointerCast<Type*> (getAlignedStart (allocatedData) + channelListSize);
+
+            for (int i = 0; i < numChannels; ++i)
+            {
+                channels[i] = chan;
+                chan += samplesPerChannel;
+            }
+
+            channels[numChannels] = nullptr;
+            isClear = false;
+            return;
+        }
+
         auto channelListSize = (size_t) (numChannels + 1) * sizeof (Type*);
         auto requiredSampleAlignment = std::alignment_of<Type>::value;
         size_t alignmentOverflow = channelListSize % requiredSampleAlignment;
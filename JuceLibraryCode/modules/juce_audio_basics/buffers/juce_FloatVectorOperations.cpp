@@ -65,6 +65,14 @@ namespace FloatVectorHelpers
 
         static forcedinline Type max (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return jmax (v[0], v[1], v[2], v[3]); }
         static forcedinline Type min (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return jmin (v[0], v[1], v[2], v[3]); }
+        static forcedinline Type sum (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return (v[0] + v[1]) + (v[2] + v[3]); }
+
+        // Turns four registers of four values into their columns
+        static forcedinline void transpose (ParallelType& a, ParallelType& b, ParallelType& c, ParallelType& d) noexcept  { _MM_TRANSPOSE4_PS (a, b, c, d); }
+
+        // Interleaves two registers into pairs, and back
+        static forcedinline void zip (ParallelType& a, ParallelType& b) noexcept    { const auto lo = _mm_unpacklo_ps (a, b); b = _mm_unpackhi_ps (a, b); a = lo; }
+        static forcedinline void unzip (ParallelType& a, ParallelType& b) noexcept  { const auto even = _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)); b = _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)); a = even; }
     };
 
     struct BasicOps64
@@ -97,6 +105,7 @@ namespace FloatVectorHelpers
 
         static forcedinline Type max (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return jmax (v[0], v[1]); }
         static forcedinline Type min (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return jmin (v[0], v[1]); }
+        static forcedinline Type sum (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return v[0] + v[1]; }
     };
 
 
@@ -230,6 +239,21 @@ namespace FloatVectorHelpers
 
         static forcedinline Type max (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return jmax (v[0], v[1], v[2], v[3]); }
         static forcedinline Type min (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return jmin (v[0], v[1], v[2], v[3]); }
+        static forcedinline Type sum (ParallelType a) noexcept { Type v[numParallel]; storeU (v, a); return (v[0] + v[1]) + (v[2] + v[3]); }
+
+        // Turns four registers of four values into their columns
+        static forcedinline void transpose (ParallelType& a, ParallelType& b, ParallelType& c, ParallelType& d) noexcept
+        {
+            const auto ab = vtrnq_f32 (a, b), cd = vtrnq_f32 (c, d);
+            a = vcombine_f32 (vget_low_f32 (ab.val[0]),  vget_low_f32 (cd.val[0]));
+            b = vcombine_f32 (vget_low_f32 (ab.val[1]),  vget_low_f32 (cd.val[1]));
+            c = vcombine_f32 (vget_high_f32 (ab.val[0]), vget_high_f32 (cd.val[0]));
+            d = vcombine_f32 (vget_high_f32 (ab.val[1]), vget_high_f32 (cd.val[1]));
+        }
+
+        // Interleaves two registers into pairs, and back
+        static forcedinline void zip (ParallelType& a, ParallelType& b) noexcept    { const auto z = vzipq_f32 (a, b); a = z.val[0]; b = z.val[1]; }
+        static forcedinline void unzip (ParallelType& a, ParallelType& b) noexcept  { const auto u = vuzpq_f32 (a, b); a = u.val[0]; b = u.val[1]; }
     };
 
     struct BasicOps64
@@ -262,6 +286,7 @@ namespace FloatVectorHelpers
 
         static forcedinline Type max (ParallelType a) noexcept  { return a; }
         static forcedinline Type min (ParallelType a) noexcept  { return a; }
+        static forcedinline Type sum (ParallelType a) noexcept  { return a; }
     };
 
     #define JUCE_BEGIN_VEC_OP \
@@ -484,6 +509,542 @@ namespace FloatVectorHelpers
             return Range<Type>::findMinAndMax (src, num);
         }
     };
+
+    template <typename Mode>
+    struct Sums
+    {
+        using Type = typename Mode::Type;
+
+        // Two running sums, so that each add needn't wait for the one before
+        static Type dotProduct (const Type* src1, const Type* src2, int num) noexcept
+        {
+            auto sum1 = Mode::load1 (Type()), sum2 = sum1;
+            int i = 0;
+
+            for (; i <= num - 2 * Mode::numParallel; i += 2 * Mode::numParallel)
+            {
+                sum1 = Mode::add (sum1, Mode::mul (Mode::loadU (src1 + i), Mode::loadU (src2 + i)));
+                sum2 = Mode::add (sum2, Mode::mul (Mode::loadU (src1 + i + Mode::numParallel), Mode::loadU (src2 + i + Mode::numParallel)));
+            }
+
+            Type result = Mode::sum (Mode::add (sum1, sum2));
+
+            for (; i < num; ++i)
+                result += src1[i] * src2[i];
+
+            return result;
+        }
+    };
+
+    /** Interleaves four frames at a time, with a transpose for each group of
+        four channels. A frame is written a whole register per group, so when
+        the last group is part-filled it spills into the next frame, which is
+        written over it afterwards. Both functions return the number of frames
+        they did, and stop while the last register is still inside the array.
+
+        Stereo, where nearly every store would overlap the one before, zips
+        the two channels instead.
+     */
+    struct Interleaving
+    {
+        using Mode = BasicOps32;
+        using ParallelType = Mode::ParallelType;
+
+        static int interleaveStereo (float* dest, const float* const* sources, int num) noexcept
+        {
+            int i = 0;
+
+            for (; i <= num - Mode::numParallel; i += Mode::numParallel)
+            {
+                auto a = Mode::loadU (sources[0] + i), b = Mode::loadU (sources[1] + i);
+                Mode::zip (a, b);
+                Mode::storeU (dest + 2 * i, a);
+                Mode::storeU (dest + 2 * i + Mode::numParallel, b);
+            }
+
+            return i;
+        }
+
+        static int deinterleaveStereo (float* const* dests, const float* src, int num) noexcept
+        {
+            int i = 0;
+
+            for (; i <= num - Mode::numParallel; i += Mode::numParallel)
+            {
+                auto a = Mode::loadU (src + 2 * i), b = Mode::loadU (src + 2 * i + Mode::numParallel);
+                Mode::unzip (a, b);
+                Mode::storeU (dests[0] + i, a);
+                Mode::storeU (dests[1] + i, b);
+            }
+
+            return i;
+        }
+
+        template <int numChannels>
+        static int interleave (float* dest, const float* const* sources, int num) noexcept
+        {
+            constexpr int numGroups = (numChannels + 3) / 4;
+            const auto zero = Mode::load1 (0.0f);
+            int i = 0;
+
+            for (; (i + 3) * numChannels + 4 * numGroups <= num * numChannels; i += 4)
+            {
+                ParallelType frames[numGroups][4];
+
+                for (int group = 0; group < numGroups; ++group)
+                {
+                    auto* v = frames[group];
+
+                    for (int k = 0; k < 4; ++k)
+                        v[k] = 4 * group + k < numChannels ? Mode::loadU (sources[4 * group + k] + i) : zero;
+
+                    Mode::transpose (v[0], v[1], v[2], v[3]);
+                }
+
+                for (int frame = 0; frame < 4; ++frame)
+                    for (int group = 0; group < numGroups; ++group)
+                        Mode::storeU (dest + (i + frame) * numChannels + 4 * group, frames[group][frame]);
+            }
+
+            return i;
+        }
+
+        template <int numChannels>
+        static int deinterleave (float* const* dests, const float* src, int num) noexcept
+        {
+            constexpr int numGroups = (numChannels + 3) / 4;
+            int i = 0;
+
+            for (; (i + 3) * numChannels + 4 * numGroups <= num * numChannels; i += 4)
+            {
+                for (int group = 0; group < numGroups; ++group)
+                {
+                    ParallelType v[4];
+
+                    for (int frame = 0; frame < 4; ++frame)
+                        v[frame] = Mode::loadU (src + (i + frame) * numChannels + 4 * group);
+
+                    Mode::transpose (v[0], v[1], v[2], v[3]);
+
+                    for (int k = 0; k < 4 && 4 * group + k < numChannels; ++k)
+                        Mode::storeU (dests[4 * group + k] + i, v[k]);
+                }
+            }
+
+            return i;
+        }
+    };
+
+    // Picks the Interleaver's version for the number of channels, and does
+    // whatever frames it leaves one at a time
+    template <typename Interleaver>
+    static void interleaveChannels (float* dest, const float* const* sources, int numChannels, int num) noexcept
+    {
+        int i = 0;
+
+        switch (numChannels)
+        {
+            case 2:  i = Interleaver::interleaveStereo (dest, sources, num); break;
+            case 3:  i = Interleaver::template interleave<3> (dest, sources, num); break;
+            case 4:  i = Interleaver::template interleave<4> (dest, sources, num); break;
+            case 5:  i = Interleaver::template interleave<5> (dest, sources, num); break;
+            case 6:  i = Interleaver::template interleave<6> (dest, sources, num); break;
+            case 7:  i = Interleaver::template interleave<7> (dest, sources, num); break;
+            case 8:  i = Interleaver::template interleave<8> (dest, sources, num); break;
+            default: break;
+        }
+
+        for (; i < num; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                dest[i * numChannels + ch] = sources[ch][i];
+    }
+
+    template <typename Interleaver>
+    static void deinterleaveChannels (float* const* dests, const float* src, int numChannels, int num) noexcept
+    {
+        int i = 0;
+
+        switch (numChannels)
+        {
+            case 2:  i = Interleaver::deinterleaveStereo (dests, src, num); break;
+            case 3:  i = Interleaver::template deinterleave<3> (dests, src, num); break;
+            case 4:  i = Interleaver::template deinterleave<4> (dests, src, num); break;
+            case 5:  i = Interleaver::template deinterleave<5> (dests, src, num); break;
+            case 6:  i = Interleaver::template deinterleave<6> (dests, src, num); break;
+            case 7:  i = Interleaver::template deinterleave<7> (dests, src, num); break;
+            case 8:  i = Interleaver::template deinterleave<8> (dests, src, num); break;
+            default: break;
+        }
+
+        for (; i < num; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                dests[ch][i] = src[i * numChannels + ch];
+    }
+   #endif
+
+    //==============================================================================
+   #if JUCE_USE_AVX_INTRINSICS
+    // These are compiled for their own instruction set, whatever the build's
+    // flags, and only called once the CPU is known to have it
+    #if JUCE_MSVC
+     #define JUCE_AVX2_TARGET
+     #define JUCE_AVX512_TARGET
+    #else
+     #define JUCE_AVX2_TARGET      __attribute__ ((target ("avx2,fma")))
+     #define JUCE_AVX512_TARGET    __attribute__ ((target ("avx512f")))
+    #endif
+
+    struct AVX2Ops
+    {
+        using ParallelType = __m256;
+        enum { numParallel = 8 };
+
+        static JUCE_AVX2_TARGET forcedinline ParallelType load1 (float v) noexcept                         { return _mm256_set1_ps (v); }
+        static JUCE_AVX2_TARGET forcedinline ParallelType loadU (const float* v) noexcept                  { return _mm256_loadu_ps (v); }
+        static JUCE_AVX2_TARGET forcedinline void storeU (float* dest, ParallelType a) noexcept            { _mm256_storeu_ps (dest, a); }
+
+        static JUCE_AVX2_TARGET forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept    { return _mm256_add_ps (a, b); }
+        static JUCE_AVX2_TARGET forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept    { return _mm256_sub_ps (a, b); }
+        static JUCE_AVX2_TARGET forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept    { return _mm256_mul_ps (a, b); }
+        static JUCE_AVX2_TARGET forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept    { return _mm256_max_ps (a, b); }
+        static JUCE_AVX2_TARGET forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept    { return _mm256_min_ps (a, b); }
+
+        // a * b + c, rounded once
+        static JUCE_AVX2_TARGET forcedinline ParallelType mulAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fmadd_ps (a, b, c); }
+
+        static JUCE_AVX2_TARGET forcedinline float max (ParallelType a) noexcept  { return BasicOps32::max (_mm_max_ps (_mm256_castps256_ps128 (a), _mm256_extractf128_ps (a, 1))); }
+        static JUCE_AVX2_TARGET forcedinline float min (ParallelType a) noexcept  { return BasicOps32::min (_mm_min_ps (_mm256_castps256_ps128 (a), _mm256_extractf128_ps (a, 1))); }
+        static JUCE_AVX2_TARGET forcedinline float sum (ParallelType a) noexcept  { return BasicOps32::sum (_mm_add_ps (_mm256_castps256_ps128 (a), _mm256_extractf128_ps (a, 1))); }
+    };
+
+    struct AVX512Ops
+    {
+        using ParallelType = __m512;
+        enum { numParallel = 16 };
+        static constexpr __mmask16 allLanes = 0xffff;
+
+        static JUCE_AVX512_TARGET forcedinline ParallelType load1 (float v) noexcept                       { return _mm512_set1_ps (v); }
+        static JUCE_AVX512_TARGET forcedinline ParallelType loadU (const float* v) noexcept                { return _mm512_loadu_ps (v); }
+        static JUCE_AVX512_TARGET forcedinline void storeU (float* dest, ParallelType a) noexcept          { _mm512_storeu_ps (dest, a); }
+
+        static JUCE_AVX512_TARGET forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_ps (a, b); }
+        static JUCE_AVX512_TARGET forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm512_sub_ps (a, b); }
+        static JUCE_AVX512_TARGET forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_ps (a, b); }
+        static JUCE_AVX512_TARGET forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_max_ps (allLanes, a, b); }
+        static JUCE_AVX512_TARGET forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_min_ps (allLanes, a, b); }
+
+        static JUCE_AVX512_TARGET forcedinline ParallelType mulAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fmadd_ps (a, b, c); }
+
+        // GCC builds max, min, the plain extracts, the 256 and 128-bit casts
+        // and _mm512_reduce_* on an undefined register, which -Wall reports as
+        // used uninitialised wherever they are inlined. The zero-masking forms
+        // start from zero instead, and with every lane selected give the same
+        // result.
+        template <int half>
+        static JUCE_AVX512_TARGET forcedinline __m256 getHalf (ParallelType a) noexcept
+        {
+            return _mm256_castpd_ps (_mm512_maskz_extractf64x4_pd ((__mmask8) 0xff, _mm512_castps_pd (a), half));
+        }
+
+        static JUCE_AVX512_TARGET forcedinline float max (ParallelType a) noexcept
+        {
+            const auto m = _mm256_max_ps (getHalf<0> (a), getHalf<1> (a));
+            return BasicOps32::max (_mm_max_ps (_mm256_castps256_ps128 (m), _mm256_extractf128_ps (m, 1)));
+        }
+
+        static JUCE_AVX512_TARGET forcedinline float min (ParallelType a) noexcept
+        {
+            const auto m = _mm256_min_ps (getHalf<0> (a), getHalf<1> (a));
+            return BasicOps32::min (_mm_min_ps (_mm256_castps256_ps128 (m), _mm256_extractf128_ps (m, 1)));
+        }
+
+        static JUCE_AVX512_TARGET forcedinline float sum (ParallelType a) noexcept
+        {
+            const auto s = _mm256_add_ps (getHalf<0> (a), getHalf<1> (a));
+            return BasicOps32::sum (_mm_add_ps (_mm256_castps256_ps128 (s), _mm256_extractf128_ps (s, 1)));
+        }
+    };
+
+    /** The Interleaving above, eight frames at a time with one 8x8 transpose.
+        AVX-512 uses it too: with eight channels at most, a wider register
+        would only hold more padding.
+     */
+    struct AVX2Interleaving
+    {
+        static JUCE_AVX2_TARGET int interleaveStereo (float* dest, const float* const* sources, int num) noexcept
+        {
+            int i = 0;
+
+            for (; i <= num - 8; i += 8)
+            {
+                const auto a = _mm256_loadu_ps (sources[0] + i), b = _mm256_loadu_ps (sources[1] + i);
+                const auto lo = _mm256_unpacklo_ps (a, b), hi = _mm256_unpackhi_ps (a, b);
+                _mm256_storeu_ps (dest + 2 * i,     _mm256_permute2f128_ps (lo, hi, 0x20));
+                _mm256_storeu_ps (dest + 2 * i + 8, _mm256_permute2f128_ps (lo, hi, 0x31));
+            }
+
+            return i;
+        }
+
+        static JUCE_AVX2_TARGET int deinterleaveStereo (float* const* dests, const float* src, int num) noexcept
+        {
+            int i = 0;
+
+            for (; i <= num - 8; i += 8)
+            {
+                const auto x = _mm256_loadu_ps (src + 2 * i), y = _mm256_loadu_ps (src + 2 * i + 8);
+                const auto lo = _mm256_permute2f128_ps (x, y, 0x20), hi = _mm256_permute2f128_ps (x, y, 0x31);
+                _mm256_storeu_ps (dests[0] + i, _mm256_shuffle_ps (lo, hi, _MM_SHUFFLE (2, 0, 2, 0)));
+                _mm256_storeu_ps (dests[1] + i, _mm256_shuffle_ps (lo, hi, _MM_SHUFFLE (3, 1, 3, 1)));
+            }
+
+            return i;
+        }
+
+        static JUCE_AVX2_TARGET forcedinline void transpose (__m256* v) noexcept
+        {
+            const auto t0 = _mm256_unpacklo_ps (v[0], v[1]), t1 = _mm256_unpackhi_ps (v[0], v[1]);
+            const auto t2 = _mm256_unpacklo_ps (v[2], v[3]), t3 = _mm256_unpackhi_ps (v[2], v[3]);
+            const auto t4 = _mm256_unpacklo_ps (v[4], v[5]), t5 = _mm256_unpackhi_ps (v[4], v[5]);
+            const auto t6 = _mm256_unpacklo_ps (v[6], v[7]), t7 = _mm256_unpackhi_ps (v[6], v[7]);
+
+            const auto s0 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0)), s1 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2));
+            const auto s2 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0)), s3 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (3, 2, 3, 2));
+            const auto s4 = _mm256_shuffle_ps (t4, t6, _MM_SHUFFLE (1, 0, 1, 0)), s5 = _mm256_shuffle_ps (t4, t6, _MM_SHUFFLE (3, 2, 3, 2));
+            const auto s6 = _mm256_shuffle_ps (t5, t7, _MM_SHUFFLE (1, 0, 1, 0)), s7 = _mm256_shuffle_ps (t5, t7, _MM_SHUFFLE (3, 2, 3, 2));
+
+            v[0] = _mm256_permute2f128_ps (s0, s4, 0x20);
+            v[1] = _mm256_permute2f128_ps (s1, s5, 0x20);
+            v[2] = _mm256_permute2f128_ps (s2, s6, 0x20);
+            v[3] = _mm256_permute2f128_ps (s3, s7, 0x20);
+            v[4] = _mm256_permute2f128_ps (s0, s4, 0x31);
+            v[5] = _mm256_permute2f128_ps (s1, s5, 0x31);
+            v[6] = _mm256_permute2f128_ps (s2, s6, 0x31);
+            v[7] = _mm256_permute2f128_ps (s3, s7, 0x31);
+        }
+
+        template <int numChannels>
+        static JUCE_AVX2_TARGET int interleave (float* dest, const float* const* sources, int num) noexcept
+        {
+            int i = 0;
+
+            for (; (i + 7) * numChannels + 8 <= num * numChannels; i += 8)
+            {
+                __m256 v[8];
+
+                for (int ch = 0; ch < 8; ++ch)
+                    v[ch] = ch < numChannels ? _mm256_loadu_ps (sources[ch] + i) : _mm256_setzero_ps();
+
+                transpose (v);
+
+                for (int frame = 0; frame < 8; ++frame)
+                    _mm256_storeu_ps (dest + (i + frame) * numChannels, v[frame]);
+            }
+
+            return i;
+        }
+
+        template <int numChannels>
+        static JUCE_AVX2_TARGET int deinterleave (float* const* dests, const float* src, int num) noexcept
+        {
+            int i = 0;
+
+            for (; (i + 7) * numChannels + 8 <= num * numChannels; i += 8)
+            {
+                __m256 v[8];
+
+                for (int frame = 0; frame < 8; ++frame)
+                    v[frame] = _mm256_loadu_ps (src + (i + frame) * numChannels);
+
+                transpose (v);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    _mm256_storeu_ps (dests[ch] + i, v[ch]);
+            }
+
+            return i;
+        }
+    };
+
+    // A whole register at a time, then the rest one by one. Unaligned loads
+    // cost nothing extra on the CPUs that have these instructions
+    #define JUCE_WIDE_VEC_LOOP(vecOp, normalOp) \
+        int i = 0; \
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel) \
+            Ops::storeU (dest + i, vecOp); \
+        for (; i < num; ++i) \
+            normalOp;
+
+    // The float kernels, for the Ops of the class that this is expanded in
+    #define JUCE_DEFINE_WIDE_KERNELS(target) \
+        static target void addAmount (float* dest, float amount, int num) noexcept \
+        { \
+            const auto a = Ops::load1 (amount); \
+            JUCE_WIDE_VEC_LOOP (Ops::add (Ops::loadU (dest + i), a), dest[i] += amount) \
+        } \
+        \
+        static target void add (float* dest, const float* src, int num) noexcept \
+        { \
+            JUCE_WIDE_VEC_LOOP (Ops::add (Ops::loadU (dest + i), Ops::loadU (src + i)), dest[i] += src[i]) \
+        } \
+        \
+        static target void addSources (float* dest, const float* src1, const float* src2, int num) noexcept \
+        { \
+            JUCE_WIDE_VEC_LOOP (Ops::add (Ops::loadU (src1 + i), Ops::loadU (src2 + i)), dest[i] = src1[i] + src2[i]) \
+        } \
+        \
+        static target void subtract (float* dest, const float* src, int num) noexcept \
+        { \
+            JUCE_WIDE_VEC_LOOP (Ops::sub (Ops::loadU (dest + i), Ops::loadU (src + i)), dest[i] -= src[i]) \
+        } \
+        \
+        static target void copyWithMultiply (float* dest, const float* src, float multiplier, int num) noexcept \
+        { \
+            const auto m = Ops::load1 (multiplier); \
+            JUCE_WIDE_VEC_LOOP (Ops::mul (Ops::loadU (src + i), m), dest[i] = src[i] * multiplier) \
+        } \
+        \
+        static target void addWithMultiply (float* dest, const float* src, float multiplier, int num) noexcept \
+        { \
+            const auto m = Ops::load1 (multiplier); \
+            JUCE_WIDE_VEC_LOOP (Ops::mulAdd (Ops::loadU (src + i), m, Ops::loadU (dest + i)), dest[i] += src[i] * multiplier) \
+        } \
+        \
+        static target void addWithMultiplySources (float* dest, const float* src1, const float* src2, int num) noexcept \
+        { \
+            JUCE_WIDE_VEC_LOOP (Ops::mulAdd (Ops::loadU (src1 + i), Ops::loadU (src2 + i), Ops::loadU (dest + i)), dest[i] += src1[i] * src2[i]) \
+        } \
+        \
+        static target void multiplyAmount (float* dest, float multiplier, int num) noexcept \
+        { \
+            const auto m = Ops::load1 (multiplier); \
+            JUCE_WIDE_VEC_LOOP (Ops::mul (Ops::loadU (dest + i), m), dest[i] *= multiplier) \
+        } \
+        \
+        static target void multiply (float* dest, const float* src, int num) noexcept \
+        { \
+            JUCE_WIDE_VEC_LOOP (Ops::mul (Ops::loadU (dest + i), Ops::loadU (src + i)), dest[i] *= src[i]) \
+        } \
+        \
+        static target void multiplySources (float* dest, const float* src1, const float* src2, int num) noexcept \
+        { \
+            JUCE_WIDE_VEC_LOOP (Ops::mul (Ops::loadU (src1 + i), Ops::loadU (src2 + i)), dest[i] = src1[i] * src2[i]) \
+        } \
+        \
+        static target Range<float> findMinAndMax (const float* src, int num) noexcept \
+        { \
+            if (num < Ops::numParallel) \
+                return Range<float>::findMinAndMax (src, num); \
+            \
+            auto mn = Ops::loadU (src), mx = mn; \
+            int i = Ops::numParallel; \
+            \
+            for (; i <= num - Ops::numParallel; i += Ops::numParallel) \
+            { \
+                const auto v = Ops::loadU (src + i); \
+                mn = Ops::min (mn, v); \
+                mx = Ops::max (mx, v); \
+            } \
+            \
+            Range<float> result (Ops::min (mn), Ops::max (mx)); \
+            \
+            for (; i < num; ++i) \
+                result = result.getUnionWith (src[i]); \
+            \
+            return result; \
+        } \
+        \
+        static target void addWithMultiply2 (float* dest, const float* src1, float multiplier1, const float* src2, float multiplier2, int num) noexcept \
+        { \
+            const auto m1 = Ops::load1 (multiplier1), m2 = Ops::load1 (multiplier2); \
+            JUCE_WIDE_VEC_LOOP (Ops::mulAdd (Ops::loadU (src1 + i), m1, Ops::mulAdd (Ops::loadU (src2 + i), m2, Ops::loadU (dest + i))), \
+                                dest[i] += src1[i] * multiplier1 + src2[i] * multiplier2) \
+        } \
+        \
+        static target float dotProduct (const float* src1, const float* src2, int num) noexcept \
+        { \
+            auto sum1 = Ops::load1 (0.0f), sum2 = sum1; \
+            int i = 0; \
+            \
+            for (; i <= num - 2 * Ops::numParallel; i += 2 * Ops::numParallel) \
+            { \
+                sum1 = Ops::mulAdd (Ops::loadU (src1 + i), Ops::loadU (src2 + i), sum1); \
+                sum2 = Ops::mulAdd (Ops::loadU (src1 + i + Ops::numParallel), Ops::loadU (src2 + i + Ops::numParallel), sum2); \
+            } \
+            \
+            if (i <= num - Ops::numParallel) \
+            { \
+                sum1 = Ops::mulAdd (Ops::loadU (src1 + i), Ops::loadU (src2 + i), sum1); \
+                i += Ops::numParallel; \
+            } \
+            \
+            float result = Ops::sum (Ops::add (sum1, sum2)); \
+            \
+            for (; i < num; ++i) \
+                result += src1[i] * src2[i]; \
+            \
+            return result; \
+        } \
+        \
+        static target float sumOfSquares (const float* src, int num) noexcept \
+        { \
+            return dotProduct (src, src, num); \
+        }
+
+    struct AVX2Kernels
+    {
+        using Ops = AVX2Ops;
+        JUCE_DEFINE_WIDE_KERNELS (JUCE_AVX2_TARGET)
+    };
+
+    struct AVX512Kernels
+    {
+        using Ops = AVX512Ops;
+        JUCE_DEFINE_WIDE_KERNELS (JUCE_AVX512_TARGET)
+    };
+
+    /** The kernels of one of the wider instruction sets. */
+    struct WideKernels
+    {
+        void (*addAmount) (float*, float, int);
+        void (*add) (float*, const float*, int);
+        void (*addSources) (float*, const float*, const float*, int);
+        void (*subtract) (float*, const float*, int);
+        void (*copyWithMultiply) (float*, const float*, float, int);
+        void (*addWithMultiply) (float*, const float*, float, int);
+        void (*addWithMultiplySources) (float*, const float*, const float*, int);
+        void (*multiplyAmount) (float*, float, int);
+        void (*multiply) (float*, const float*, int);
+        void (*multiplySources) (float*, const float*, const float*, int);
+        Range<float> (*findMinAndMax) (const float*, int);
+        void (*addWithMultiply2) (float*, const float*, float, const float*, float, int);
+        float (*dotProduct) (const float*, const float*, int);
+        float (*sumOfSquares) (const float*, int);
+        void (*interleave) (float*, const float* const*, int, int);
+        void (*deinterleave) (float* const*, const float*, int, int);
+    };
+
+    template <typename Kernels>
+    static const WideKernels* getWideKernels() noexcept
+    {
+        static const WideKernels kernels { Kernels::addAmount, Kernels::add, Kernels::addSources, Kernels::subtract,
+                                           Kernels::copyWithMultiply, Kernels::addWithMultiply, Kernels::addWithMultiplySources,
+                                           Kernels::multiplyAmount, Kernels::multiply, Kernels::multiplySources,
+                                           Kernels::findMinAndMax, Kernels::addWithMultiply2, Kernels::dotProduct,
+                                           Kernels::sumOfSquares, interleaveChannels<AVX2Interleaving>,
+                                           deinterleaveChannels<AVX2Interleaving> };
+        return &kernels;
+    }
+
+    // The kernels the operations run with, or nullptr for the SSE code. It's
+    // set at startup, and read with a plain load on every call
+    static std::atomic<const WideKernels*> wideKernels { nullptr };
+
+    #define JUCE_CALL_WIDE_KERNEL(kernel, ...) \
+        if (auto* wide = FloatVectorHelpers::wideKernels.load (std::memory_order_relaxed)) \
+            return wide->kernel (__VA_ARGS__);
+   #else
+    #define JUCE_CALL_WIDE_KERNEL(kernel, ...)
    #endif
 }
 
@@ -552,6 +1113,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (float* dest, const f
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (copyWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -574,6 +1136,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, float amount, int nu
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsadd (dest, 1, &amount, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (addAmount, dest, amount, num)
     JUCE_PERFORM_VEC_OP_DEST (dest[i] += amount, Mode::add (d, amountToAdd), JUCE_LOAD_DEST,
                               const Mode::ParallelType amountToAdd = Mode::load1 (amount);)
    #endif
@@ -612,6 +1175,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src, in
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (add, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -630,6 +1194,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src1, c
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (addSources, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -648,6 +1213,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsub (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (subtract, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i], Mode::sub (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -684,6 +1250,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsma (src, 1, &multiplier, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (addWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -706,6 +1273,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vma ((float*) src1, 1, (float*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (addWithMultiplySources, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -723,6 +1291,27 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
    #endif
 }
 
+void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply2 (float* dest, const float* src1, float multiplier1,
+                                                            const float* src2, float multiplier2, int num) noexcept
+{
+    JUCE_CALL_WIDE_KERNEL (addWithMultiply2, dest, src1, multiplier1, src2, multiplier2, num)
+    JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * multiplier1 + src2[i] * multiplier2,
+                                             Mode::add (d, Mode::add (Mode::mul (s1, m1), Mode::mul (s2, m2))),
+                                             JUCE_LOAD_SRC1_SRC2_DEST, JUCE_INCREMENT_SRC1_SRC2_DEST,
+                                             const Mode::ParallelType m1 = Mode::load1 (multiplier1);
+                                             const Mode::ParallelType m2 = Mode::load1 (multiplier2);)
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply2 (double* dest, const double* src1, double multiplier1,
+                                                            const double* src2, double multiplier2, int num) noexcept
+{
+    JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * multiplier1 + src2[i] * multiplier2,
+                                             Mode::add (d, Mode::add (Mode::mul (s1, m1), Mode::mul (s2, m2))),
+                                             JUCE_LOAD_SRC1_SRC2_DEST, JUCE_INCREMENT_SRC1_SRC2_DEST,
+                                             const Mode::ParallelType m1 = Mode::load1 (multiplier1);
+                                             const Mode::ParallelType m2 = Mode::load1 (multiplier2);)
+}
+
 void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (float* dest, const float* src, float multiplier, int num) noexcept
 {
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i] * multiplier, Mode::sub (d, Mode::mul (mult, s)),
@@ -756,6 +1345,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (multiply, dest, src, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -774,6 +1364,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (multiplySources, dest, src1, src2, num)
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] * src2[i], Mode::mul (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -792,6 +1383,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, float multiplie
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_CALL_WIDE_KERNEL (multiplyAmount, dest, multiplier, num)
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -809,6 +1401,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multipl
 
 void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* src, float multiplier, int num) noexcept
 {
+    JUCE_CALL_WIDE_KERNEL (copyWithMultiply, dest, src, multiplier, num)
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -977,6 +1570,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (double* dest, const double* src,
 Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_CALL_WIDE_KERNEL (findMinAndMax, src, num)
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinAndMax (src, num);
    #else
     return Range<float>::findMinAndMax (src, num);
@@ -995,6 +1589,11 @@ Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double*
 float JUCE_CALLTYPE FloatVectorOperations::findMinimum (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    #if JUCE_USE_AVX_INTRINSICS
+    if (FloatVectorHelpers::wideKernels.load (std::memory_order_relaxed) != nullptr)
+        return findMinAndMax (src, num).getStart();
+    #endif
+
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinOrMax (src, num, true);
    #else
     return juce::findMinimum (src, num);
@@ -1013,6 +1612,11 @@ double JUCE_CALLTYPE FloatVectorOperations::findMinimum (const double* src, int
 float JUCE_CALLTYPE FloatVectorOperations::findMaximum (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    #if JUCE_USE_AVX_INTRINSICS
+    if (FloatVectorHelpers::wideKernels.load (std::memory_order_relaxed) != nullptr)
+        return findMinAndMax (src, num).getEnd();
+    #endif
+
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinOrMax (src, num, false);
    #else
     return juce::findMaximum (src, num);
@@ -1028,6 +1632,156 @@ double JUCE_CALLTYPE FloatVectorOperations::findMaximum (const double* src, int
    #endif
 }
 
+void JUCE_CALLTYPE FloatVectorOperations::findMinAndMaxOfBlocks (float* dest, const float* src, int valuesPerBlock, int numBlocks) noexcept
+{
+    for (int block = 0; block < numBlocks; ++block, src += valuesPerBlock)
+    {
+        const auto range = findMinAndMax (src, valuesPerBlock);
+        dest[2 * block] = range.getStart();
+        dest[2 * block + 1] = range.getEnd();
+    }
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::findMinAndMaxOfBlocks (double* dest, const double* src, int valuesPerBlock, int numBlocks) noexcept
+{
+    for (int block = 0; block < numBlocks; ++block, src += valuesPerBlock)
+    {
+        const auto range = findMinAndMax (src, valuesPerBlock);
+        dest[2 * block] = range.getStart();
+        dest[2 * block + 1] = range.getEnd();
+    }
+}
+
+float JUCE_CALLTYPE FloatVectorOperations::dotProduct (const float* src1, const float* src2, int num) noexcept
+{
+   #if JUCE_USE_VDSP_FRAMEWORK
+    float result = 0;
+    vDSP_dotpr ((float*) src1, 1, (float*) src2, 1, &result, (vDSP_Length) num);
+    return result;
+   #elif JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_CALL_WIDE_KERNEL (dotProduct, src1, src2, num)
+    return FloatVectorHelpers::Sums<FloatVectorHelpers::BasicOps32>::dotProduct (src1, src2, num);
+   #else
+    float result = 0;
+
+    for (int i = 0; i < num; ++i)
+        result += src1[i] * src2[i];
+
+    return result;
+   #endif
+}
+
+double JUCE_CALLTYPE FloatVectorOperations::dotProduct (const double* src1, const double* src2, int num) noexcept
+{
+   #if JUCE_USE_VDSP_FRAMEWORK
+    double result = 0;
+    vDSP_dotprD ((double*) src1, 1, (double*) src2, 1, &result, (vDSP_Length) num);
+    return result;
+   #elif JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    return FloatVectorHelpers::Sums<FloatVectorHelpers::BasicOps64>::dotProduct (src1, src2, num);
+   #else
+    double result = 0;
+
+    for (int i = 0; i < num; ++i)
+        result += src1[i] * src2[i];
+
+    return result;
+   #endif
+}
+
+float JUCE_CALLTYPE FloatVectorOperations::sumOfSquares (const float* src, int num) noexcept
+{
+   #if JUCE_USE_VDSP_FRAMEWORK
+    float result = 0;
+    vDSP_svesq ((float*) src, 1, &result, (vDSP_Length) num);
+    return result;
+   #else
+    JUCE_CALL_WIDE_KERNEL (sumOfSquares, src, num)
+    return dotProduct (src, src, num);
+   #endif
+}
+
+double JUCE_CALLTYPE FloatVectorOperations::sumOfSquares (const double* src, int num) noexcept
+{
+   #if JUCE_USE_VDSP_FRAMEWORK
+    double result = 0;
+    vDSP_svesqD ((double*) src, 1, &result, (vDSP_Length) num);
+    return result;
+   #else
+    return dotProduct (src, src, num);
+   #endif
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::interleave (float* dest, const float* const* sources, int numChannels, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_CALL_WIDE_KERNEL (interleave, dest, sources, numChannels, num)
+    FloatVectorHelpers::interleaveChannels<FloatVectorHelpers::Interleaving> (dest, sources, numChannels, num);
+   #else
+    for (int i = 0; i < num; ++i)
+        for (int ch = 0; ch < numChannels; ++ch)
+            dest[i * numChannels + ch] = sources[ch][i];
+   #endif
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::deinterleave (float* const* dests, const float* src, int numChannels, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_CALL_WIDE_KERNEL (deinterleave, dests, src, numChannels, num)
+    FloatVectorHelpers::deinterleaveChannels<FloatVectorHelpers::Interleaving> (dests, src, numChannels, num);
+   #else
+    for (int i = 0; i < num; ++i)
+        for (int ch = 0; ch < numChannels; ++ch)
+            dests[ch][i] = src[i * numChannels + ch];
+   #endif
+}
+
+FloatVectorOperations::InstructionSet JUCE_CALLTYPE FloatVectorOperations::getInstructionSet() noexcept
+{
+   #if JUCE_USE_AVX_INTRINSICS
+    auto* wide = FloatVectorHelpers::wideKernels.load();
+
+    if (wide == FloatVectorHelpers::getWideKernels<FloatVectorHelpers::AVX512Kernels>())  return InstructionSet::avx512;
+    if (wide == FloatVectorHelpers::getWideKernels<FloatVectorHelpers::AVX2Kernels>())    return InstructionSet::avx2;
+   #endif
+
+    return InstructionSet::standard;
+}
+
+bool JUCE_CALLTYPE FloatVectorOperations::setInstructionSet (InstructionSet instructionSet) noexcept
+{
+    if (instructionSet == InstructionSet::standard)
+    {
+       #if JUCE_USE_AVX_INTRINSICS
+        FloatVectorHelpers::wideKernels = nullptr;
+       #endif
+        return true;
+    }
+
+   #if JUCE_USE_AVX_INTRINSICS
+    if (instructionSet == InstructionSet::avx512 && SystemStats::hasAVX512F())
+    {
+        FloatVectorHelpers::wideKernels = FloatVectorHelpers::getWideKernels<FloatVectorHelpers::AVX512Kernels>();
+        return true;
+    }
+
+    if (instructionSet == InstructionSet::avx2 && SystemStats::hasAVX2() && SystemStats::hasFMA3())
+    {
+        FloatVectorHelpers::wideKernels = FloatVectorHelpers::getWideKernels<FloatVectorHelpers::AVX2Kernels>();
+        return true;
+    }
+   #endif
+
+    return false;
+}
+
+#if JUCE_USE_AVX_INTRINSICS
+// The widest kernels are picked before main() runs. Anything called before
+// that gets the SSE code
+static const bool wideKernelsPicked = FloatVectorOperations::setInstructionSet (FloatVectorOperations::InstructionSet::avx512)
+                                       || FloatVectorOperations::setInstructionSet (FloatVectorOperations::InstructionSet::avx2);
+#endif
+
 intptr_t JUCE_CALLTYPE FloatVectorOperations::getFpStatusRegister() noexcept
 {
     intptr_t fpsr = 0;
@@ -1233,6 +1987,52 @@ public:
             FloatVectorOperations::fill (data2, (ValueType) 3, num);
             FloatVectorOperations::addWithMultiply (data1, data1, data2, num);
             u.expect (areAllValuesEqual (data1, num, (ValueType) 8));
+
+            fillRandomly (random, data1, num);
+            fillRandomly (random, data2, num);
+            doFusedOperationsTest (u, random, data1, data2, num);
+        }
+
+        static void doFusedOperationsTest (UnitTest& u, Random& random, const ValueType* data1, const ValueType* data2, int num)
+        {
+            ValueType dotProduct = 0, sumOfSquares = 0;
+
+            for (int i = 0; i < num; ++i)
+            {
+                dotProduct += data1[i] * data2[i];
+                sumOfSquares += data1[i] * data1[i];
+            }
+
+            u.expect (sumsMatch (FloatVectorOperations::dotProduct (data1, data2, num), dotProduct));
+            u.expect (sumsMatch (FloatVectorOperations::sumOfSquares (data1, num), sumOfSquares));
+
+            const auto multiplier1 = (ValueType) random.nextDouble(), multiplier2 = (ValueType) random.nextDouble();
+            HeapBlock<ValueType> mixed (num);
+            bool mixesMatch = true;
+
+            FloatVectorOperations::copy (mixed, data2, num);
+            FloatVectorOperations::addWithMultiply2 (mixed, data1, multiplier1, data2, multiplier2, num);
+
+            for (int i = 0; i < num; ++i)
+                mixesMatch = mixesMatch && sumsMatch (mixed[i], data2[i] + data1[i] * multiplier1 + data2[i] * multiplier2);
+
+            u.expect (mixesMatch);
+
+            // Blocks of a random size, with whatever is left over not searched
+            const int valuesPerBlock = random.nextInt (num) + 1;
+            const int numBlocks = num / valuesPerBlock;
+            HeapBlock<ValueType> pairs (2 * numBlocks + 1);
+            pairs[2 * numBlocks] = (ValueType) -1;
+
+            FloatVectorOperations::findMinAndMaxOfBlocks (pairs, data1, valuesPerBlock, numBlocks);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                const auto range = Range<ValueType>::findMinAndMax (data1 + block * valuesPerBlock, valuesPerBlock);
+                u.expect (pairs[2 * block] == range.getStart() && pairs[2 * block + 1] == range.getEnd());
+            }
+
+            u.expect (pairs[2 * numBlocks] == (ValueType) -1);
         }
 
         static void doConversionTest (UnitTest& u, float* data1, float* data2, int* const int1, int num)
@@ -1284,17 +2084,160 @@ public:
         {
             return std::abs (v1 - v2) < std::numeric_limits<ValueType>::epsilon();
         }
+
+        // Sums taken in another order differ by a few roundings
+        static bool sumsMatch (ValueType v1, ValueType v2)
+        {
+            return std::abs (v1 - v2) <= (ValueType) 1.0e-5 * std::abs (v2) + std::numeric_limits<ValueType>::epsilon();
+        }
     };
 
+    /** Interleaves 1 to 9 channels of random lengths and alignments, checking
+        that nothing is written past the end, then splits them again.
+    */
+    static void testInterleaving (UnitTest& u, Random random)
+    {
+        for (int numChannels = 1; numChannels <= 9; ++numChannels)
+        {
+            const int num = random.nextInt (100);
+            const int stride = num + 16;
+            std::vector<float> storage ((size_t) (2 * numChannels * stride + numChannels * num + 32));
+
+            std::vector<const float*> sources;
+            std::vector<float*> dests;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* source = storage.data() + ch * stride + random.nextInt (16);
+
+                for (int i = 0; i < num; ++i)
+                    source[i] = random.nextFloat();
+
+                sources.push_back (source);
+                dests.push_back (storage.data() + (numChannels + ch) * stride + random.nextInt (16));
+            }
+
+            auto* interleaved = storage.data() + 2 * numChannels * stride + random.nextInt (16);
+            std::fill (interleaved, storage.data() + storage.size(), -1.0f);
+
+            FloatVectorOperations::interleave (interleaved, sources.data(), numChannels, num);
+
+            bool interleavedMatch = true, deinterleavedMatch = true;
+
+            for (int i = 0; i < num; ++i)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    interleavedMatch = interleavedMatch && interleaved[i * numChannels + ch] == sources[(size_t) ch][i];
+
+            u.expect (interleavedMatch, String (numChannels) + " channels");
+            u.expect (interleaved[numChannels * num] == -1.0f, "Interleaving wrote past the end");
+
+            FloatVectorOperations::deinterleave (dests.data(), interleaved, numChannels, num);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                deinterleavedMatch = deinterleavedMatch && std::equal (sources[(size_t) ch], sources[(size_t) ch] + num, dests[(size_t) ch]);
+
+            u.expect (deinterleavedMatch, String (numChannels) + " channels");
+        }
+    }
+
+    using InstructionSet = FloatVectorOperations::InstructionSet;
+
+    /** Runs the float operations with a wider instruction set and the standard
+        one, on random data of random lengths and alignments. Fused multiply-adds
+        round once, so the results can differ in the last bit.
+    */
+    static void compareWithStandard (UnitTest& u, Random random, InstructionSet instructionSet)
+    {
+        const int num = random.nextInt (100);
+        std::vector<float> storage ((size_t) (5 * (num + 16)));
+
+        auto getBuffer = [&] (int index) { return storage.data() + index * (num + 16) + random.nextInt (16); };
+        auto* src1 = getBuffer (0);
+        auto* src2 = getBuffer (1);
+        auto* initial = getBuffer (2);
+        auto* expected = getBuffer (3);
+        auto* actual = getBuffer (4);
+
+        for (auto* buffer : { src1, src2, initial })
+            for (int i = 0; i < num; ++i)
+                buffer[i] = random.nextFloat() * 2.0f - 1.0f;
+
+        const auto amount = random.nextFloat() * 2.0f - 1.0f;
+
+        auto check = [&] (const String& name, std::function<void (float*)> operation)
+        {
+            std::copy (initial, initial + num, expected);
+            FloatVectorOperations::setInstructionSet (InstructionSet::standard);
+            operation (expected);
+
+            std::copy (initial, initial + num, actual);
+            FloatVectorOperations::setInstructionSet (instructionSet);
+            operation (actual);
+
+            for (int i = 0; i < num; ++i)
+                if (std::abs (actual[i] - expected[i]) > 1.0e-6f)
+                    return u.expect (false, name + " differs at " + String (i) + " of " + String (num));
+        };
+
+        check ("add (amount)",              [&] (float* dest) { FloatVectorOperations::add (dest, amount, num); });
+        check ("add",                       [&] (float* dest) { FloatVectorOperations::add (dest, src1, num); });
+        check ("add (sources)",             [&] (float* dest) { FloatVectorOperations::add (dest, src1, src2, num); });
+        check ("subtract",                  [&] (float* dest) { FloatVectorOperations::subtract (dest, src1, num); });
+        check ("copyWithMultiply",          [&] (float* dest) { FloatVectorOperations::copyWithMultiply (dest, src1, amount, num); });
+        check ("addWithMultiply",           [&] (float* dest) { FloatVectorOperations::addWithMultiply (dest, src1, amount, num); });
+        check ("addWithMultiply (sources)", [&] (float* dest) { FloatVectorOperations::addWithMultiply (dest, src1, src2, num); });
+        check ("multiply (amount)",         [&] (float* dest) { FloatVectorOperations::multiply (dest, amount, num); });
+        check ("multiply",                  [&] (float* dest) { FloatVectorOperations::multiply (dest, src1, num); });
+        check ("multiply (sources)",        [&] (float* dest) { FloatVectorOperations::multiply (dest, src1, src2, num); });
+        check ("multiply (source, amount)", [&] (float* dest) { FloatVectorOperations::multiply (dest, src1, amount, num); });
+        check ("addWithMultiply2",          [&] (float* dest) { FloatVectorOperations::addWithMultiply2 (dest, src1, amount, src2, -amount, num); });
+
+        FloatVectorOperations::setInstructionSet (InstructionSet::standard);
+        const auto expectedRange = FloatVectorOperations::findMinAndMax (src1, num);
+        const auto expectedDotProduct = FloatVectorOperations::dotProduct (src1, src2, num);
+        const auto expectedSumOfSquares = FloatVectorOperations::sumOfSquares (src1, num);
+        FloatVectorOperations::setInstructionSet (instructionSet);
+
+        u.expect (FloatVectorOperations::findMinAndMax (src1, num) == expectedRange);
+        u.expect (FloatVectorOperations::findMinimum (src1, num) == expectedRange.getStart());
+        u.expect (FloatVectorOperations::findMaximum (src1, num) == expectedRange.getEnd());
+
+        // The sums are taken in another order
+        u.expectWithinAbsoluteError (FloatVectorOperations::dotProduct (src1, src2, num), expectedDotProduct, 1.0e-5f);
+        u.expectWithinAbsoluteError (FloatVectorOperations::sumOfSquares (src1, num), expectedSumOfSquares, 1.0e-5f);
+    }
+
     void runTest() override
     {
+        const auto original = FloatVectorOperations::getInstructionSet();
+
         beginTest ("FloatVectorOperations");
+        FloatVectorOperations::setInstructionSet (InstructionSet::standard);
 
         for (int i = 1000; --i >= 0;)
         {
             TestRunner<float>::runTest (*this, getRandom());
             TestRunner<double>::runTest (*this, getRandom());
+            testInterleaving (*this, getRandom());
+        }
+
+        // Each of the wider instruction sets that this CPU has
+        for (auto instructionSet : { InstructionSet::avx2, InstructionSet::avx512 })
+        {
+            if (! FloatVectorOperations::setInstructionSet (instructionSet))
+                continue;
+
+            beginTest (instructionSet == InstructionSet::avx2 ? "AVX2" : "AVX-512");
+
+            for (int i = 1000; --i >= 0;)
+            {
+                TestRunner<float>::runTest (*this, getRandom());
+                compareWithStandard (*this, getRandom(), instructionSet);
+                testInterleaving (*this, getRandom());
+            }
         }
+
+        FloatVectorOperations::setInstructionSet (original);
     }
 };
 
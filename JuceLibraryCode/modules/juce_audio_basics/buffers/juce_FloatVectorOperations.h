@@ -115,6 +115,14 @@ public:
     /** Multiplies each source1 value by the corresponding source2 value, then adds it to the destination value. */
     static void JUCE_CALLTYPE addWithMultiply (double* dest, const double* src1, const double* src2, int num) noexcept;
 
+    /** Adds src1 * multiplier1 + src2 * multiplier2 to each destination value, e.g. to mix two channels into a third. */
+    static void JUCE_CALLTYPE addWithMultiply2 (float* dest, const float* src1, float multiplier1,
+                                                const float* src2, float multiplier2, int num) noexcept;
+
+    /** Adds src1 * multiplier1 + src2 * multiplier2 to each destination value, e.g. to mix two channels into a third. */
+    static void JUCE_CALLTYPE addWithMultiply2 (double* dest, const double* src1, double multiplier1,
+                                                const double* src2, double multiplier2, int num) noexcept;
+
     /** Multiplies each source value by the given multiplier, then subtracts it to the destination value. */
     static void JUCE_CALLTYPE subtractWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept;
 
@@ -214,6 +222,40 @@ public:
     /** Finds the maximum value in the given array. */
     static double JUCE_CALLTYPE findMaximum (const double* src, int numValues) noexcept;
 
+    /** Finds the minimum and maximum of each block of valuesPerBlock values, and writes
+        them to dest as pairs: dest[2 * n] is the minimum of block n, and dest[2 * n + 1]
+        its maximum. This is what a waveform overview draws.
+    */
+    static void JUCE_CALLTYPE findMinAndMaxOfBlocks (float* dest, const float* src, int valuesPerBlock, int numBlocks) noexcept;
+
+    /** Finds the minimum and maximum of each block of valuesPerBlock values, and writes
+        them to dest as pairs: dest[2 * n] is the minimum of block n, and dest[2 * n + 1]
+        its maximum. This is what a waveform overview draws.
+    */
+    static void JUCE_CALLTYPE findMinAndMaxOfBlocks (double* dest, const double* src, int valuesPerBlock, int numBlocks) noexcept;
+
+    /** Returns the sum of the products of the corresponding values of the two arrays. */
+    static float JUCE_CALLTYPE dotProduct (const float* src1, const float* src2, int num) noexcept;
+
+    /** Returns the sum of the products of the corresponding values of the two arrays. */
+    static double JUCE_CALLTYPE dotProduct (const double* src1, const double* src2, int num) noexcept;
+
+    /** Returns the sum of the squares of the values, e.g. for an RMS level. */
+    static float JUCE_CALLTYPE sumOfSquares (const float* src, int numValues) noexcept;
+
+    /** Returns the sum of the squares of the values, e.g. for an RMS level. */
+    static double JUCE_CALLTYPE sumOfSquares (const double* src, int numValues) noexcept;
+
+    /** Interleaves numChannels separate arrays into dest, which must have room for
+        numChannels * numValues floats. Counts of 2 to 8 channels are vectorised.
+    */
+    static void JUCE_CALLTYPE interleave (float* dest, const float* const* sources, int numChannels, int numValues) noexcept;
+
+    /** Splits an array of numChannels interleaved channels into separate arrays of
+        numValues each. Counts of 2 to 8 channels are vectorised.
+    */
+    static void JUCE_CALLTYPE deinterleave (float* const* dests, const float* src, int numChannels, int numValues) noexcept;
+
     /** This method enables or disables the SSE/NEON flush-to-zero mode. */
     static void JUCE_CALLTYPE enableFlushToZeroMode (bool shouldEnable) noexcept;
 
@@ -228,6 +270,29 @@ public:
     /** This method returns true if denormals are currently disabled. */
     static bool JUCE_CALLTYPE areDenormalsDisabled() noexcept;
 
+    //==============================================================================
+    /** The instruction sets that the float operations can run with. */
+    enum class InstructionSet
+    {
+        standard,   /**< SSE, NEON or vDSP, whichever the build uses. */
+        avx2,       /**< 8 floats at a time, with fused multiply-adds. */
+        avx512      /**< 16 floats at a time. */
+    };
+
+    /** Returns the instruction set that the float versions of add, subtract,
+        multiply, copyWithMultiply, addWithMultiply, addWithMultiply2, the min/max
+        searches, dotProduct, sumOfSquares, interleave and deinterleave run with.
+        The widest one that the CPU supports is picked at startup.
+    */
+    static InstructionSet JUCE_CALLTYPE getInstructionSet() noexcept;
+
+    /** Makes the operations run with another instruction set, e.g. to compare
+        them in a benchmark.
+
+        @returns    false, changing nothing, if the build or the CPU can't run it
+    */
+    static bool JUCE_CALLTYPE setInstructionSet (InstructionSet) noexcept;
+
 private:
     friend ScopedNoDenormals;
 
@@ -53,9 +53,26 @@
  #include <arm_neon.h>
 #endif
 
+// The float operations have AVX2 and AVX-512 kernels, compiled whatever the
+// build's flags and picked at runtime. vDSP has its own, and MinGW doesn't
+// keep the stack aligned for them
+#ifndef JUCE_USE_AVX_INTRINSICS
+ #define JUCE_USE_AVX_INTRINSICS 1
+#endif
+
+#if ! JUCE_USE_SSE_INTRINSICS || JUCE_USE_VDSP_FRAMEWORK || JUCE_MINGW
+ #undef JUCE_USE_AVX_INTRINSICS
+#endif
+
+#if JUCE_USE_AVX_INTRINSICS
+ #include <immintrin.h>
+ #include <atomic>
+#endif
+
 #include "buffers/juce_AudioDataConverters.cpp"
 #include "buffers/juce_FloatVectorOperations.cpp"
 #include "buffers/juce_AudioChannelSet.cpp"
+#include "buffers/juce_AudioSampleBuffer.cpp"
 #include "buffers/juce_AudioProcessLoadMeasurer.cpp"
 #include "utilities/juce_IIRFilter.cpp"
 #include "utilities/juce_LagrangeInterpolator.cpp"
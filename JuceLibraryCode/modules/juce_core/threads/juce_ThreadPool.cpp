@@ -25,8 +25,9 @@ namespace juce
 
 struct ThreadPool::ThreadPoolThread  : public Thread
 {
-    ThreadPoolThread (ThreadPool& p, size_t stackSize)
-       : Thread ("Pool", stackSize), pool (p)
+    ThreadPoolThread (ThreadPool& p, size_t stackSize, int threadIndex)
+       : Thread ("Pool", stackSize), pool (p), index (threadIndex),
+         randomState (0x9e3779b9u * (uint32) (threadIndex + 1))
     {
     }
 
@@ -34,15 +35,79 @@ struct ThreadPool::ThreadPoolThread  : public Thread
     {
         while (! threadShouldExit())
             if (! pool.runNextJob (*this))
-                wait (500);
+                pool.waitForJobs (*this);
     }
 
+    // A random thread index, from a xorshift generator of its own
+    int pickRandomThread (int numThreads) noexcept
+    {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return (int) (randomState % (uint32) numThreads);
+    }
+
+    void updateQueueSize() noexcept     { numQueued = (int) queue.size(); }
+
     std::atomic<ThreadPoolJob*> currentJob { nullptr };
     ThreadPool& pool;
 
+    // With work stealing, the thread's own jobs. The lock guards the queue
+    // and currentJob, so that every job in the pool is always either in a
+    // queue or some thread's currentJob
+    std::deque<ThreadPoolJob*> queue;
+    SpinLock queueLock;
+    std::atomic<int> numQueued { 0 };
+    std::atomic<bool> isIdle { false };
+    const int index;
+    uint32 randomState;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolThread)
 };
 
+//==============================================================================
+/** Locks the queues of all the threads, in order. A thread stealing a job
+    locks two queues, also in order.
+*/
+struct ThreadPool::ScopedQueuesLock
+{
+    explicit ScopedQueuesLock (const ThreadPool& p) noexcept  : pool (p)
+    {
+        for (auto* t : pool.threads)
+            t->queueLock.enter();
+    }
+
+    ~ScopedQueuesLock() noexcept
+    {
+        for (int i = pool.threads.size(); --i >= 0;)
+            pool.threads.getUnchecked (i)->queueLock.exit();
+    }
+
+    const ThreadPool& pool;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedQueuesLock)
+};
+
+//==============================================================================
+namespace ThreadPoolHelpers
+{
+    struct LambdaJobWrapper  : public ThreadPoolJob
+    {
+        LambdaJobWrapper (std::function<ThreadPoolJob::JobStatus()> j) : ThreadPoolJob ("lambda"), job (j) {}
+        JobStatus runJob() override      { return job(); }
+
+        std::function<ThreadPoolJob::JobStatus()> job;
+    };
+
+    struct VoidLambdaJobWrapper  : public ThreadPoolJob
+    {
+        VoidLambdaJobWrapper (std::function<void()> j) : ThreadPoolJob ("lambda"), job (j) {}
+        JobStatus runJob() override      { job(); return ThreadPoolJob::jobHasFinished; }
+
+        std::function<void()> job;
+    };
+}
+
 //==============================================================================
 ThreadPoolJob::ThreadPoolJob (const String& name)  : jobName (name)
 {
@@ -90,7 +155,8 @@ ThreadPoolJob* ThreadPoolJob::getCurrentThreadPoolJob()
 }
 
 //==============================================================================
-ThreadPool::ThreadPool (int numThreads, size_t threadStackSize)
+ThreadPool::ThreadPool (int numThreads, size_t threadStackSize, Scheduling schedulingToUse)
+    : scheduling (schedulingToUse)
 {
     jassert (numThreads > 0); // not much point having a pool without any threads!
 
@@ -111,7 +177,7 @@ ThreadPool::~ThreadPool()
 void ThreadPool::createThreads (int numThreads, size_t threadStackSize)
 {
     for (int i = jmax (1, numThreads); --i >= 0;)
-        threads.add (new ThreadPoolThread (*this, threadStackSize));
+        threads.add (new ThreadPoolThread (*this, threadStackSize, threads.size()));
 
     for (auto* t : threads)
         t->startThread();
@@ -126,6 +192,14 @@ void ThreadPool::stopThreads()
         t->stopThread (500);
 }
 
+void ThreadPool::prepareJobForAdding (ThreadPoolJob* job, bool deleteJobWhenFinished)
+{
+    job->pool = this;
+    job->shouldStop = false;
+    job->isActive = false;
+    job->shouldBeDeleted = deleteJobWhenFinished;
+}
+
 void ThreadPool::addJob (ThreadPoolJob* job, bool deleteJobWhenFinished)
 {
     jassert (job != nullptr);
@@ -133,10 +207,13 @@ void ThreadPool::addJob (ThreadPoolJob* job, bool deleteJobWhenFinished)
 
     if (job->pool == nullptr)
     {
-        job->pool = this;
-        job->shouldStop = false;
-        job->isActive = false;
-        job->shouldBeDeleted = deleteJobWhenFinished;
+        prepareJobForAdding (job, deleteJobWhenFinished);
+
+        if (scheduling == Scheduling::workStealing)
+        {
+            addJobsToQueues (&job, 1);
+            return;
+        }
 
         {
             const ScopedLock sl (lock);
@@ -150,32 +227,65 @@ void ThreadPool::addJob (ThreadPoolJob* job, bool deleteJobWhenFinished)
 
 void ThreadPool::addJob (std::function<ThreadPoolJob::JobStatus()> jobToRun)
 {
-    struct LambdaJobWrapper  : public ThreadPoolJob
+    addJob (new ThreadPoolHelpers::LambdaJobWrapper (jobToRun), true);
+}
+
+void ThreadPool::addJob (std::function<void()> jobToRun)
+{
+    addJob (new ThreadPoolHelpers::VoidLambdaJobWrapper (jobToRun), true);
+}
+
+void ThreadPool::addJobs (const Array<ThreadPoolJob*>& jobsToAdd, bool deleteJobsWhenFinished)
+{
+    Array<ThreadPoolJob*> jobsToQueue;
+    jobsToQueue.ensureStorageAllocated (jobsToAdd.size());
+
+    for (auto* job : jobsToAdd)
     {
-        LambdaJobWrapper (std::function<ThreadPoolJob::JobStatus()> j) : ThreadPoolJob ("lambda"), job (j) {}
-        JobStatus runJob() override      { return job(); }
+        jassert (job != nullptr);
+        jassert (job->pool == nullptr);
 
-        std::function<ThreadPoolJob::JobStatus()> job;
-    };
+        if (job->pool == nullptr)
+        {
+            prepareJobForAdding (job, deleteJobsWhenFinished);
+            jobsToQueue.add (job);
+        }
+    }
+
+    if (jobsToQueue.isEmpty())
+        return;
 
-    addJob (new LambdaJobWrapper (jobToRun), true);
+    if (scheduling == Scheduling::workStealing)
+    {
+        addJobsToQueues (jobsToQueue.begin(), jobsToQueue.size());
+        return;
+    }
+
+    {
+        const ScopedLock sl (lock);
+        jobs.addArray (jobsToQueue);
+    }
+
+    for (auto* t : threads)
+        t->notify();
 }
 
-void ThreadPool::addJob (std::function<void()> jobToRun)
+void ThreadPool::addJobs (const std::vector<std::function<void()>>& jobsToRun)
 {
-    struct LambdaJobWrapper  : public ThreadPoolJob
-    {
-        LambdaJobWrapper (std::function<void()> j) : ThreadPoolJob ("lambda"), job (j) {}
-        JobStatus runJob() override      { job(); return ThreadPoolJob::jobHasFinished; }
+    Array<ThreadPoolJob*> wrappers;
+    wrappers.ensureStorageAllocated ((int) jobsToRun.size());
 
-        std::function<void()> job;
-    };
+    for (auto& jobToRun : jobsToRun)
+        wrappers.add (new ThreadPoolHelpers::VoidLambdaJobWrapper (jobToRun));
 
-    addJob (new LambdaJobWrapper (jobToRun), true);
+    addJobs (wrappers, true);
 }
 
 int ThreadPool::getNumJobs() const noexcept
 {
+    if (scheduling == Scheduling::workStealing)
+        return numQueuedJobs.load();
+
     const ScopedLock sl (lock);
     return jobs.size();
 }
@@ -187,24 +297,62 @@ int ThreadPool::getNumThreads() const noexcept
 
 ThreadPoolJob* ThreadPool::getJob (int index) const noexcept
 {
+    if (scheduling == Scheduling::workStealing)
+    {
+        const ScopedQueuesLock sql (*this);
+        return getJobsInQueues()[index];
+    }
+
     const ScopedLock sl (lock);
     return jobs [index];
 }
 
 bool ThreadPool::contains (const ThreadPoolJob* job) const noexcept
 {
+    if (scheduling == Scheduling::workStealing)
+    {
+        const ScopedQueuesLock sql (*this);
+        return getJobsInQueues().contains (const_cast<ThreadPoolJob*> (job));
+    }
+
     const ScopedLock sl (lock);
     return jobs.contains (const_cast<ThreadPoolJob*> (job));
 }
 
 bool ThreadPool::isJobRunning (const ThreadPoolJob* job) const noexcept
 {
+    if (scheduling == Scheduling::workStealing)
+    {
+        const ScopedQueuesLock sql (*this);
+        return getJobsInQueues().contains (const_cast<ThreadPoolJob*> (job)) && job->isActive;
+    }
+
     const ScopedLock sl (lock);
     return jobs.contains (const_cast<ThreadPoolJob*> (job)) && job->isActive;
 }
 
 void ThreadPool::moveJobToFront (const ThreadPoolJob* job) noexcept
 {
+    if (scheduling == Scheduling::workStealing)
+    {
+        // To the front of the queue it is in
+        const ScopedQueuesLock sql (*this);
+
+        for (auto* t : threads)
+        {
+            auto found = std::find (t->queue.begin(), t->queue.end(), job);
+
+            if (found != t->queue.end())
+            {
+                t->queue.erase (found);
+                t->queue.push_front (const_cast<ThreadPoolJob*> (job));
+                return;
+            }
+        }
+
+        return;
+    }
+
     const ScopedLock sl (lock);
 
     auto index = jobs.indexOf (const_cast<ThreadPoolJob*> (job));
@@ -218,14 +366,20 @@ bool ThreadPool::waitForJobToFinish (const ThreadPoolJob* job, int timeOutMs) co
     if (job != nullptr)
     {
         auto start = Time::getMillisecondCounter();
+        ++numWaitingForJobs;
 
         while (contains (job))
         {
             if (timeOutMs >= 0 && Time::getMillisecondCounter() >= start + (uint32) timeOutMs)
+            {
+                --numWaitingForJobs;
                 return false;
+            }
 
             jobFinishedSignal.wait (2);
         }
+
+        --numWaitingForJobs;
     }
 
     return true;
@@ -236,7 +390,34 @@ bool ThreadPool::removeJob (ThreadPoolJob* job, bool interruptIfRunning, int tim
     bool dontWait = true;
     OwnedArray<ThreadPoolJob> deletionList;
 
-    if (job != nullptr)
+    if (job != nullptr && scheduling == Scheduling::workStealing)
+    {
+        const ScopedQueuesLock sql (*this);
+
+        for (auto* t : threads)
+        {
+            if (t->currentJob == job)
+            {
+                if (interruptIfRunning)
+                    job->signalJobShouldExit();
+
+                dontWait = false;
+                break;
+            }
+
+            auto found = std::find (t->queue.begin(), t->queue.end(), job);
+
+            if (found != t->queue.end())
+            {
+                t->queue.erase (found);
+                t->updateQueueSize();
+                addToDeleteList (deletionList, job);
+                --numQueuedJobs;
+                break;
+            }
+        }
+    }
+    else if (job != nullptr)
     {
         const ScopedLock sl (lock);
 
@@ -265,6 +446,43 @@ bool ThreadPool::removeAllJobs (bool interruptRunningJobs, int timeOutMs,
 {
     Array<ThreadPoolJob*> jobsToWaitFor;
 
+    if (scheduling == Scheduling::workStealing)
+    {
+        OwnedArray<ThreadPoolJob> deletionList;
+
+        {
+            const ScopedQueuesLock sql (*this);
+
+            for (auto* t : threads)
+            {
+                if (auto* job = t->currentJob.load())
+                {
+                    if (selectedJobsToRemove == nullptr || selectedJobsToRemove->isJobSuitable (job))
+                    {
+                        jobsToWaitFor.add (job);
+
+                        if (interruptRunningJobs)
+                            job->signalJobShouldExit();
+                    }
+                }
+
+                for (auto i = t->queue.size(); i-- > 0;)
+                {
+                    auto* job = t->queue[i];
+
+                    if (selectedJobsToRemove == nullptr || selectedJobsToRemove->isJobSuitable (job))
+                    {
+                        t->queue.erase (t->queue.begin() + (std::ptrdiff_t) i);
+                        addToDeleteList (deletionList, job);
+                        --numQueuedJobs;
+                    }
+                }
+
+                t->updateQueueSize();
+            }
+        }
+    }
+    else
     {
         OwnedArray<ThreadPoolJob> deletionList;
 
@@ -295,6 +513,7 @@ bool ThreadPool::removeAllJobs (bool interruptRunningJobs, int timeOutMs,
     }
 
     auto start = Time::getMillisecondCounter();
+    ++numWaitingForJobs;
 
     for (;;)
     {
@@ -310,17 +529,33 @@ bool ThreadPool::removeAllJobs (bool interruptRunningJobs, int timeOutMs,
             break;
 
         if (timeOutMs >= 0 && Time::getMillisecondCounter() >= start + (uint32) timeOutMs)
+        {
+            --numWaitingForJobs;
             return false;
+        }
 
         jobFinishedSignal.wait (20);
     }
 
+    --numWaitingForJobs;
     return true;
 }
 
 StringArray ThreadPool::getNamesOfAllJobs (bool onlyReturnActiveJobs) const
 {
     StringArray s;
+
+    if (scheduling == Scheduling::workStealing)
+    {
+        const ScopedQueuesLock sql (*this);
+
+        for (auto* job : getJobsInQueues())
+            if (job->isActive || ! onlyReturnActiveJobs)
+                s.add (job->getJobName());
+
+        return s;
+    }
+
     const ScopedLock sl (lock);
 
     for (auto* job : jobs)
@@ -374,6 +609,9 @@ ThreadPoolJob* ThreadPool::pickNextJobToRun()
 
 bool ThreadPool::runNextJob (ThreadPoolThread& thread)
 {
+    if (scheduling == Scheduling::workStealing)
+        return runNextJobFromQueues (thread);
+
     if (auto* job = pickNextJobToRun())
     {
         auto result = ThreadPoolJob::jobHasFinished;
@@ -429,4 +667,367 @@ void ThreadPool::addToDeleteList (OwnedArray<ThreadPoolJob>& deletionList, Threa
         deletionList.add (job);
 }
 
+void ThreadPool::waitForJobs (ThreadPoolThread& thread)
+{
+    if (scheduling != Scheduling::workStealing)
+    {
+        thread.wait (500);
+        return;
+    }
+
+    // Adding jobs only wakes idle threads, so the thread counts as idle
+    // before it checks the queues once more
+    thread.isIdle = true;
+    ++numIdleThreads;
+
+    if (! hasQueuedJobs())
+        thread.wait (500);
+
+    thread.isIdle = false;
+    --numIdleThreads;
+}
+
+void ThreadPool::signalJobFinished()
+{
+    if (numWaitingForJobs.load() > 0)
+        jobFinishedSignal.signal();
+}
+
+//==============================================================================
+ThreadPool::ThreadPoolThread* ThreadPool::getCallingThread() const
+{
+    auto* t = dynamic_cast<ThreadPoolThread*> (Thread::getCurrentThread());
+    return t != nullptr && &t->pool == this ? t : nullptr;
+}
+
+void ThreadPool::addJobsToQueues (ThreadPoolJob* const* jobsToAdd, int numJobs)
+{
+    numQueuedJobs += numJobs;
+
+    if (auto* caller = getCallingThread())
+    {
+        // A job's own jobs go on its thread's queue, for the others to steal
+        const SpinLock::ScopedLockType sl (caller->queueLock);
+        caller->queue.insert (caller->queue.end(), jobsToAdd, jobsToAdd + numJobs);
+        caller->updateQueueSize();
+    }
+    else
+    {
+        // Runs of jobs in turn to each queue, from the one after the queue
+        // that was given the last call's first job
+        const auto numThreads = threads.size();
+        const auto first = (int) (nextQueue++ % (uint32) numThreads);
+        int start = 0;
+
+        for (int i = 0; i < numThreads && start < numJobs; ++i)
+        {
+            auto* t = threads.getUnchecked ((first + i) % numThreads);
+            const auto end = start + (numJobs - start + numThreads - i - 1) / (numThreads - i);
+
+            const SpinLock::ScopedLockType sl (t->queueLock);
+            t->queue.insert (t->queue.end(), jobsToAdd + start, jobsToAdd + end);
+            t->updateQueueSize();
+            start = end;
+        }
+    }
+
+    // As many idle threads as there are new jobs
+    if (numIdleThreads.load() > 0)
+    {
+        int numToWake = numJobs;
+
+        for (auto* t : threads)
+        {
+            if (numToWake == 0)
+                break;
+
+            if (t->isIdle.load())
+            {
+                t->notify();
+                --numToWake;
+            }
+        }
+    }
+}
+
+ThreadPoolJob* ThreadPool::takeJobFromQueues (ThreadPoolThread& thread)
+{
+    OwnedArray<ThreadPoolJob> deletionList;
+
+    // Takes a job from a locked queue and makes it the thread's current job,
+    // dropping any that were asked to stop while queued
+    auto take = [this, &thread, &deletionList] (ThreadPoolThread& source, bool oldest) -> ThreadPoolJob*
+    {
+        while (! source.queue.empty())
+        {
+            auto* job = oldest ? source.queue.front() : source.queue.back();
+
+            if (oldest)
+                source.queue.pop_front();
+            else
+                source.queue.pop_back();
+
+            source.updateQueueSize();
+
+            if (job->shouldStop)
+            {
+                addToDeleteList (deletionList, job);
+                --numQueuedJobs;
+                continue;
+            }
+
+            job->isActive = true;
+            thread.currentJob = job;
+            return job;
+        }
+
+        return nullptr;
+    };
+
+    {
+        const SpinLock::ScopedLockType sl (thread.queueLock);
+
+        if (auto* job = take (thread, true))
+            return job;
+    }
+
+    const auto numThreads = threads.size();
+    const auto firstVictim = thread.pickRandomThread (numThreads);
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        auto& victim = *threads.getUnchecked ((firstVictim + i) % numThreads);
+
+        if (&victim == &thread || victim.numQueued.load() == 0)
+            continue;
+
+        auto& firstLock  = victim.index < thread.index ? victim.queueLock : thread.queueLock;
+        auto& secondLock = victim.index < thread.index ? thread.queueLock : victim.queueLock;
+
+        const SpinLock::ScopedLockType sl1 (firstLock);
+        const SpinLock::ScopedLockType sl2 (secondLock);
+
+        if (auto* job = take (victim, false))
+            return job;
+    }
+
+    return nullptr;
+}
+
+bool ThreadPool::runNextJobFromQueues (ThreadPoolThread& thread)
+{
+    auto* job = takeJobFromQueues (thread);
+
+    if (job == nullptr)
+        return false;
+
+    auto result = ThreadPoolJob::jobHasFinished;
+
+    try
+    {
+        result = job->runJob();
+    }
+    catch (...)
+    {
+        jassertfalse; // Your runJob() method mustn't throw any exceptions!
+    }
+
+    OwnedArray<ThreadPoolJob> deletionList;
+    bool finished = false;
+
+    {
+        const SpinLock::ScopedLockType sl (thread.queueLock);
+
+        thread.currentJob = nullptr;
+        job->isActive = false;
+
+        if (result != ThreadPoolJob::jobNeedsRunningAgain || job->shouldStop)
+        {
+            addToDeleteList (deletionList, job);
+            finished = true;
+        }
+        else
+        {
+            // back of the thread's own queue if it wants another go
+            thread.queue.push_back (job);
+            thread.updateQueueSize();
+        }
+    }
+
+    if (finished)
+    {
+        --numQueuedJobs;
+        signalJobFinished();
+    }
+
+    return true;
+}
+
+bool ThreadPool::hasQueuedJobs() const noexcept
+{
+    for (auto* t : threads)
+        if (t->numQueued.load() > 0)
+            return true;
+
+    return false;
+}
+
+Array<ThreadPoolJob*> ThreadPool::getJobsInQueues() const
+{
+    // The running jobs, then the queued ones. The queues must be locked
+    Array<ThreadPoolJob*> result;
+
+    for (auto* t : threads)
+        if (auto* job = t->currentJob.load())
+            result.add (job);
+
+    for (auto* t : threads)
+        for (auto* job : t->queue)
+            result.add (job);
+
+    return result;
+}
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ThreadPoolTests  : public UnitTest
+{
+public:
+    ThreadPoolTests()
+        : UnitTest ("ThreadPool", UnitTestCategories::threads)
+    {}
+
+    void runTest() override
+    {
+        runTestsForScheduling (ThreadPool::Scheduling::sharedQueue, "shared queue");
+        runTestsForScheduling (ThreadPool::Scheduling::workStealing, "work stealing");
+    }
+
+private:
+    struct CountingJob  : public ThreadPoolJob
+    {
+        CountingJob (std::atomic<int>& c, int runs)  : ThreadPoolJob ("counting"), count (c), numRunsLeft (runs) {}
+
+        JobStatus runJob() override
+        {
+            ++count;
+            return --numRunsLeft > 0 ? jobNeedsRunningAgain : jobHasFinished;
+        }
+
+        std::atomic<int>& count;
+        int numRunsLeft;
+    };
+
+    struct BlockingJob  : public ThreadPoolJob
+    {
+        BlockingJob()  : ThreadPoolJob ("blocking") {}
+
+        JobStatus runJob() override
+        {
+            started.signal();
+
+            while (! shouldExit())
+                Thread::sleep (1);
+
+            return jobHasFinished;
+        }
+
+        WaitableEvent started;
+    };
+
+    void waitForJobs (ThreadPool& pool)
+    {
+        const auto start = Time::getMillisecondCounter();
+
+        while (pool.getNumJobs() > 0 && Time::getMillisecondCounter() - start < 10000)
+            Thread::sleep (1);
+
+        expectEquals (pool.getNumJobs(), 0);
+    }
+
+    void runTestsForScheduling (ThreadPool::Scheduling scheduling, const String& schedulingName)
+    {
+        beginTest ("Every job runs once, " + schedulingName);
+        {
+            ThreadPool pool (3, 0, scheduling);
+            std::atomic<int> count { 0 };
+            std::vector<std::function<void()>> lambdas (1000, [&count] { ++count; });
+
+            for (int i = 0; i < 1000; ++i)
+                pool.addJob ([&count] { ++count; });
+
+            pool.addJobs (lambdas);
+            waitForJobs (pool);
+            expectEquals (count.load(), 2000);
+        }
+
+        beginTest ("Jobs can add jobs, " + schedulingName);
+        {
+            ThreadPool pool (3, 0, scheduling);
+            std::atomic<int> count { 0 };
+
+            for (int i = 0; i < 10; ++i)
+            {
+                pool.addJob ([&pool, &count]
+                {
+                    for (int j = 0; j < 100; ++j)
+                        pool.addJob ([&count] { ++count; });
+                });
+            }
+
+            waitForJobs (pool);
+            expectEquals (count.load(), 1000);
+        }
+
+        beginTest ("Jobs can run again, " + schedulingName);
+        {
+            ThreadPool pool (2, 0, scheduling);
+            std::atomic<int> count { 0 };
+            OwnedArray<CountingJob> jobs;
+            Array<ThreadPoolJob*> jobsToAdd;
+
+            for (int i = 0; i < 20; ++i)
+                jobsToAdd.add (jobs.add (new CountingJob (count, 5)));
+
+            pool.addJobs (jobsToAdd, false);
+            waitForJobs (pool);
+            expectEquals (count.load(), 100);
+
+            for (auto* job : jobs)
+                expect (! pool.contains (job));
+        }
+
+        beginTest ("Jobs can be removed, " + schedulingName);
+        {
+            ThreadPool pool (1, 0, scheduling);
+            BlockingJob blocking;
+            std::atomic<int> count { 0 };
+            CountingJob queued (count, 1);
+
+            pool.addJob (&blocking, false);
+            expect (blocking.started.wait (10000));
+            pool.addJob (&queued, false);
+
+            expectEquals (pool.getNumJobs(), 2);
+            expect (pool.contains (&queued) && ! pool.isJobRunning (&queued));
+            expect (pool.isJobRunning (&blocking));
+            expect (pool.getNamesOfAllJobs (true) == StringArray ("blocking"));
+
+            expect (pool.removeJob (&queued, false, 1000));
+            expect (! pool.contains (&queued));
+
+            expect (pool.removeAllJobs (true, 10000));
+            expectEquals (pool.getNumJobs(), 0);
+            expectEquals (count.load(), 0);
+        }
+    }
+};
+
+static ThreadPoolTests threadPoolUnitTests;
+
+#endif
+
 } // namespace juce
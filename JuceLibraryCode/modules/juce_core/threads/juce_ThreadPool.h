@@ -148,6 +148,11 @@ private:
     When a ThreadPoolJob object is added to the ThreadPool's list, its runJob() method
     will be called by the next pooled thread that becomes free.
 
+    By default the threads take their jobs from one queue, in the order they were
+    added, behind one lock. For many small jobs that lock is contended, so a pool
+    can instead be created with Scheduling::workStealing, which gives each thread a
+    queue of its own.
+
     @see ThreadPoolJob, Thread
 
     @tags{Core}
@@ -156,6 +161,26 @@ class JUCE_API  ThreadPool
 {
 public:
     //==============================================================================
+    /** How the threads of a pool share out its jobs. */
+    enum class Scheduling
+    {
+        /** One queue for all the threads, run in the order the jobs were added. */
+        sharedQueue,
+
+        /** A queue for each thread. Jobs added from outside the pool are spread
+            over the queues, and jobs added by a running job go on its own
+            thread's queue. Each thread runs its own jobs in the order they were
+            added, and a thread whose queue is empty takes the newest job from
+            the queue of another thread, picked at random. The jobs then run
+            in no particular order.
+
+            Adding, running and finishing a job only locks the queue it is in,
+            but the calls that look at every job, such as contains(), getJob(),
+            removeJob() and getNamesOfAllJobs(), lock all of the queues.
+        */
+        workStealing
+    };
+
     /** Creates a thread pool.
         Once you've created a pool, you can give it some jobs by calling addJob().
 
@@ -164,8 +189,10 @@ public:
         @param threadStackSize  the size of the stack of each thread. If this value
                                 is zero then the default stack size of the OS will
                                 be used.
+        @param scheduling       how the threads share out the jobs
     */
-    ThreadPool (int numberOfThreads, size_t threadStackSize = 0);
+    ThreadPool (int numberOfThreads, size_t threadStackSize = 0,
+                Scheduling scheduling = Scheduling::sharedQueue);
 
     /** Creates a thread pool with one thread per CPU core.
         Once you've created a pool, you can give it some jobs by calling addJob().
@@ -230,6 +257,20 @@ public:
     */
     void addJob (std::function<void()> job);
 
+    /** Adds a number of jobs to the queue at once.
+
+        This does what calling addJob() for each of them would, but takes each lock
+        once and wakes the threads once, which is much faster for many small jobs.
+        With Scheduling::workStealing the jobs are split into one run per queue.
+    */
+    void addJobs (const Array<ThreadPoolJob*>& jobs,
+                  bool deleteJobsWhenFinished);
+
+    /** Adds a number of lambda functions to be called as jobs, at once.
+        @see addJobs
+    */
+    void addJobs (const std::vector<std::function<void()>>& jobs);
+
     /** Tries to remove a job from the pool.
 
         If the job isn't yet running, this will simply remove it. If it is running, it
@@ -315,6 +356,9 @@ public:
     */
     bool setThreadPriorities (int newPriority);
 
+    /** Returns how the threads of this pool share out its jobs. */
+    Scheduling getScheduling() const noexcept           { return scheduling; }
+
 
 private:
     //==============================================================================
@@ -327,11 +371,32 @@ private:
     CriticalSection lock;
     WaitableEvent jobFinishedSignal;
 
+    Scheduling scheduling = Scheduling::sharedQueue;
+
+    // With work stealing, the jobs queued or running, the threads about to
+    // wait for jobs, and the calls waiting for jobs to finish
+    std::atomic<int> numQueuedJobs { 0 }, numIdleThreads { 0 };
+    mutable std::atomic<int> numWaitingForJobs { 0 };
+    std::atomic<uint32> nextQueue { 0 };
+
+    struct ScopedQueuesLock;
+
     bool runNextJob (ThreadPoolThread&);
     ThreadPoolJob* pickNextJobToRun();
     void addToDeleteList (OwnedArray<ThreadPoolJob>&, ThreadPoolJob*) const;
     void createThreads (int numThreads, size_t threadStackSize = 0);
     void stopThreads();
+    void prepareJobForAdding (ThreadPoolJob*, bool deleteJobWhenFinished);
+    void waitForJobs (ThreadPoolThread&);
+    void signalJobFinished();
+
+    // Work stealing
+    void addJobsToQueues (ThreadPoolJob* const*, int numJobs);
+    ThreadPoolJob* takeJobFromQueues (ThreadPoolThread&);
+    bool runNextJobFromQueues (ThreadPoolThread&);
+    bool hasQueuedJobs() const noexcept;
+    Array<ThreadPoolJob*> getJobsInQueues() const;
+    ThreadPoolThread* getCallingThread() const;
 
     // Note that this method has changed, and no longer has a parameter to indicate
     // whether the jobs should be deleted - see the new method for details.
@@ -34,6 +34,63 @@ struct FFT::Instance
     virtual void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept = 0;
     virtual void performRealOnlyForwardTransform (float*, bool) const noexcept = 0;
     virtual void performRealOnlyInverseTransform (float*) const noexcept = 0;
+
+    // engines that need working space can take it from the caller, rather than
+    // allocating it on each call
+    virtual int getScratchSize() const noexcept     { return 0; }
+
+    virtual void performWithScratch (const Complex<float>* input, Complex<float>* output, bool inverse, float*) const noexcept
+    {
+        perform (input, output, inverse);
+    }
+
+    virtual void performRealOnlyForwardTransformWithScratch (float* d, bool ignoreNegativeFreqs, float*) const noexcept
+    {
+        performRealOnlyForwardTransform (d, ignoreNegativeFreqs);
+    }
+
+    virtual void performRealOnlyInverseTransformWithScratch (float* d, float*) const noexcept
+    {
+        performRealOnlyInverseTransform (d);
+    }
+
+    // several transforms of the same order at once. The defaults perform them one by one
+    virtual int getBatchScratchSize() const noexcept    { return getScratchSize(); }
+
+    virtual void performBatch (const Complex<float>* const* inputs, Complex<float>* const* outputs,
+                               int numTransforms, bool inverse, float* scratch) const noexcept
+    {
+        for (int i = 0; i < numTransforms; ++i)
+            performWithScratch (inputs[i], outputs[i], inverse, scratch);
+    }
+
+    virtual void performRealOnlyForwardTransformBatch (float* const* d, int numTransforms,
+                                                       bool ignoreNegativeFreqs, float* scratch) const noexcept
+    {
+        for (int i = 0; i < numTransforms; ++i)
+            performRealOnlyForwardTransformWithScratch (d[i], ignoreNegativeFreqs, scratch);
+    }
+
+    // calls the function with a scratch array of numFloats, on the stack if it is small
+    // enough. Instances are shared by every FFT of their order, and may be used from
+    // several threads at once, so they must not keep any working space of their own
+    template <typename Function>
+    static void withScratch (int numFloats, Function&& function) noexcept
+    {
+        const auto scratchSize = (size_t) numFloats * sizeof (float);
+
+        if (scratchSize < maxScratchSpaceToAlloca)
+        {
+            function (static_cast<float*> (alloca (scratchSize)));
+        }
+        else
+        {
+            HeapBlock<float> heapSpace ((size_t) numFloats);
+            function (heapSpace.get());
+        }
+    }
+
+    static constexpr size_t maxScratchSpaceToAlloca = 256 * 1024;
 };
 
 struct FFT::Engine
@@ -60,7 +117,30 @@ struct FFT::Engine
         return nullptr;
     }
 
+    /** Returns the instance that every FFT of the given order shares, creating it if
+        there is none alive.
+    */
+    static std::shared_ptr<const FFT::Instance> getSharedInstance (int order)
+    {
+        jassert (isPositiveAndBelow (order, maxOrder));
+
+        static CriticalSection lock;
+        static std::weak_ptr<const FFT::Instance> instances[maxOrder];
+
+        const ScopedLock sl (lock);
+        auto& cached = instances[jlimit (0, maxOrder - 1, order)];
+
+        if (auto instance = cached.lock())
+            return instance;
+
+        std::shared_ptr<const FFT::Instance> instance (createBestEngineForPlatform (order));
+        cached = instance;
+        return instance;
+    }
+
 private:
+    static constexpr int maxOrder = 31;
+
     static Array<Engine*>& getEngines()
     {
         static Array<Engine*> engines;
@@ -105,8 +185,6 @@ struct FFTFallback  : public FFT::Instance
             return;
         }
 
-        const SpinLock::ScopedLockType sl(processLock);
-
         jassert (configForward != nullptr);
 
         if (inverse)
@@ -124,42 +202,34 @@ struct FFTFallback  : public FFT::Instance
         }
     }
 
-    const size_t maxFFTScratchSpaceToAlloca = 256 * 1024;
-
-    void performRealOnlyForwardTransform (float* d, bool) const noexcept override
+    void performRealOnlyForwardTransform (float* d, bool ignoreNegativeFreqs) const noexcept override
     {
-        if (size == 1)
-            return;
-
-        const size_t scratchSize = 16 + (size_t) size * sizeof (Complex<float>);
-
-        if (scratchSize < maxFFTScratchSpaceToAlloca)
-        {
-            performRealOnlyForwardTransform (static_cast<Complex<float>*> (alloca (scratchSize)), d);
-        }
-        else
-        {
-            HeapBlock<char> heapSpace (scratchSize);
-            performRealOnlyForwardTransform (unalignedPointerCast<Complex<float>*> (heapSpace.getData()), d);
-        }
+        if (size != 1)
+            withScratch (getScratchSize(), [&] (float* scratch) { performRealOnlyForwardTransformWithScratch (d, ignoreNegativeFreqs, scratch); });
     }
 
     void performRealOnlyInverseTransform (float* d) const noexcept override
     {
-        if (size == 1)
-            return;
+        if (size != 1)
+            withScratch (getScratchSize(), [&] (float* scratch) { performRealOnlyInverseTransformWithScratch (d, scratch); });
+    }
 
-        const size_t scratchSize = 16 + (size_t) size * sizeof (Complex<float>);
+    int getScratchSize() const noexcept override
+    {
+        // a complex array of size points
+        return 2 * size;
+    }
 
-        if (scratchSize < maxFFTScratchSpaceToAlloca)
-        {
-            performRealOnlyInverseTransform (static_cast<Complex<float>*> (alloca (scratchSize)), d);
-        }
-        else
-        {
-            HeapBlock<char> heapSpace (scratchSize);
-            performRealOnlyInverseTransform (unalignedPointerCast<Complex<float>*> (heapSpace.getData()), d);
-        }
+    void performRealOnlyForwardTransformWithScratch (float* d, bool, float* scratch) const noexcept override
+    {
+        if (size != 1)
+            performRealOnlyForwardTransform (unalignedPointerCast<Complex<float>*> (scratch), d);
+    }
+
+    void performRealOnlyInverseTransformWithScratch (float* d, float* scratch) const noexcept override
+    {
+        if (size != 1)
+            performRealOnlyInverseTransform (unalignedPointerCast<Complex<float>*> (scratch), d);
     }
 
     void performRealOnlyForwardTransform (Complex<float>* scratch, float* d) const noexcept
@@ -414,13 +484,611 @@ struct FFTFallback  : public FFT::Instance
     };
 
     //==============================================================================
-    SpinLock processLock;
     std::unique_ptr<FFTConfig> configForward, configInverse;
     int size;
 };
 
 FFT::EngineImpl<FFTFallback> fftFallback;
 
+//==============================================================================
+//==============================================================================
+#if JUCE_USE_SIMD
+/*  An iterative radix-4 Stockham FFT, vectorised with SIMDRegister.
+
+    The data is kept as separate arrays of real and imaginary parts, so that each
+    register holds the same part of consecutive points. Each stage reads from one
+    buffer and writes to the other, so there is no bit-reversal pass, and a final
+    radix-2 stage is added for odd orders. The inverse is the forward transform of
+    the conjugate.
+
+    A real signal of size N is transformed as a complex one of size N / 2, holding
+    the even samples in its real part and the odd ones in its imaginary part, and
+    the result is then split into the spectrum of the real signal.
+
+    Batches of transforms are done a register's worth at a time, with each lane
+    holding a different transform. Every point is then a whole register, so all the
+    stages are fully vectorised, with none of the scattering of the narrow stages.
+
+    The twiddles are all computed once, and the working space is per call, so an
+    instance is never written to after it is made.
+*/
+struct FFTSIMDRadix4  : public FFT::Instance
+{
+    // faster than the fallback, but not as fast as any of the platform libraries
+    static constexpr int priority = 0;
+
+    using Register = SIMDRegister<float>;
+    static constexpr int numLanes = (int) Register::SIMDNumElements;
+
+    static FFTSIMDRadix4* create (int order)
+    {
+        // the smallest sizes don't fill the registers of the half-size plan, and
+        // are left to the fallback
+        if ((1 << order) < 8 * numLanes)
+            return nullptr;
+
+        return new FFTSIMDRadix4 (order);
+    }
+
+    FFTSIMDRadix4 (int order)
+        : size (1 << order),
+          complexPlan (size),
+          realPlan (size / 2)
+    {
+        const int half = size / 2;
+        splitTwiddles.malloc ((size_t) (2 * half));
+
+        for (int k = 0; k < half; ++k)
+        {
+            const auto angle = -MathConstants<double>::twoPi * k / size;
+            splitTwiddles[2 * k]     = (float) std::cos (angle);
+            splitTwiddles[2 * k + 1] = (float) std::sin (angle);
+        }
+    }
+
+    void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept override
+    {
+        withScratch (getScratchSize(), [&] (float* scratch) { performWithScratch (input, output, inverse, scratch); });
+    }
+
+    void performRealOnlyForwardTransform (float* d, bool ignoreNegativeFreqs) const noexcept override
+    {
+        withScratch (getScratchSize(), [&] (float* scratch) { performRealOnlyForwardTransformWithScratch (d, ignoreNegativeFreqs, scratch); });
+    }
+
+    void performRealOnlyInverseTransform (float* d) const noexcept override
+    {
+        withScratch (getScratchSize(), [&] (float* scratch) { performRealOnlyInverseTransformWithScratch (d, scratch); });
+    }
+
+    int getScratchSize() const noexcept override
+    {
+        // four arrays of size floats, and room to align them
+        return 4 * size + numLanes;
+    }
+
+    void performWithScratch (const Complex<float>* input, Complex<float>* output, bool inverse, float* scratch) const noexcept override
+    {
+        auto* re = snapPointerToAlignment (scratch, Register::SIMDRegisterSize);
+        auto* im = re + size;
+        const auto sign = inverse ? -1.0f : 1.0f;
+
+        for (int i = 0; i < size; ++i)
+        {
+            re[i] = input[i].real();
+            im[i] = sign * input[i].imag();
+        }
+
+        const auto result = complexPlan.perform (re, im, im + size, im + 2 * size);
+        const auto scale = inverse ? 1.0f / (float) size : 1.0f;
+
+        for (int i = 0; i < size; ++i)
+            output[i] = { scale * result[0][i], sign * scale * result[1][i] };
+    }
+
+    void performRealOnlyForwardTransformWithScratch (float* d, bool ignoreNegativeFreqs, float* scratch) const noexcept override
+    {
+        const int half = size / 2;
+        auto* re = snapPointerToAlignment (scratch, Register::SIMDRegisterSize);
+        auto* im = re + half;
+
+        for (int i = 0; i < half; ++i)
+        {
+            re[i] = d[2 * i];
+            im[i] = d[2 * i + 1];
+        }
+
+        const auto result = realPlan.perform (re, im, im + half, im + 2 * half);
+        const auto* zr = result[0];
+        const auto* zi = result[1];
+        auto* output = reinterpret_cast<Complex<float>*> (d);
+
+        output[0]    = { zr[0] + zi[0], 0.0f };
+        output[half] = { zr[0] - zi[0], 0.0f };
+
+        // X[k] = E[k] + w^k O[k], where E and O are the spectra of the even and odd samples:
+        // E[k] = (Z[k] + Z*[h - k]) / 2 and O[k] = -i (Z[k] - Z*[h - k]) / 2
+        for (int k = 1; k < half; ++k)
+        {
+            const auto evenR = 0.5f * (zr[k] + zr[half - k]);
+            const auto evenI = 0.5f * (zi[k] - zi[half - k]);
+            const auto oddR  = 0.5f * (zi[k] + zi[half - k]);
+            const auto oddI  = 0.5f * (zr[half - k] - zr[k]);
+            const auto wr = splitTwiddles[2 * k], wi = splitTwiddles[2 * k + 1];
+
+            output[k] = { evenR + wr * oddR - wi * oddI,
+                          evenI + wr * oddI + wi * oddR };
+        }
+
+        if (! ignoreNegativeFreqs)
+            for (int k = half + 1; k < size; ++k)
+                output[k] = std::conj (output[size - k]);
+    }
+
+    void performRealOnlyInverseTransformWithScratch (float* d, float* scratch) const noexcept override
+    {
+        const int half = size / 2;
+        auto* re = snapPointerToAlignment (scratch, Register::SIMDRegisterSize);
+        auto* im = re + half;
+        const auto* input = reinterpret_cast<const Complex<float>*> (d);
+
+        // the reverse of the split: Z[k] = E[k] + i O[k], with E[k] = (X[k] + X*[h - k]) / 2
+        // and O[k] = w^-k (X[k] - X*[h - k]) / 2. It is conjugated, for an inverse transform
+        for (int k = 0; k < half; ++k)
+        {
+            const auto xr = input[k].real(), xi = input[k].imag();
+            const auto yr = input[half - k].real(), yi = input[half - k].imag();
+            const auto wr = splitTwiddles[2 * k], wi = splitTwiddles[2 * k + 1];
+
+            const auto diffR = xr - yr, diffI = xi + yi;
+            const auto oddR = 0.5f * (diffR * wr + diffI * wi);
+            const auto oddI = 0.5f * (diffI * wr - diffR * wi);
+
+            re[k] = 0.5f * (xr + yr) - oddI;
+            im[k] = -(0.5f * (xi - yi) + oddR);
+        }
+
+        const auto result = realPlan.perform (re, im, im + half, im + 2 * half);
+        const auto scale = 1.0f / (float) half;
+
+        for (int i = 0; i < half; ++i)
+        {
+            d[2 * i]     = scale * result[0][i];
+            d[2 * i + 1] = -scale * result[1][i];
+        }
+    }
+
+
+    //==============================================================================
+    int getBatchScratchSize() const noexcept override
+    {
+        // four arrays of size registers, and room to align them
+        return 4 * size * numLanes + numLanes;
+    }
+
+    void performBatch (const Complex<float>* const* inputs, Complex<float>* const* outputs,
+                       int numTransforms, bool inverse, float* scratch) const noexcept override
+    {
+        const int groupSize = size * numLanes;
+        auto* re = snapPointerToAlignment (scratch, Register::SIMDRegisterSize);
+        auto* im = re + groupSize;
+        const auto sign = inverse ? -1.0f : 1.0f;
+        const auto scale = inverse ? 1.0f / (float) size : 1.0f;
+
+        for (int first = 0; first < numTransforms; first += numLanes)
+        {
+            const int numInGroup = jmin (numLanes, numTransforms - first);
+
+            // a group that would leave most lanes empty is quicker done one by one
+            if (numInGroup * 2 <= numLanes)
+            {
+                for (int i = first; i < numTransforms; ++i)
+                    performWithScratch (inputs[i], outputs[i], inverse, scratch);
+
+                break;
+            }
+
+            if (numInGroup < numLanes)
+                zeromem (re, 2 * (size_t) groupSize * sizeof (float));
+
+            for (int i = 0; i < size; ++i)
+            {
+                for (int lane = 0; lane < numInGroup; ++lane)
+                {
+                    re[i * numLanes + lane] = inputs[first + lane][i].real();
+                    im[i * numLanes + lane] = sign * inputs[first + lane][i].imag();
+                }
+            }
+
+            const auto result = complexPlan.performBatch (re, im, im + groupSize, im + 2 * groupSize);
+
+            for (int i = 0; i < size; ++i)
+                for (int lane = 0; lane < numInGroup; ++lane)
+                    outputs[first + lane][i] = { scale * result[0][i * numLanes + lane], sign * scale * result[1][i * numLanes + lane] };
+        }
+    }
+
+    void performRealOnlyForwardTransformBatch (float* const* d, int numTransforms,
+                                               bool ignoreNegativeFreqs, float* scratch) const noexcept override
+    {
+        const int half = size / 2;
+        const int groupSize = half * numLanes;
+        auto* re = snapPointerToAlignment (scratch, Register::SIMDRegisterSize);
+        auto* im = re + groupSize;
+
+        for (int first = 0; first < numTransforms; first += numLanes)
+        {
+            const int numInGroup = jmin (numLanes, numTransforms - first);
+
+            if (numInGroup * 2 <= numLanes)
+            {
+                for (int i = first; i < numTransforms; ++i)
+                    performRealOnlyForwardTransformWithScratch (d[i], ignoreNegativeFreqs, scratch);
+
+                break;
+            }
+
+            if (numInGroup < numLanes)
+                zeromem (re, 2 * (size_t) groupSize * sizeof (float));
+
+            for (int i = 0; i < half; ++i)
+            {
+                for (int lane = 0; lane < numInGroup; ++lane)
+                {
+                    re[i * numLanes + lane] = d[first + lane][2 * i];
+                    im[i * numLanes + lane] = d[first + lane][2 * i + 1];
+                }
+            }
+
+            const auto result = realPlan.performBatch (re, im, im + groupSize, im + 2 * groupSize);
+            const auto* zr = result[0];
+            const auto* zi = result[1];
+
+            // the split, as in performRealOnlyForwardTransformWithScratch(), into whichever
+            // pair of arrays doesn't hold the result
+            auto* outRe = zr == re ? im + groupSize : re;
+            auto* outIm = outRe + groupSize;
+            const auto oneHalf = Register::expand (0.5f);
+
+            for (int k = 1; k < half; ++k)
+            {
+                const auto zkr = Register::fromRawArray (zr + k * numLanes),          zki = Register::fromRawArray (zi + k * numLanes);
+                const auto zcr = Register::fromRawArray (zr + (half - k) * numLanes), zci = Register::fromRawArray (zi + (half - k) * numLanes);
+                const auto wr = Register::expand (splitTwiddles[2 * k]), wi = Register::expand (splitTwiddles[2 * k + 1]);
+
+                const auto evenR = oneHalf * (zkr + zcr);
+                const auto evenI = oneHalf * (zki - zci);
+                const auto oddR  = oneHalf * (zki + zci);
+                const auto oddI  = oneHalf * (zcr - zkr);
+
+                (evenR + wr * oddR - wi * oddI).copyToRawArray (outRe + k * numLanes);
+                (evenI + wr * oddI + wi * oddR).copyToRawArray (outIm + k * numLanes);
+            }
+
+            for (int lane = 0; lane < numInGroup; ++lane)
+            {
+                auto* output = reinterpret_cast<Complex<float>*> (d[first + lane]);
+
+                output[0]    = { zr[lane] + zi[lane], 0.0f };
+                output[half] = { zr[lane] - zi[lane], 0.0f };
+
+                for (int k = 1; k < half; ++k)
+                    output[k] = { outRe[k * numLanes + lane], outIm[k * numLanes + lane] };
+
+                if (! ignoreNegativeFreqs)
+                    for (int k = half + 1; k < size; ++k)
+                        output[k] = std::conj (output[size - k]);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    /** The stages and twiddles of a complex forward transform. */
+    struct Plan
+    {
+        explicit Plan (int sizeToUse)
+            : size (sizeToUse)
+        {
+            int numTwiddles = 0;
+
+            for (int length = size, stride = 1; length >= 4; length /= 4, stride *= 4)
+            {
+                Stage stage;
+                stage.length = length;
+                stage.stride = stride;
+                stage.strideShift = countNumberOfBits ((uint32) stride - 1);
+
+                // While a stage's stride is narrower than a register, it is vectorised
+                // over the point index rather than the stride, and needs a twiddle per point
+                stage.perPoint = stride < numLanes;
+                stage.numTwiddles = stage.perPoint ? size / 4 : length / 4;
+
+                numTwiddles += 6 * (stage.numTwiddles + numLanes);
+                stages.add (stage);
+            }
+
+            hasRadix2Stage = (countNumberOfBits ((uint32) size - 1) & 1) != 0;
+
+            twiddleStorage.calloc ((size_t) (numTwiddles + numLanes));
+            auto* twiddles = snapPointerToAlignment (twiddleStorage.get(), Register::SIMDRegisterSize);
+
+            for (auto& stage : stages)
+            {
+                for (auto*& array : stage.twiddles)
+                {
+                    array = twiddles;
+                    twiddles += (stage.numTwiddles + numLanes) / numLanes * numLanes;
+                }
+
+                for (int i = 0; i < stage.numTwiddles; ++i)
+                {
+                    const auto p = stage.perPoint ? (i >> stage.strideShift) : i;
+
+                    for (int k = 1; k <= 3; ++k)
+                    {
+                        const auto angle = -MathConstants<double>::twoPi * k * p / stage.length;
+                        stage.twiddles[2 * (k - 1)][i]     = (float) std::cos (angle);
+                        stage.twiddles[2 * (k - 1) + 1][i] = (float) std::sin (angle);
+                    }
+                }
+            }
+        }
+
+        /** Transforms re and im, which must be aligned, using the temp arrays, and
+            returns the arrays holding the result.
+        */
+        std::array<const float*, 2> perform (float* re, float* im, float* tempRe, float* tempIm) const noexcept
+        {
+            for (auto& stage : stages)
+            {
+                if (stage.perPoint)
+                    performStagePerPoint (stage, re, im, tempRe, tempIm);
+                else
+                    performStage (stage, re, im, tempRe, tempIm);
+
+                std::swap (re, tempRe);
+                std::swap (im, tempIm);
+            }
+
+            if (hasRadix2Stage)
+            {
+                const int half = size / 2;
+
+                for (int i = 0; i < half; i += numLanes)
+                {
+                    const auto ar = Register::fromRawArray (re + i),        ai = Register::fromRawArray (im + i);
+                    const auto br = Register::fromRawArray (re + half + i), bi = Register::fromRawArray (im + half + i);
+
+                    (ar + br).copyToRawArray (tempRe + i);
+                    (ai + bi).copyToRawArray (tempIm + i);
+                    (ar - br).copyToRawArray (tempRe + half + i);
+                    (ai - bi).copyToRawArray (tempIm + half + i);
+                }
+
+                return {{ tempRe, tempIm }};
+            }
+
+            return {{ re, im }};
+        }
+
+        /** Transforms numLanes signals at once, with the points of each in one lane of
+            a register: re and im hold size registers, and must be aligned.
+        */
+        std::array<const float*, 2> performBatch (float* re, float* im, float* tempRe, float* tempIm) const noexcept
+        {
+            const int quarter = size / 4;
+            Register r[4], j[4], w[6];
+
+            for (auto& stage : stages)
+            {
+                const int stride = stage.stride;
+
+                for (int p = 0; p < stage.length / 4; ++p)
+                {
+                    for (int k = 0; k < 6; ++k)
+                        w[k] = Register::expand (stage.twiddles[k][stage.perPoint ? (p << stage.strideShift) : p]);
+
+                    for (int q = 0; q < stride; ++q)
+                    {
+                        const int in = (stride * p + q) * numLanes;
+                        const int out = (4 * stride * p + q) * numLanes;
+
+                        load (re + in, im + in, quarter * numLanes, r, j);
+                        butterfly (r, j);
+
+                        if (p != 0)
+                            rotate (r, j, w);
+
+                        store (r, j, tempRe + out, tempIm + out, stride * numLanes);
+                    }
+                }
+
+                std::swap (re, tempRe);
+                std::swap (im, tempIm);
+            }
+
+            if (hasRadix2Stage)
+            {
+                const int half = size / 2 * numLanes;
+
+                for (int i = 0; i < half; i += numLanes)
+                {
+                    const auto ar = Register::fromRawArray (re + i),        ai = Register::fromRawArray (im + i);
+                    const auto br = Register::fromRawArray (re + half + i), bi = Register::fromRawArray (im + half + i);
+
+                    (ar + br).copyToRawArray (tempRe + i);
+                    (ai + bi).copyToRawArray (tempIm + i);
+                    (ar - br).copyToRawArray (tempRe + half + i);
+                    (ai - bi).copyToRawArray (tempIm + half + i);
+                }
+
+                return {{ tempRe, tempIm }};
+            }
+
+            return {{ re, im }};
+        }
+
+    private:
+        struct Stage
+        {
+            int length, stride, strideShift, numTwiddles;
+            bool perPoint;
+
+            // the real and imaginary parts of w, w^2 and w^3
+            float* twiddles[6];
+        };
+
+        /** A stage whose stride is at least a register wide: the points of each
+            butterfly are whole registers apart in both the input and the output.
+        */
+        void performStage (const Stage& stage, const float* re, const float* im, float* outRe, float* outIm) const noexcept
+        {
+            const int stride = stage.stride;
+            const int quarter = size / 4;
+            Register r[4], j[4];
+
+            for (int p = 0; p < stage.length / 4; ++p)
+            {
+                const auto* in = re + stride * p;
+                const auto* inIm = im + stride * p;
+                auto* out = outRe + 4 * stride * p;
+                auto* outI = outIm + 4 * stride * p;
+
+                if (p == 0)
+                {
+                    for (int q = 0; q < stride; q += numLanes)
+                    {
+                        load (in + q, inIm + q, quarter, r, j);
+                        butterfly (r, j);
+                        store (r, j, out + q, outI + q, stride);
+                    }
+                }
+                else
+                {
+                    Register w[6];
+
+                    for (int k = 0; k < 6; ++k)
+                        w[k] = Register::expand (stage.twiddles[k][p]);
+
+                    for (int q = 0; q < stride; q += numLanes)
+                    {
+                        load (in + q, inIm + q, quarter, r, j);
+                        butterfly (r, j);
+                        rotate (r, j, w);
+                        store (r, j, out + q, outI + q, stride);
+                    }
+                }
+            }
+        }
+
+        /** A stage whose stride is narrower than a register: each register holds
+            consecutive butterflies, whose outputs are scattered.
+        */
+        void performStagePerPoint (const Stage& stage, const float* re, const float* im, float* outRe, float* outIm) const noexcept
+        {
+            const int quarter = size / 4;
+            const int strideMask = stage.stride - 1;
+            Register r[4], j[4], w[6];
+            alignas (Register::SIMDRegisterSize) float results[8][numLanes];
+
+            for (int i = 0; i < quarter; i += numLanes)
+            {
+                load (re + i, im + i, quarter, r, j);
+                butterfly (r, j);
+
+                for (int k = 0; k < 6; ++k)
+                    w[k] = Register::fromRawArray (stage.twiddles[k] + i);
+
+                rotate (r, j, w);
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    r[k].copyToRawArray (results[2 * k]);
+                    j[k].copyToRawArray (results[2 * k + 1]);
+                }
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    // butterfly p, q goes to q + 4 stride p
+                    const auto point = i + lane;
+                    const auto base = (point & strideMask) + ((point & ~strideMask) << 2);
+
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        outRe[base + k * stage.stride] = results[2 * k][lane];
+                        outIm[base + k * stage.stride] = results[2 * k + 1][lane];
+                    }
+                }
+            }
+        }
+
+        static forcedinline void load (const float* re, const float* im, int step, Register* r, Register* j) noexcept
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                r[k] = Register::fromRawArray (re + k * step);
+                j[k] = Register::fromRawArray (im + k * step);
+            }
+        }
+
+        static forcedinline void store (const Register* r, const Register* j, float* re, float* im, int step) noexcept
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                r[k].copyToRawArray (re + k * step);
+                j[k].copyToRawArray (im + k * step);
+            }
+        }
+
+        /** The radix-4 butterfly of a, b, c and d, before the twiddles. */
+        static forcedinline void butterfly (Register* r, Register* j) noexcept
+        {
+            const auto sumACr = r[0] + r[2], sumACi = j[0] + j[2];
+            const auto diffACr = r[0] - r[2], diffACi = j[0] - j[2];
+            const auto sumBDr = r[1] + r[3], sumBDi = j[1] + j[3];
+            const auto diffBDr = r[1] - r[3], diffBDi = j[1] - j[3];
+
+            r[0] = sumACr + sumBDr;     j[0] = sumACi + sumBDi;
+            r[1] = diffACr + diffBDi;   j[1] = diffACi - diffBDr;   // (a - c) - i (b - d)
+            r[2] = sumACr - sumBDr;     j[2] = sumACi - sumBDi;
+            r[3] = diffACr - diffBDi;   j[3] = diffACi + diffBDr;   // (a - c) + i (b - d)
+        }
+
+        /** Multiplies the last three outputs of a butterfly by the twiddles. */
+        static forcedinline void rotate (Register* r, Register* j, const Register* w) noexcept
+        {
+            for (int k = 1; k < 4; ++k)
+            {
+                const auto& wr = w[2 * (k - 1)];
+                const auto& wi = w[2 * (k - 1) + 1];
+                const auto real = r[k] * wr - j[k] * wi;
+                j[k] = r[k] * wi + j[k] * wr;
+                r[k] = real;
+            }
+        }
+
+        const int size;
+        Array<Stage> stages;
+        bool hasRadix2Stage = false;
+        HeapBlock<float> twiddleStorage;
+
+        JUCE_DECLARE_NON_COPYABLE (Plan)
+    };
+
+    //==============================================================================
+    const int size;
+    const Plan complexPlan, realPlan;
+
+    // the real and imaginary parts of w^k, for the split of the half-size transform
+    HeapBlock<float> splitTwiddles;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FFTSIMDRadix4)
+};
+
+FFT::EngineImpl<FFTSIMDRadix4> fftSIMDRadix4;
+#endif
+
 //==============================================================================
 //==============================================================================
 #if (JUCE_MAC || JUCE_IOS) && JUCE_USE_VDSP_FRAMEWORK
@@ -826,26 +1494,47 @@ public:
     }
 
     void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept override
+    {
+        withScratch (getScratchSize(), [&] (float* scratch) { performWithScratch (input, output, inverse, scratch); });
+    }
+
+    void performRealOnlyForwardTransform (float* inoutData, bool ignoreNegativeFreqs) const noexcept override
+    {
+        withScratch (getScratchSize(), [&] (float* scratch) { performRealOnlyForwardTransformWithScratch (inoutData, ignoreNegativeFreqs, scratch); });
+    }
+
+    void performRealOnlyInverseTransform (float* inoutData) const noexcept override
+    {
+        withScratch (getScratchSize(), [&] (float* scratch) { performRealOnlyInverseTransformWithScratch (inoutData, scratch); });
+    }
+
+    int getScratchSize() const noexcept override
+    {
+        // the larger of the two work buffers, and room to align it
+        return (jmax (cplx.workSize, real.workSize) + workBufferAlignment) / (int) sizeof (float) + 1;
+    }
+
+    void performWithScratch (const Complex<float>* input, Complex<float>* output, bool inverse, float* scratch) const noexcept override
     {
         if (inverse)
         {
             ippsFFTInv_CToC_32fc (reinterpret_cast<const Ipp32fc*> (input),
                                   reinterpret_cast<Ipp32fc*> (output),
                                   cplx.specPtr,
-                                  cplx.workBuf.get());
+                                  getWorkBuffer (scratch));
         }
         else
         {
             ippsFFTFwd_CToC_32fc (reinterpret_cast<const Ipp32fc*> (input),
                                   reinterpret_cast<Ipp32fc*> (output),
                                   cplx.specPtr,
-                                  cplx.workBuf.get());
+                                  getWorkBuffer (scratch));
         }
     }
 
-    void performRealOnlyForwardTransform (float* inoutData, bool ignoreNegativeFreqs) const noexcept override
+    void performRealOnlyForwardTransformWithScratch (float* inoutData, bool ignoreNegativeFreqs, float* scratch) const noexcept override
     {
-        ippsFFTFwd_RToCCS_32f_I (inoutData, real.specPtr, real.workBuf.get());
+        ippsFFTFwd_RToCCS_32f_I (inoutData, real.specPtr, getWorkBuffer (scratch));
 
         if (order == 0)
             return;
@@ -858,15 +1547,23 @@ public:
                 out[i] = std::conj (out[size - i]);
     }
 
-    void performRealOnlyInverseTransform (float* inoutData) const noexcept override
+    void performRealOnlyInverseTransformWithScratch (float* inoutData, float* scratch) const noexcept override
     {
-        ippsFFTInv_CCSToR_32f_I (inoutData, real.specPtr, real.workBuf.get());
+        ippsFFTInv_CCSToR_32f_I (inoutData, real.specPtr, getWorkBuffer (scratch));
     }
 
 private:
     static constexpr auto flag = IPP_FFT_DIV_INV_BY_N;
     static constexpr auto hint = ippAlgHintFast;
 
+    // as ippsMalloc aligns its buffers
+    static constexpr int workBufferAlignment = 64;
+
+    static Ipp8u* getWorkBuffer (float* scratch) noexcept
+    {
+        return snapPointerToAlignment (reinterpret_cast<Ipp8u*> (scratch), (size_t) workBufferAlignment);
+    }
+
     struct IppFree
     {
         template <typename Ptr>
@@ -897,18 +1594,20 @@ private:
             if (reinterpret_cast<const Ipp8u*> (specPtr) != specBuf.get())
                 return {};
 
-            return { std::move (specBuf), IppPtr (ippsMalloc_8u (workSize)), specPtr };
+            return { std::move (specBuf), workSize, specPtr };
         }
 
         Context() noexcept = default;
 
-        Context (IppPtr&& spec, IppPtr&& work, typename Traits::Spec* ptr) noexcept
-            : specBuf (std::move (spec)), workBuf (std::move (work)), specPtr (ptr)
+        Context (IppPtr&& spec, int workSizeToUse, typename Traits::Spec* ptr) noexcept
+            : specBuf (std::move (spec)), workSize (workSizeToUse), specPtr (ptr)
         {}
 
         bool isValid() const noexcept { return specPtr != nullptr; }
 
-        IppPtr specBuf, workBuf;
+        // the work buffer is per call, so that one instance can be used on several threads
+        IppPtr specBuf;
+        int workSize = 0;
         SpecPtr specPtr = nullptr;
     };
 
@@ -945,7 +1644,7 @@ FFT::EngineImpl<IntelPerformancePrimitivesFFT> intelPerformancePrimitivesFFT;
 //==============================================================================
 //==============================================================================
 FFT::FFT (int order)
-    : engine (FFT::Engine::createBestEngineForPlatform (order)),
+    : engine (FFT::Engine::getSharedInstance (order)),
       size (1 << order)
 {
 }
@@ -971,11 +1670,75 @@ void FFT::performRealOnlyInverseTransform (float* inputOutputData) const noexcep
 }
 
 void FFT::performFrequencyOnlyForwardTransform (float* inputOutputData) const noexcept
+{
+    performFrequencyOnlyForwardTransform (inputOutputData, nullptr);
+}
+
+//==============================================================================
+int FFT::getScratchSize() const noexcept
+{
+    return engine != nullptr ? engine->getScratchSize() : 0;
+}
+
+void FFT::perform (const Complex<float>* input, Complex<float>* output, bool inverse, float* scratch) const noexcept
+{
+    if (scratch == nullptr)
+        perform (input, output, inverse);
+    else if (engine != nullptr)
+        engine->performWithScratch (input, output, inverse, scratch);
+}
+
+void FFT::performRealOnlyForwardTransform (float* inputOutputData, bool ignoreNeagtiveFreqs, float* scratch) const noexcept
+{
+    if (scratch == nullptr)
+        performRealOnlyForwardTransform (inputOutputData, ignoreNeagtiveFreqs);
+    else if (engine != nullptr)
+        engine->performRealOnlyForwardTransformWithScratch (inputOutputData, ignoreNeagtiveFreqs, scratch);
+}
+
+void FFT::performRealOnlyInverseTransform (float* inputOutputData, float* scratch) const noexcept
+{
+    if (scratch == nullptr)
+        performRealOnlyInverseTransform (inputOutputData);
+    else if (engine != nullptr)
+        engine->performRealOnlyInverseTransformWithScratch (inputOutputData, scratch);
+}
+
+int FFT::getBatchScratchSize() const noexcept
+{
+    return engine != nullptr ? engine->getBatchScratchSize() : 0;
+}
+
+void FFT::performBatch (const Complex<float>* const* inputs, Complex<float>* const* outputs,
+                        int numTransforms, bool inverse, float* scratch) const noexcept
+{
+    if (engine == nullptr || numTransforms <= 0)
+        return;
+
+    if (scratch != nullptr)
+        engine->performBatch (inputs, outputs, numTransforms, inverse, scratch);
+    else
+        Instance::withScratch (engine->getBatchScratchSize(), [&] (float* s) { engine->performBatch (inputs, outputs, numTransforms, inverse, s); });
+}
+
+void FFT::performRealOnlyForwardTransformBatch (float* const* inputOutputData, int numTransforms,
+                                                bool ignoreNeagtiveFreqs, float* scratch) const noexcept
+{
+    if (engine == nullptr || numTransforms <= 0)
+        return;
+
+    if (scratch != nullptr)
+        engine->performRealOnlyForwardTransformBatch (inputOutputData, numTransforms, ignoreNeagtiveFreqs, scratch);
+    else
+        Instance::withScratch (engine->getBatchScratchSize(), [&] (float* s) { engine->performRealOnlyForwardTransformBatch (inputOutputData, numTransforms, ignoreNeagtiveFreqs, s); });
+}
+
+void FFT::performFrequencyOnlyForwardTransform (float* inputOutputData, float* scratch) const noexcept
 {
     if (size == 1)
         return;
 
-    performRealOnlyForwardTransform (inputOutputData);
+    performRealOnlyForwardTransform (inputOutputData, false, scratch);
     auto* out = reinterpret_cast<Complex<float>*> (inputOutputData);
 
     for (int i = 0; i < size; ++i)
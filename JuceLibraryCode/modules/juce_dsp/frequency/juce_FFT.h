@@ -35,9 +35,9 @@ namespace dsp
     be useful for simple applications where one of the more complex FFT libraries would be
     overkill. (But in the future it may end up becoming optimised of course...)
 
-    The FFT class itself contains lookup tables, so there's some overhead in creating
-    one, you should create and cache an FFT object for each size/direction of transform
-    that you need, and re-use them to perform the actual operation.
+    The lookup tables of each size are shared by all the FFT objects of that size in the
+    process, and are only computed when the first of them is created. An FFT object is
+    never modified by a transform, so one can be used from several threads at once.
 
     @tags{DSP}
 */
@@ -96,6 +96,79 @@ public:
     */
     void performFrequencyOnlyForwardTransform (float* inputOutputData) const noexcept;
 
+    //==============================================================================
+    /** Returns the number of floats of scratch space that the overloads below need.
+
+        Some engines need working space for a transform, and allocate it on each
+        call, on the stack or for large sizes on the heap. The overloads that take
+        a scratch array use that instead. This may return 0, if the engine in use
+        doesn't need any.
+    */
+    int getScratchSize() const noexcept;
+
+    /** Performs an out-of-place FFT, like perform(), in the scratch space given.
+
+        The scratch array must hold at least getScratchSize() floats, and must not be
+        used by another call at the same time, so each thread calling the FFT needs its
+        own. If it is nullptr, the engine allocates its own as perform() does.
+    */
+    void perform (const Complex<float>* input, Complex<float>* output, bool inverse, float* scratch) const noexcept;
+
+    /** Performs an in-place forward transform on a block of real data, like
+        performRealOnlyForwardTransform(), in the scratch space given.
+        @see getScratchSize
+    */
+    void performRealOnlyForwardTransform (float* inputOutputData,
+                                          bool dontCalculateNegativeFrequencies,
+                                          float* scratch) const noexcept;
+
+    /** Performs a reverse operation to data created in performRealOnlyForwardTransform(),
+        in the scratch space given.
+        @see getScratchSize
+    */
+    void performRealOnlyInverseTransform (float* inputOutputData, float* scratch) const noexcept;
+
+    /** Transforms an array to the magnitude frequency response spectrum, like
+        performFrequencyOnlyForwardTransform(), in the scratch space given.
+        @see getScratchSize
+    */
+    void performFrequencyOnlyForwardTransform (float* inputOutputData, float* scratch) const noexcept;
+
+    //==============================================================================
+    /** Performs the same out-of-place FFT on several signals.
+
+        This does the same as calling perform() for each of them, but some engines are
+        faster at it, as they can transform several signals side by side: for example,
+        the left, right, mid and side channels of a block, in one call.
+
+        @param inputs           numTransforms arrays, each of getSize() elements
+        @param outputs          numTransforms arrays, each of getSize() elements
+        @param numTransforms    the number of signals to transform
+        @param inverse          whether to perform the inverse transforms
+        @param scratch          getBatchScratchSize() floats of working space, or nullptr
+                                for the engine to allocate its own
+    */
+    void performBatch (const Complex<float>* const* inputs, Complex<float>* const* outputs,
+                       int numTransforms, bool inverse, float* scratch = nullptr) const noexcept;
+
+    /** Performs an in-place forward transform on several blocks of real data, like
+        calling performRealOnlyForwardTransform() for each of them.
+
+        Each array must hold 2 * getSize() floats. The scratch array must hold
+        getBatchScratchSize() floats, or be nullptr for the engine to allocate its own.
+
+        @see performBatch
+    */
+    void performRealOnlyForwardTransformBatch (float* const* inputOutputData, int numTransforms,
+                                               bool dontCalculateNegativeFrequencies = false,
+                                               float* scratch = nullptr) const noexcept;
+
+    /** Returns the number of floats of scratch space that the batch transforms need.
+        This is at least getScratchSize().
+    */
+    int getBatchScratchSize() const noexcept;
+
+    //==============================================================================
     /** Returns the number of data points that this FFT was created to work with. */
     int getSize() const noexcept            { return size; }
 
@@ -110,7 +183,7 @@ private:
     //==============================================================================
     struct Engine;
 
-    std::unique_ptr<Instance> engine;
+    std::shared_ptr<const Instance> engine;
     int size;
 
     //==============================================================================
@@ -192,6 +192,264 @@ struct FFTUnitTest  : public UnitTest
         }
     };
 
+    struct LargeOrderTest
+    {
+        // an O(n log n) reference in double precision, as the DFT above is too slow here
+        static void performReferenceFFT (std::vector<std::complex<double>>& data, bool reverse)
+        {
+            const auto n = data.size();
+
+            for (size_t i = 1, j = 0; i < n; ++i)
+            {
+                auto bit = n >> 1;
+
+                for (; (j & bit) != 0; bit >>= 1)
+                    j ^= bit;
+
+                j ^= bit;
+
+                if (i < j)
+                    std::swap (data[i], data[j]);
+            }
+
+            for (size_t length = 2; length <= n; length <<= 1)
+            {
+                const auto angle = (reverse ? 1.0 : -1.0) * MathConstants<double>::twoPi / static_cast<double> (length);
+
+                for (size_t i = 0; i < n; i += length)
+                {
+                    for (size_t k = 0; k < length / 2; ++k)
+                    {
+                        const auto w = std::polar (1.0, angle * static_cast<double> (k));
+                        const auto a = data[i + k], b = data[i + k + length / 2] * w;
+                        data[i + k] = a + b;
+                        data[i + k + length / 2] = a - b;
+                    }
+                }
+            }
+        }
+
+        // the error grows with the size and the magnitude of the spectrum
+        template <typename Type>
+        static bool checkArrayIsClose (const Type* a, const std::vector<std::complex<double>>& b, size_t n, double scale)
+        {
+            for (size_t i = 0; i < n; ++i)
+                if (std::abs (std::complex<double> (a[i]) - b[i]) > 1.0e-5 * scale)
+                    return false;
+
+            return true;
+        }
+
+        static void run (FFTUnitTest& u)
+        {
+            Random random (378272);
+
+            for (int order = 6; order <= 15; ++order)
+            {
+                const auto n = (size_t) 1 << order;
+                const auto scale = std::sqrt ((double) n) * order;
+
+                FFT fft (order);
+
+                HeapBlock<Complex<float>> input (n), output (n), buffer (n);
+                fillRandom (random, input.getData(), n);
+
+                std::vector<std::complex<double>> reference (input.getData(), input.getData() + n);
+                performReferenceFFT (reference, false);
+
+                fft.perform (input.getData(), output.getData(), false);
+                u.expect (checkArrayIsClose (output.getData(), reference, n, scale));
+
+                fft.perform (output.getData(), buffer.getData(), true);
+                u.expect (checkArrayIsSimilar (buffer.getData(), input.getData(), n));
+
+                // real input, in place
+                HeapBlock<float> real (2 * n, true);
+                fillRandom (random, real.getData(), n);
+
+                std::vector<std::complex<double>> realReference (real.getData(), real.getData() + n);
+                performReferenceFFT (realReference, false);
+
+                HeapBlock<float> inout (2 * n);
+                memcpy (inout.getData(), real.getData(), 2 * n * sizeof (float));
+                fft.performRealOnlyForwardTransform (inout.getData(), true);
+                u.expect (checkArrayIsClose (reinterpret_cast<Complex<float>*> (inout.getData()), realReference, n / 2 + 1, scale));
+
+                fft.performRealOnlyInverseTransform (inout.getData());
+                u.expect (checkArrayIsSimilar (inout.getData(), real.getData(), n));
+
+                // the same, with the caller's scratch space
+                HeapBlock<float> scratch ((size_t) fft.getScratchSize() + 1);
+
+                fft.perform (input.getData(), output.getData(), false, scratch.getData());
+                u.expect (checkArrayIsClose (output.getData(), reference, n, scale));
+
+                fft.perform (output.getData(), buffer.getData(), true, scratch.getData());
+                u.expect (checkArrayIsSimilar (buffer.getData(), input.getData(), n));
+
+                memcpy (inout.getData(), real.getData(), 2 * n * sizeof (float));
+                fft.performRealOnlyForwardTransform (inout.getData(), false, scratch.getData());
+                u.expect (checkArrayIsClose (reinterpret_cast<Complex<float>*> (inout.getData()), realReference, n, scale));
+
+                fft.performRealOnlyInverseTransform (inout.getData(), scratch.getData());
+                u.expect (checkArrayIsSimilar (inout.getData(), real.getData(), n));
+            }
+        }
+    };
+
+    struct BatchTest
+    {
+        static void run (FFTUnitTest& u)
+        {
+            Random random (378272);
+
+            for (int order = 4; order <= 12; ++order)
+            {
+                const auto n = (size_t) 1 << order;
+                FFT fft (order);
+
+                // enough to fill several registers, and leave some lanes empty
+                for (int numTransforms : { 1, 2, 3, 5, 8, 9, 17 })
+                {
+                    std::vector<std::vector<Complex<float>>> inputs, outputs;
+                    std::vector<std::vector<float>> real;
+
+                    for (int i = 0; i < numTransforms; ++i)
+                    {
+                        inputs.emplace_back (n);
+                        outputs.emplace_back (n);
+                        real.emplace_back (2 * n, 0.0f);
+
+                        fillRandom (random, inputs.back().data(), n);
+                        fillRandom (random, real.back().data(), n);
+                    }
+
+                    std::vector<const Complex<float>*> inputPointers;
+                    std::vector<Complex<float>*> outputPointers;
+
+                    for (int i = 0; i < numTransforms; ++i)
+                    {
+                        inputPointers.push_back (inputs[(size_t) i].data());
+                        outputPointers.push_back (outputs[(size_t) i].data());
+                    }
+
+                    HeapBlock<Complex<float>> expected (n);
+
+                    for (auto inverse : { false, true })
+                    {
+                        fft.performBatch (inputPointers.data(), outputPointers.data(), numTransforms, inverse);
+
+                        for (int i = 0; i < numTransforms; ++i)
+                        {
+                            fft.perform (inputPointers[(size_t) i], expected.getData(), inverse);
+                            u.expect (checkArrayIsSimilar (outputPointers[(size_t) i], expected.getData(), n));
+                        }
+                    }
+
+                    HeapBlock<float> expectedReal (2 * n), scratch ((size_t) fft.getBatchScratchSize());
+
+                    for (auto ignoreNegativeFreqs : { false, true })
+                    {
+                        auto copies = real;
+                        std::vector<float*> copyPointers;
+
+                        for (auto& copy : copies)
+                            copyPointers.push_back (copy.data());
+
+                        fft.performRealOnlyForwardTransformBatch (copyPointers.data(), numTransforms,
+                                                                  ignoreNegativeFreqs, scratch.getData());
+
+                        for (int i = 0; i < numTransforms; ++i)
+                        {
+                            memcpy (expectedReal.getData(), real[(size_t) i].data(), 2 * n * sizeof (float));
+                            fft.performRealOnlyForwardTransform (expectedReal.getData(), ignoreNegativeFreqs);
+
+                            const auto numValues = ignoreNegativeFreqs ? n + 2 : 2 * n;
+                            u.expect (checkArrayIsSimilar (copyPointers[(size_t) i], expectedReal.getData(), numValues));
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    struct ConcurrentTest
+    {
+        // transforms the same input over and over, with or without its own scratch space
+        struct Worker  : public Thread
+        {
+            Worker (const FFT& fftToUse, const HeapBlock<float>& inputToUse, const HeapBlock<float>& expectedToUse, bool useScratchToUse)
+                : Thread ("FFT test"), fft (fftToUse), input (inputToUse), expected (expectedToUse), useScratch (useScratchToUse)
+            {}
+
+            void run() override
+            {
+                const auto n = (size_t) fft.getSize();
+                HeapBlock<float> data (2 * n), scratch ((size_t) fft.getScratchSize() + 1);
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    memcpy (data.getData(), input.getData(), 2 * n * sizeof (float));
+                    fft.performRealOnlyForwardTransform (data.getData(), true, useScratch ? scratch.getData() : nullptr);
+
+                    if (! checkArrayIsSimilar (data.getData(), expected.getData(), n + 2))
+                        ++numMismatches;
+                }
+            }
+
+            const FFT& fft;
+            const HeapBlock<float>& input;
+            const HeapBlock<float>& expected;
+            const bool useScratch;
+            int numMismatches = 0;
+        };
+
+        static void run (FFTUnitTest& u)
+        {
+            Random random (378272);
+            const int order = 11;
+            const auto n = (size_t) 1 << order;
+
+            // a second FFT of the same order shares the first one's tables
+            FFT fft (order), other (order);
+
+            HeapBlock<float> input (2 * n, true), expected (2 * n);
+            fillRandom (random, input.getData(), n);
+
+            // the expected bins come from a direct DFT in double precision, so
+            // they share nothing with the tables under test
+            HeapBlock<std::complex<double>> twiddles (n);
+
+            for (size_t i = 0; i < n; ++i)
+                twiddles[i] = std::polar (1.0, -MathConstants<double>::twoPi * (double) i / (double) n);
+
+            for (size_t k = 0; k <= n / 2; ++k)
+            {
+                std::complex<double> sum;
+
+                for (size_t i = 0; i < n; ++i)
+                    sum += (double) input[i] * twiddles[(i * k) % n];
+
+                expected[2 * k]     = (float) sum.real();
+                expected[2 * k + 1] = (float) sum.imag();
+            }
+
+            OwnedArray<Worker> workers;
+
+            for (int i = 0; i < 4; ++i)
+                workers.add (new Worker (i < 2 ? fft : other, input, expected, i % 2 == 0));
+
+            for (auto* worker : workers)
+                worker->startThread();
+
+            for (auto* worker : workers)
+            {
+                worker->waitForThreadToExit (-1);
+                u.expectEquals (worker->numMismatches, 0);
+            }
+        }
+    };
+
     template <class TheTest>
     void runTestForAllTypes (const char* unitTestName)
     {
@@ -205,6 +463,9 @@ struct FFTUnitTest  : public UnitTest
         runTestForAllTypes<RealTest> ("Real input numbers Test");
         runTestForAllTypes<FrequencyOnlyTest> ("Frequency only Test");
         runTestForAllTypes<ComplexTest> ("Complex input numbers Test");
+        runTestForAllTypes<LargeOrderTest> ("Large orders Test");
+        runTestForAllTypes<BatchTest> ("Batch Test");
+        runTestForAllTypes<ConcurrentTest> ("Concurrent use Test");
     }
 };
 
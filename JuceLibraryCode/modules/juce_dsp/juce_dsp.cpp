@@ -64,6 +64,7 @@
 #include "processors/juce_DelayLine.cpp"
 #include "processors/juce_DryWetMixer.cpp"
 #include "processors/juce_StateVariableTPTFilter.cpp"
+#include "processors/juce_BiquadCascade.cpp"
 #include "maths/juce_SpecialFunctions.cpp"
 #include "maths/juce_Matrix.cpp"
 #include "maths/juce_LookupTable.cpp"
@@ -106,4 +107,5 @@
  #include "frequency/juce_FFT_test.cpp"
  #include "processors/juce_FIRFilter_test.cpp"
  #include "processors/juce_ProcessorChain_test.cpp"
+ #include "processors/juce_BiquadCascade_test.cpp"
 #endif
@@ -259,6 +259,7 @@ namespace juce
 #include "processors/juce_LinkwitzRileyFilter.h"
 #include "processors/juce_DryWetMixer.h"
 #include "processors/juce_StateVariableTPTFilter.h"
+#include "processors/juce_BiquadCascade.h"
 #include "frequency/juce_FFT.h"
 #include "frequency/juce_Convolution.h"
 #include "frequency/juce_Windowing.h"
@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+namespace BiquadCascadeHelpers
+{
+    /** A biquad of a register of lanes, in transposed direct form II. */
+    template <typename Vector>
+    struct Biquad
+    {
+        Vector process (Vector x) noexcept
+        {
+            const auto y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            return y;
+        }
+
+        Vector b0, b1, b2, a1, a2, s1, s2;
+    };
+
+    /** Biquads in series, as members rather than an array so that the
+        compiler keeps every one of them in registers.
+    */
+    template <typename Vector, int numBiquads>
+    struct Chain
+    {
+        Vector process (Vector x) noexcept                      { return rest.process (first.process (x)); }
+
+        template <typename Function>
+        void forEach (Function&& function) noexcept             { function (first); rest.forEach (function); }
+
+        template <typename Function>
+        void forEach (Function&& function) const noexcept       { function (first); rest.forEach (function); }
+
+        Biquad<Vector> first;
+        Chain<Vector, numBiquads - 1> rest;
+    };
+
+    template <typename Vector>
+    struct Chain<Vector, 0>
+    {
+        Vector process (Vector x) noexcept                      { return x; }
+
+        template <typename Function>
+        void forEach (Function&&) const noexcept                {}
+    };
+}
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::prepare (int newNumLanes, int newNumStages)
+{
+    jassert (newNumLanes >= 0 && newNumStages >= 0);
+
+    numLanes = newNumLanes;
+    numStages = newNumStages;
+    numPaddedLanes = (numLanes + vectorSize - 1) / vectorSize * vectorSize;
+
+    const auto numStageValues = (size_t) (numStages * numTerms * numPaddedLanes);
+    const auto numChunkValues = (size_t) (framesPerChunk * numPaddedLanes);
+
+    storage.calloc (numStageValues + numChunkValues + (size_t) vectorSize);
+    stages = snapPointerToAlignment (storage.get(), sizeof (Vector));
+    chunk = stages + numStageValues;
+
+    for (int stage = 0; stage < numStages; ++stage)
+        std::fill (getTerm (stage, 0), getTerm (stage, 1), (SampleType) 1);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setCoefficients (int lane, int stage, const IIR::Coefficients<SampleType>& coefficients) noexcept
+{
+    auto* c = coefficients.getRawCoefficients();
+
+    if (coefficients.getFilterOrder() == 1)
+    {
+        setCoefficients (lane, stage, c[0], c[1], 0, c[2], 0);
+    }
+    else
+    {
+        jassert (coefficients.getFilterOrder() == 2);
+        setCoefficients (lane, stage, c[0], c[1], c[2], c[3], c[4]);
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setCoefficients (int lane, int stage, SampleType b0, SampleType b1, SampleType b2,
+                                                 SampleType a1, SampleType a2) noexcept
+{
+    jassert (isPositiveAndBelow (lane, numLanes) && isPositiveAndBelow (stage, numStages));
+
+    getTerm (stage, 0)[lane] = b0;
+    getTerm (stage, 1)[lane] = b1;
+    getTerm (stage, 2)[lane] = b2;
+    getTerm (stage, 3)[lane] = a1;
+    getTerm (stage, 4)[lane] = a2;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::reset() noexcept
+{
+    for (int stage = 0; stage < numStages; ++stage)
+        std::fill (getTerm (stage, 5), getTerm (stage, 7), SampleType());
+}
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::processBank (const SampleType* input, SampleType* const* outputs, int numSamples) noexcept
+{
+    for (int start = 0; start < numSamples; start += framesPerChunk)
+    {
+        const auto numFrames = jmin (framesPerChunk, numSamples - start);
+
+        for (int i = 0; i < numFrames; ++i)
+            std::fill (chunk + i * numPaddedLanes, chunk + (i + 1) * numPaddedLanes, input[start + i]);
+
+        processFrames (chunk, numFrames);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            if (auto* output = outputs[lane])
+                for (int i = 0; i < numFrames; ++i)
+                    output[start + i] = chunk[i * numPaddedLanes + lane];
+        }
+    }
+
+    snapToZero();
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::processFrames (SampleType* frames, int numFrames) noexcept
+{
+   #if JUCE_USE_SIMD
+    jassert (Vector::isSIMDAligned (frames));
+   #endif
+
+    ScopedNoDenormals noDenormals;
+
+    for (int lane = 0; lane < numPaddedLanes; lane += vectorSize)
+    {
+        for (int stage = 0; stage < numStages; stage += maxStagesPerPass)
+        {
+            switch (jmin (maxStagesPerPass, numStages - stage))
+            {
+                case 1:  processStages<1> (frames, numFrames, lane, stage); break;
+                case 2:  processStages<2> (frames, numFrames, lane, stage); break;
+                case 3:  processStages<3> (frames, numFrames, lane, stage); break;
+                default: processStages<4> (frames, numFrames, lane, stage); break;
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+template <int numStagesInPass>
+void BiquadCascade<SampleType>::processStages (SampleType* frames, int numFrames, int lane, int firstStage) noexcept
+{
+    // A stage's output for one frame depends on its state from the frame
+    // before, so a stage on its own waits on that chain. Running a few stages
+    // over each frame in turn lets the processor overlap their chains.
+    BiquadCascadeHelpers::Chain<Vector, numStagesInPass> chain;
+    loadChain (chain, lane, firstStage);
+
+    auto* frame = frames + lane;
+    const auto stride = numPaddedLanes;
+
+    for (int i = 0; i < numFrames; ++i, frame += stride)
+        store (frame, chain.process (load (frame)));
+
+    storeChain (chain, lane, firstStage);
+}
+
+template <typename SampleType>
+template <typename Chain>
+void BiquadCascade<SampleType>::loadChain (Chain& chain, int lane, int firstStage) const noexcept
+{
+    chain.forEach ([this, lane, &firstStage] (BiquadCascadeHelpers::Biquad<Vector>& biquad)
+    {
+        biquad.b0 = load (getTerm (firstStage, 0) + lane);
+        biquad.b1 = load (getTerm (firstStage, 1) + lane);
+        biquad.b2 = load (getTerm (firstStage, 2) + lane);
+        biquad.a1 = load (getTerm (firstStage, 3) + lane);
+        biquad.a2 = load (getTerm (firstStage, 4) + lane);
+        biquad.s1 = load (getTerm (firstStage, 5) + lane);
+        biquad.s2 = load (getTerm (firstStage, 6) + lane);
+        ++firstStage;
+    });
+}
+
+template <typename SampleType>
+template <typename Chain>
+void BiquadCascade<SampleType>::storeChain (const Chain& chain, int lane, int firstStage) noexcept
+{
+    chain.forEach ([this, lane, &firstStage] (const BiquadCascadeHelpers::Biquad<Vector>& biquad)
+    {
+        store (getTerm (firstStage, 5) + lane, biquad.s1);
+        store (getTerm (firstStage, 6) + lane, biquad.s2);
+        ++firstStage;
+    });
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::snapToZero() noexcept
+{
+    for (int stage = 0; stage < numStages; ++stage)
+        for (auto* s = getTerm (stage, 5); s != getTerm (stage, 7); ++s)
+            util::snapToZero (*s);
+}
+
+//==============================================================================
+template class BiquadCascade<float>;
+template class BiquadCascade<double>;
+
+} // namespace dsp
+} // namespace juce
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+/**
+    Runs many independent cascades of biquad filters side by side, one in each
+    lane of a SIMDRegister.
+
+    A lane can be a channel, as in process(), or a band of a filter bank that
+    filters the same signal, as in processBank(). Every lane has the same number
+    of stages, each with its own coefficients; a stage whose coefficients have
+    not been set passes its input through.
+
+    The coefficients and state are stored as one array per term, padded to a
+    whole number of registers, and the samples as frames of getNumPaddedLanes()
+    values. A register of lanes at a time, the stages run over a whole chunk of
+    frames with their state held in registers, in transposed direct form II, so
+    a cascade of N lanes costs about what N / SIMDRegister<SampleType>::size()
+    IIR::Filters would, or less.
+
+    Denormals are disabled while processing, and the state is snapped to zero
+    after each block.
+
+    @see IIR::Filter, ProcessorDuplicator
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class BiquadCascade
+{
+public:
+    //==============================================================================
+    /** Creates a cascade with no lanes. Call prepare() before processing. */
+    BiquadCascade() = default;
+
+    //==============================================================================
+    /** Allocates the lanes and stages, sets every stage to pass its input
+        through, and clears the state.
+    */
+    void prepare (int numLanes, int numStages);
+
+    /** Sets the coefficients of one stage of a lane. First order coefficients
+        are used as a biquad with b2 and a2 at zero.
+    */
+    void setCoefficients (int lane, int stage, const IIR::Coefficients<SampleType>& coefficients) noexcept;
+
+    /** Sets the coefficients of one stage of a lane, normalised so that a0 is 1. */
+    void setCoefficients (int lane, int stage, SampleType b0, SampleType b1, SampleType b2,
+                          SampleType a1, SampleType a2) noexcept;
+
+    /** Resets the internal state variables of every lane. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Returns the number of lanes. */
+    int getNumLanes() const noexcept            { return numLanes; }
+
+    /** Returns the number of stages in each lane. */
+    int getNumStages() const noexcept           { return numStages; }
+
+    /** Returns the number of values in a frame: the number of lanes, rounded
+        up to a whole number of registers.
+    */
+    int getNumPaddedLanes() const noexcept      { return numPaddedLanes; }
+
+    //==============================================================================
+    /** Filters each channel supplied in the processing context through the lane
+        with the same index. There must be no more channels than lanes.
+    */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = (int) outputBlock.getNumChannels();
+        const auto numSamples  = (int) outputBlock.getNumSamples();
+
+        jassert (numChannels <= numLanes);
+        jassert ((int) inputBlock.getNumChannels() == numChannels);
+        jassert ((int) inputBlock.getNumSamples()  == numSamples);
+
+        if (context.isBypassed)
+        {
+            outputBlock.copyFrom (inputBlock);
+            return;
+        }
+
+        for (int start = 0; start < numSamples; start += framesPerChunk)
+        {
+            const auto numFrames = jmin (framesPerChunk, numSamples - start);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* input = inputBlock.getChannelPointer ((size_t) channel) + start;
+
+                for (int i = 0; i < numFrames; ++i)
+                    chunk[i * numPaddedLanes + channel] = input[i];
+            }
+
+            // Lanes without a channel filter silence
+            if (numChannels < numLanes)
+                for (int i = 0; i < numFrames; ++i)
+                    std::fill (chunk + i * numPaddedLanes + numChannels, chunk + i * numPaddedLanes + numLanes, SampleType());
+
+            processFrames (chunk, numFrames);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* output = outputBlock.getChannelPointer ((size_t) channel) + start;
+
+                for (int i = 0; i < numFrames; ++i)
+                    output[i] = chunk[i * numPaddedLanes + channel];
+            }
+        }
+
+        snapToZero();
+    }
+
+    /** Filters the same input through every lane, writing the output of lane n
+        to outputs[n]. Lanes whose output is nullptr are filtered but not written.
+    */
+    void processBank (const SampleType* input, SampleType* const* outputs, int numSamples) noexcept;
+
+    /** Filters frames in place: sample n of each frame goes through lane n.
+
+        The frames are numFrames runs of getNumPaddedLanes() samples, and must
+        be aligned as a SIMDRegister would be.
+    */
+    void processFrames (SampleType* frames, int numFrames) noexcept;
+
+    /** Ensure that the state variables are rounded to zero if the state
+        variables are denormals. This is only needed if you are calling
+        processFrames() yourself.
+    */
+    void snapToZero() noexcept;
+
+    /** The number of frames that process() and processBank() filter at once. */
+    static constexpr int framesPerChunk = 64;
+
+private:
+    //==============================================================================
+   #if JUCE_USE_SIMD
+    using Vector = SIMDRegister<SampleType>;
+   #else
+    using Vector = SampleType;
+   #endif
+
+    static constexpr int vectorSize = (int) (sizeof (Vector) / sizeof (SampleType));
+
+   #if JUCE_USE_SIMD
+    static Vector load (const SampleType* source) noexcept          { return Vector::fromRawArray (source); }
+    static void store (SampleType* dest, Vector value) noexcept     { value.copyToRawArray (dest); }
+   #else
+    static Vector load (const SampleType* source) noexcept          { return *source; }
+    static void store (SampleType* dest, Vector value) noexcept     { *dest = value; }
+   #endif
+
+    // b0, b1, b2, a1, a2, s1, s2
+    static constexpr int numTerms = 7;
+
+    // Stages run over the frames together, in passes of up to this many
+    static constexpr int maxStagesPerPass = 4;
+
+    template <int numStagesInPass>
+    void processStages (SampleType* frames, int numFrames, int lane, int firstStage) noexcept;
+
+    template <typename Chain>
+    void loadChain (Chain& chain, int lane, int firstStage) const noexcept;
+
+    template <typename Chain>
+    void storeChain (const Chain& chain, int lane, int firstStage) noexcept;
+
+    SampleType* getTerm (int stage, int term) const noexcept    { return stages + (stage * numTerms + term) * numPaddedLanes; }
+
+    //==============================================================================
+    HeapBlock<SampleType> storage;
+    SampleType* stages = nullptr;
+    SampleType* chunk = nullptr;
+
+    int numLanes = 0, numStages = 0, numPaddedLanes = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BiquadCascade)
+};
+
+} // namespace dsp
+} // namespace juce
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+class BiquadCascadeTest : public UnitTest
+{
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numStages = 3;
+
+    //==============================================================================
+    // Each lane gets a random design per stage, the last stage of odd lanes
+    // being first order
+    template <typename SampleType>
+    static typename IIR::Coefficients<SampleType>::Ptr makeCoefficients (Random& random, int lane, int stage)
+    {
+        const auto frequency = (SampleType) (40.0 * std::pow (400.0, random.nextDouble()));
+        const auto q = (SampleType) (0.5 + random.nextDouble());
+        const auto gain = (SampleType) Decibels::decibelsToGain (24.0 * random.nextDouble() - 12.0);
+
+        if (stage == numStages - 1 && lane % 2 == 1)
+            return IIR::Coefficients<SampleType>::makeFirstOrderLowPass (sampleRate, frequency);
+
+        switch (random.nextInt (4))
+        {
+            case 0:  return IIR::Coefficients<SampleType>::makeLowPass (sampleRate, frequency, q);
+            case 1:  return IIR::Coefficients<SampleType>::makeHighPass (sampleRate, frequency, q);
+            case 2:  return IIR::Coefficients<SampleType>::makeHighShelf (sampleRate, frequency, q, gain);
+            default: return IIR::Coefficients<SampleType>::makePeakFilter (sampleRate, frequency, q, gain);
+        }
+    }
+
+    template <typename SampleType>
+    struct Reference
+    {
+        Reference (Random& random, BiquadCascade<SampleType>& cascade, int numLanes)
+        {
+            cascade.prepare (numLanes, numStages);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    auto coefficients = makeCoefficients<SampleType> (random, lane, stage);
+                    cascade.setCoefficients (lane, stage, *coefficients);
+                    filters.emplace_back (coefficients);
+                }
+            }
+        }
+
+        SampleType processSample (int lane, SampleType x) noexcept
+        {
+            for (int stage = 0; stage < numStages; ++stage)
+                x = filters[(size_t) (lane * numStages + stage)].processSample (x);
+
+            return x;
+        }
+
+        // As the cascade does after each block
+        void snapToZero() noexcept
+        {
+            for (auto& filter : filters)
+                filter.snapToZero();
+        }
+
+        std::vector<IIR::Filter<SampleType>> filters;
+    };
+
+    // Both sides round the same sums in the same order; the tolerance only
+    // allows for a compiler fusing multiplies and adds on one side
+    template <typename SampleType>
+    static SampleType getTolerance()    { return std::is_same<SampleType, float>::value ? (SampleType) 1.0e-5 : (SampleType) 1.0e-7; }
+
+    //==============================================================================
+    template <typename SampleType>
+    void runChannelTest (Random& random, int numLanes, int numChannels)
+    {
+        BiquadCascade<SampleType> cascade;
+        Reference<SampleType> reference (random, cascade, numLanes);
+
+        // Block sizes that do and don't fill whole chunks
+        const int blockSizes[] = { 1, 64, 100, 37, 256 };
+        HeapBlock<char> data;
+
+        for (auto blockSize : blockSizes)
+        {
+            AudioBlock<SampleType> block (data, (size_t) numChannels, (size_t) blockSize);
+            std::vector<SampleType> expected ((size_t) (numChannels * blockSize));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const auto x = (SampleType) (2.0 * random.nextDouble() - 1.0);
+                    block.setSample (channel, i, x);
+                    expected[(size_t) (channel * blockSize + i)] = reference.processSample (channel, x);
+                }
+            }
+
+            cascade.process (ProcessContextReplacing<SampleType> (block));
+            reference.snapToZero();
+
+            SampleType maxError = 0;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    maxError = jmax (maxError, std::abs (block.getSample (channel, i) - expected[(size_t) (channel * blockSize + i)]));
+
+            expectLessThan (maxError, getTolerance<SampleType>());
+        }
+    }
+
+    template <typename SampleType>
+    void runBankTest (Random& random, int numLanes)
+    {
+        BiquadCascade<SampleType> cascade;
+        Reference<SampleType> reference (random, cascade, numLanes);
+
+        const int numSamples = 300;
+        std::vector<SampleType> input ((size_t) numSamples);
+
+        for (auto& x : input)
+            x = (SampleType) (2.0 * random.nextDouble() - 1.0);
+
+        // The last lane's output is not wanted
+        std::vector<std::vector<SampleType>> outputs ((size_t) numLanes, std::vector<SampleType> ((size_t) numSamples));
+        std::vector<SampleType*> outputPointers;
+
+        for (auto& output : outputs)
+            outputPointers.push_back (output.data());
+
+        outputPointers.back() = nullptr;
+        cascade.processBank (input.data(), outputPointers.data(), numSamples);
+
+        SampleType maxError = 0;
+
+        for (int lane = 0; lane < numLanes - 1; ++lane)
+            for (int i = 0; i < numSamples; ++i)
+                maxError = jmax (maxError, std::abs (outputs[(size_t) lane][(size_t) i] - reference.processSample (lane, input[(size_t) i])));
+
+        expectLessThan (maxError, getTolerance<SampleType>());
+    }
+
+    template <typename SampleType>
+    void runTestsForType()
+    {
+        auto random = getRandom();
+
+        beginTest ("Channels match IIR::Filter");
+        runChannelTest<SampleType> (random, 1, 1);
+        runChannelTest<SampleType> (random, 2, 2);
+        runChannelTest<SampleType> (random, 9, 9);
+        runChannelTest<SampleType> (random, 16, 5);
+
+        beginTest ("Bands match IIR::Filter");
+        runBankTest<SampleType> (random, 2);
+        runBankTest<SampleType> (random, 8);
+        runBankTest<SampleType> (random, 31);
+
+        beginTest ("Unset stages pass their input through");
+        {
+            BiquadCascade<SampleType> cascade;
+            cascade.prepare (3, 2);
+
+            std::vector<SampleType> input { 1, -0.5, 0.25, 0 }, output (input.size());
+            SampleType* outputs[] = { output.data(), nullptr, nullptr };
+            cascade.processBank (input.data(), outputs, (int) input.size());
+
+            expect (input == output);
+        }
+    }
+
+public:
+    BiquadCascadeTest()
+        : UnitTest ("Biquad Cascade", UnitTestCategories::dsp)
+    {}
+
+    void runTest() override
+    {
+        runTestsForType<float>();
+        runTestsForType<double>();
+    }
+};
+
+static BiquadCascadeTest biquadCascadeUnitTest;
+
+} // namespace dsp
+} // namespace juce
@@ -172,6 +172,7 @@ namespace pnglibNamespace
   #define PNG_WRITE_BGR_SUPPORTED
   #define PNG_WRITE_CHECK_FOR_INVALID_INDEX_SUPPORTED
   #define PNG_WRITE_COMPRESSED_TEXT_SUPPORTED
+  #define PNG_WRITE_CUSTOMIZE_COMPRESSION_SUPPORTED
   #define PNG_WRITE_CUSTOMIZE_ZTXT_COMPRESSION_SUPPORTED
   #define PNG_WRITE_FILLER_SUPPORTED
   #define PNG_WRITE_FILTER_SUPPORTED
@@ -504,6 +505,9 @@ namespace PNGHelpers
 PNGImageFormat::PNGImageFormat()    {}
 PNGImageFormat::~PNGImageFormat()   {}
 
+void PNGImageFormat::setCompressionLevel (int newLevel)             { compressionLevel = newLevel; }
+void PNGImageFormat::setUsesRowFilters (bool shouldUseRowFilters)   { usesRowFilters = shouldUseRowFilters; }
+
 String PNGImageFormat::getFormatName()                   { return "PNG"; }
 bool PNGImageFormat::usesFileExtension (const File& f)   { return f.hasFileExtension ("png"); }
 
@@ -552,6 +556,12 @@ bool PNGImageFormat::writeImageToStream (const Image& image, OutputStream& out)
 
     png_set_write_fn (pngWriteStruct, &out, PNGHelpers::writeDataCallback, nullptr);
 
+    if (compressionLevel >= 0)
+        png_set_compression_level (pngWriteStruct, jmin (compressionLevel, 9));
+
+    if (! usesRowFilters)
+        png_set_filter (pngWriteStruct, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+
     png_set_IHDR (pngWriteStruct, pngInfoStruct, (png_uint_32) width, (png_uint_32) height, 8,
                   image.hasAlphaChannel() ? PNG_COLOR_TYPE_RGB_ALPHA
                                           : PNG_COLOR_TYPE_RGB,
@@ -154,12 +154,31 @@ public:
     PNGImageFormat();
     ~PNGImageFormat() override;
 
+    //==============================================================================
+    /** Specifies the zlib compression level to be used when writing a PNG file.
+
+        @param newLevel  a value 0 to 9, where 0 is no compression and 9 is the
+                         smallest file, or any negative value for zlib's default
+    */
+    void setCompressionLevel (int newLevel);
+
+    /** Specifies whether writing a PNG file tries each of the row filters on every
+        row and keeps the one that compresses best, which is the default. Without
+        them the rows are stored unfiltered, which is much quicker to write but
+        makes a larger file.
+    */
+    void setUsesRowFilters (bool shouldUseRowFilters);
+
     //==============================================================================
     String getFormatName() override;
     bool usesFileExtension (const File&) override;
     bool canUnderstand (InputStream&) override;
     Image decodeImage (InputStream&) override;
     bool writeImageToStream (const Image&, OutputStream&) override;
+
+private:
+    int compressionLevel = -1;
+    bool usesRowFilters = true;
 };
 
 
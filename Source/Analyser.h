@@ -11,93 +11,100 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "ConstantQ.h"
+#include "AnalysisGraph.h"
 
 //==============================================================================
-/*
+/** Averages the spectra of the last few frames from an AnalysisGraph and
+    draws them as a path. Register it with the graph's addStage(), and remove
+    it before it is deleted.
+
+    The averaging runs on the graph's thread without a lock; only the finished
+    spectrum is swapped into the copy that createPath() reads.
 */
 template<typename Type>
-class Analyser : public Thread
+class Analyser : public AnalysisGraph::Stage
 {
 public:
-    Analyser() : Thread ("Frequaliser-Analyser")
-    {
-        averager.clear();
-    }
+    Analyser() = default;
 
     virtual ~Analyser() = default;
 
-    void addAudioData (const AudioBuffer<Type>& buffer, int startChannel, int numChannels)
+    /** Switches between linear FFT bins and constant-Q bins. Can be called
+        from any thread: the kernels are built on the graph's thread with the
+        next frame, once its size and sample rate are known.
+     */
+    void setFrequencyAxis (FrequencyAxis axis, int binsPerOctaveToUse = 24)
     {
-        if (abstractFifo.getFreeSpace() < buffer.getNumSamples())
-            return;
+        jassert (binsPerOctaveToUse > 0);
+        requestedBinsPerOctave = binsPerOctaveToUse;
+        requestedAxis = axis;
+    }
 
-        int start1, block1, start2, block2;
-        abstractFifo.prepareToWrite (buffer.getNumSamples(), start1, block1, start2, block2);
-        audioFifo.copyFrom (0, start1, buffer.getReadPointer (startChannel), block1);
-        if (block2 > 0)
-            audioFifo.copyFrom (0, start2, buffer.getReadPointer (startChannel, block1), block2);
+    FrequencyAxis getFrequencyAxis() const noexcept { return requestedAxis; }
 
-        for (int channel = startChannel + 1; channel < startChannel + numChannels; ++channel)
-        {
-            if (block1 > 0) audioFifo.addFrom (0, start1, buffer.getReadPointer (channel), block1);
-            if (block2 > 0) audioFifo.addFrom (0, start2, buffer.getReadPointer (channel, block1), block2);
-        }
-        abstractFifo.finishedWrite (block1 + block2);
-        waitForData.signal();
+    AnalysisGraph::Request getAnalysisRequest() const override
+    {
+        return { 12, 2048, AnalysisWindow::hann };
     }
 
-    void setupAnalyser (int audioFifoSize, Type sampleRateToUse)
+    void processFrame (const FFTFrame& frame) override
     {
-        sampleRate = sampleRateToUse;
-        audioFifo.setSize (1, audioFifoSize);
-        abstractFifo.setTotalSize (audioFifoSize);
+        const auto axis = requestedAxis.load();
+        const int bins = requestedBinsPerOctave.load();
 
-        startThread (5);
-    }
+        if (frame.fftSize != fftSize || frame.sampleRate != sampleRate || axis != frequencyAxis || bins != binsPerOctave)
+            reset (frame, axis, bins);
 
-    void run() override
-    {
-        while (! threadShouldExit())
+        const float* magnitudes = frame.magnitudes;
+
+        if (constantQ != nullptr)
         {
-            if (abstractFifo.getNumReady() >= fft.getSize())
-            {
-                fftBuffer.clear();
+            // The constant-Q kernels carry their own window
+            constantQ->applyKernels (frame.spectrum, constantQBuffer.getWritePointer (0));
+            magnitudes = constantQBuffer.getReadPointer (0);
+        }
 
-                int start1, block1, start2, block2;
-                abstractFifo.prepareToRead (fft.getSize(), start1, block1, start2, block2);
-                if (block1 > 0) fftBuffer.copyFrom (0, 0, audioFifo.getReadPointer (0, start1), block1);
-                if (block2 > 0) fftBuffer.copyFrom (0, block1, audioFifo.getReadPointer (0, start2), block2);
-                abstractFifo.finishedRead ((block1 + block2) / 2);
+        const int numBins = averager.getNumSamples();
 
-                windowing.multiplyWithWindowingTable (fftBuffer.getWritePointer (0), size_t (fft.getSize()));
-                fft.performFrequencyOnlyForwardTransform (fftBuffer.getWritePointer (0));
+        averager.addFrom (0, 0, averager.getReadPointer (averagerPtr), numBins, -1.0f);
+        averager.copyFrom (averagerPtr, 0, magnitudes, numBins, 1.0f / (averager.getNumChannels() - 1));
+        averager.addFrom (0, 0, averager.getReadPointer (averagerPtr), numBins);
+        if (++averagerPtr == averager.getNumChannels()) averagerPtr = 1;
 
-                ScopedLock lockedForWriting (pathCreationLock);
-                averager.addFrom (0, 0, averager.getReadPointer (averagerPtr), averager.getNumSamples(), -1.0f);
-                averager.copyFrom (averagerPtr, 0, fftBuffer.getReadPointer (0), averager.getNumSamples(), 1.0f / (averager.getNumSamples() * (averager.getNumChannels() - 1)));
-                averager.addFrom (0, 0, averager.getReadPointer (averagerPtr), averager.getNumSamples());
-                if (++averagerPtr == averager.getNumChannels()) averagerPtr = 1;
+        nextLevels.assign (averager.getReadPointer (0), averager.getReadPointer (0) + numBins);
 
-                newDataAvailable = true;
-            }
+        {
+            const juce::ScopedLock lockedForWriting (pathCreationLock);
+            std::swap (levels, nextLevels);
 
-            if (abstractFifo.getNumReady() < fft.getSize())
-                waitForData.wait (100);
+            if (frequenciesChanged)
+            {
+                std::swap (frequencies, binFrequencies);
+                frequenciesChanged = false;
+            }
         }
+
+        newDataAvailable = true;
     }
 
-    void createPath (Path& p, const Rectangle<float> bounds, float minFreq)
+    void createPath (juce::Path& p, const juce::Rectangle<float> bounds, float minFreq)
     {
         p.clear();
-        p.preallocateSpace (8 + averager.getNumSamples() * 3);
 
-        ScopedLock lockedForReading (pathCreationLock);
-        const auto* fftData = averager.getReadPointer (0);
-        const auto  factor  = bounds.getWidth() / 10.0f;
+        const juce::ScopedLock lockedForReading (pathCreationLock);
+
+        // No frame has arrived yet
+        if (levels.empty())
+            return;
+
+        p.preallocateSpace (8 + (int) levels.size() * 3);
+
+        const auto factor = bounds.getWidth() / 10.0f;
 
-        p.startNewSubPath (bounds.getX() + factor * indexToX (0, minFreq), binToY (fftData [0], bounds));
-        for (int i = 0; i < averager.getNumSamples(); ++i)
-            p.lineTo (bounds.getX() + factor * indexToX (i, minFreq), binToY (fftData [i], bounds));
+        p.startNewSubPath (bounds.getX() + factor * frequencyToX (frequencies[0], minFreq), binToY (levels[0], bounds));
+        for (size_t i = 0; i < levels.size(); ++i)
+            p.lineTo (bounds.getX() + factor * frequencyToX (frequencies[i], minFreq), binToY (levels[i], bounds));
     }
 
     bool checkForNewData()
@@ -108,36 +115,74 @@ public:
     }
 
 private:
+    /** Sizes the averager for a new frame size, sample rate or axis. Only
+        touches the graph thread's state, so it runs outside the lock.
+     */
+    void reset (const FFTFrame& frame, FrequencyAxis axis, int bins)
+    {
+        fftSize = frame.fftSize;
+        sampleRate = (Type) frame.sampleRate;
+        frequencyAxis = axis;
+        binsPerOctave = bins;
+        constantQ.reset();
 
-    inline float indexToX (float index, float minFreq) const
+        if (frequencyAxis == FrequencyAxis::constantQ)
+        {
+            constantQ = std::make_unique<ConstantQ>();
+            constantQ->prepare (frame.sampleRate, juce::roundToInt (std::log2 (fftSize)), 20.0f, 20000.0f, binsPerOctave);
+            constantQBuffer.setSize (1, constantQ->getNumBins());
+        }
+
+        const int numBins = constantQ != nullptr ? constantQ->getNumBins() : fftSize / 2;
+        averager.setSize (5, numBins);
+        averager.clear();
+        averagerPtr = 1;
+
+        binFrequencies.resize ((size_t) numBins);
+
+        for (int i = 0; i < numBins; ++i)
+            binFrequencies[(size_t) i] = constantQ != nullptr ? constantQ->getBinFrequency (i)
+                                                             : (float) ((sampleRate * i) / fftSize);
+
+        // Published with the first spectrum on the new axis
+        frequenciesChanged = true;
+    }
+
+    static float frequencyToX (float freq, float minFreq)
     {
-        const auto freq = (sampleRate * index) / fft.getSize();
         return (freq > 0.01f) ? std::log (freq / minFreq) / std::log (2.0f) : 0.0f;
     }
 
-    inline float binToY (float bin, const Rectangle<float> bounds) const
+    static float binToY (float bin, const juce::Rectangle<float> bounds)
     {
         const float infinity = -80.0f;
-        return jmap (Decibels::gainToDecibels (bin, infinity),
-                     infinity, 0.0f, bounds.getBottom(), bounds.getY());
+        return juce::jmap (juce::Decibels::gainToDecibels (bin, infinity),
+                           infinity, 0.0f, bounds.getBottom(), bounds.getY());
     }
 
-    WaitableEvent waitForData;
-    CriticalSection pathCreationLock;
-
+    // Graph thread only
     Type sampleRate {};
+    int fftSize = 0;
 
-    dsp::FFT fft                           { 12 };
-    dsp::WindowingFunction<Type> windowing { size_t (fft.getSize()), dsp::WindowingFunction<Type>::hann, true };
-    AudioBuffer<float> fftBuffer           { 1, fft.getSize() * 2 };
-
-    AudioBuffer<float> averager            { 5, fft.getSize() / 2 };
+    juce::AudioBuffer<float> averager;
     int averagerPtr = 1;
 
-    AbstractFifo abstractFifo              { 48000 };
-    AudioBuffer<Type> audioFifo;
+    FrequencyAxis frequencyAxis = FrequencyAxis::linear;
+    int binsPerOctave = 24;
+    std::unique_ptr<ConstantQ> constantQ;
+    juce::AudioBuffer<float> constantQBuffer;
+    std::vector<float> binFrequencies, nextLevels;
+    bool frequenciesChanged = false;
+
+    // Requested by setFrequencyAxis()
+    std::atomic<FrequencyAxis> requestedAxis { FrequencyAxis::linear };
+    std::atomic<int> requestedBinsPerOctave { 24 };
+
+    // The latest spectrum, read by createPath()
+    juce::CriticalSection pathCreationLock;
+    std::vector<float> levels, frequencies;
 
-    std::atomic<bool> newDataAvailable;
+    std::atomic<bool> newDataAvailable { false };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Analyser)
 };
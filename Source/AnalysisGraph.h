@@ -0,0 +1,434 @@
+//
+//  AnalysisGraph.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <array>
+#include <complex>
+#include <vector>
+
+/** The window applied to a frame before its magnitudes are taken. All of
+    them are cosine sums, so they can be applied in the frequency domain.
+ */
+enum class AnalysisWindow
+{
+    rectangular,
+    hann,
+    hamming,
+    blackman
+};
+
+/** One analysis frame, as handed to every AnalysisGraph::Stage.
+    The pointers are only valid during the callback.
+ */
+struct FFTFrame
+{
+    int fftSize = 0;
+    int hopSize = 0;        // The hop of the stage receiving the frame
+    double sampleRate = 0.0;
+
+    /** Index of the first sample of the frame in the stream, counted since
+        the graph was set up.
+     */
+    juce::int64 position = 0;
+
+    /** Transform of the raw, unwindowed frame: bins 0 to fftSize / 2. This is
+        what ConstantQ::applyKernels() expects.
+     */
+    const std::complex<float>* spectrum = nullptr;
+
+    /** Magnitudes of the frame with the stage's window applied, bins 0 to
+        fftSize / 2, scaled so that a sine of amplitude A centred on a bin
+        reads A.
+     */
+    const float* magnitudes = nullptr;
+    AnalysisWindow window = AnalysisWindow::rectangular;
+
+    int getNumBins() const noexcept                     { return fftSize / 2 + 1; }
+    float getBinFrequency (int bin) const noexcept      { return (float) (bin * sampleRate / fftSize); }
+};
+
+//==============================================================================
+/** The FFT engine shared by the analysis stages.
+
+    Every stage declares the transform it needs: FFT size, hop and window.
+    The graph merges the requests, so that each FFT size is transformed once
+    per hop however many stages use it:
+
+    - Stages with the same FFT size share one transform. It runs at the
+      greatest common divisor of their hops, and a stage with a longer hop
+      gets every n-th frame.
+    - Only the unwindowed transform is computed. Windowed magnitudes are
+      derived from it in the frequency domain, where a cosine-sum window is
+      a short kernel; the periodic Hann window, for example, is
+
+          H[k] = 0.5 X[k] - 0.25 (X[k - 1] + X[k + 1])
+
+      Each window is derived at most once per frame, and only if a stage
+      receiving that frame asked for it.
+
+    Audio from the processor goes through a fifo to the graph's thread, which
+    calls the stages. The frames are read-only and shared between them.
+ */
+class AnalysisGraph : public juce::Thread
+{
+public:
+    /** What a stage needs from the graph. */
+    struct Request
+    {
+        int fftOrder = 12;
+        int hopSize = 1024;     // A power of two no larger than the FFT size shares best
+        AnalysisWindow window = AnalysisWindow::hann;
+    };
+
+    /** A consumer of frames, called on the graph's thread. */
+    class Stage
+    {
+    public:
+        virtual ~Stage() = default;
+
+        /** Read when the stage is added. */
+        virtual Request getAnalysisRequest() const = 0;
+
+        virtual void processFrame (const FFTFrame& frame) = 0;
+    };
+
+    AnalysisGraph() : juce::Thread ("Vizz-AnalysisGraph")
+    {
+    }
+
+    ~AnalysisGraph() override
+    {
+        stopThread (1000);
+    }
+
+    /** Stages can be added and removed from any thread. Removing one waits for
+        a frame being processed, so a stage can remove itself from its
+        destructor.
+     */
+    void addStage (Stage* stage)
+    {
+        jassert (stage != nullptr);
+        const auto request = stage->getAnalysisRequest();
+        jassert (request.hopSize > 0 && request.hopSize <= (1 << request.fftOrder));
+
+        const juce::ScopedLock sl (graphLock);
+        stages.push_back ({ stage, request, 0 });
+        rebuild();
+    }
+
+    void removeStage (Stage* stage)
+    {
+        const juce::ScopedLock sl (graphLock);
+        stages.erase (std::remove_if (stages.begin(), stages.end(), [stage] (const StageEntry& e) { return e.stage == stage; }),
+                      stages.end());
+        rebuild();
+    }
+
+    /** Sizes the fifo for a sample rate and (re)starts the thread. Call it
+        while addAudioData() cannot run, e.g. from prepareToPlay().
+     */
+    void setup (double sampleRateToUse)
+    {
+        stopThread (1000);
+        prepare (sampleRateToUse);
+
+        const int fifoSize = juce::roundToInt (sampleRate);
+        audioFifo.setSize (1, fifoSize);
+        abstractFifo.setTotalSize (fifoSize);
+
+        startThread (5);
+    }
+
+    /** Rewinds the stream for a sample rate, without starting the thread. Use
+        it instead of setup() to drive the graph with processSamples().
+     */
+    void prepare (double sampleRateToUse)
+    {
+        jassert (sampleRateToUse > 0.0);
+        const juce::ScopedLock sl (graphLock);
+
+        sampleRate = sampleRateToUse;
+        samplesProcessed = 0;
+
+        for (auto& transform : transforms)
+            transform->reset (0);
+    }
+
+    /** Sums the channels into the fifo. Call from the audio thread. */
+    void addAudioData (const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels)
+    {
+        if (abstractFifo.getTotalSize() <= 1 || abstractFifo.getFreeSpace() < buffer.getNumSamples())
+            return;
+
+        int start1, block1, start2, block2;
+        abstractFifo.prepareToWrite (buffer.getNumSamples(), start1, block1, start2, block2);
+        audioFifo.copyFrom (0, start1, buffer.getReadPointer (startChannel), block1);
+        if (block2 > 0)
+            audioFifo.copyFrom (0, start2, buffer.getReadPointer (startChannel, block1), block2);
+
+        for (int channel = startChannel + 1; channel < startChannel + numChannels; ++channel)
+        {
+            if (block1 > 0) audioFifo.addFrom (0, start1, buffer.getReadPointer (channel), block1);
+            if (block2 > 0) audioFifo.addFrom (0, start2, buffer.getReadPointer (channel, block1), block2);
+        }
+        abstractFifo.finishedWrite (block1 + block2);
+        waitForData.signal();
+    }
+
+    /** Runs the graph over samples on the calling thread, without the fifo.
+        For offline use, after prepare().
+     */
+    void processSamples (const float* samples, int numSamples)
+    {
+        const juce::ScopedLock sl (graphLock);
+
+        for (auto& transform : transforms)
+        {
+            const float* input = samples;
+            int remaining = numSamples;
+
+            while (remaining > 0)
+            {
+                const int fftSize = transform->fft.getSize();
+                const int count = juce::jmin (remaining, fftSize - transform->framePosition);
+                std::copy (input, input + count, transform->frame.begin() + transform->framePosition);
+                transform->framePosition += count;
+                input += count;
+                remaining -= count;
+
+                if (transform->framePosition == fftSize)
+                    runTransform (*transform);
+            }
+        }
+
+        samplesProcessed += numSamples;
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            const int numReady = abstractFifo.getNumReady();
+
+            if (numReady > 0)
+            {
+                int start1, block1, start2, block2;
+                abstractFifo.prepareToRead (numReady, start1, block1, start2, block2);
+                if (block1 > 0) processSamples (audioFifo.getReadPointer (0, start1), block1);
+                if (block2 > 0) processSamples (audioFifo.getReadPointer (0, start2), block2);
+                abstractFifo.finishedRead (block1 + block2);
+            }
+
+            if (abstractFifo.getNumReady() == 0)
+                waitForData.wait (100);
+        }
+    }
+
+    double getSampleRate() const noexcept   { return sampleRate; }
+
+    /** The number of distinct transforms the current stages need. */
+    int getNumTransforms() const
+    {
+        const juce::ScopedLock sl (graphLock);
+        return (int) transforms.size();
+    }
+
+    //==========================================================================
+    /** Windowed magnitudes from an unwindowed spectrum, by convolution with
+        the window's spectral kernel.
+
+        @param spectrum     bins 0 to fftSize / 2 of a real signal's transform
+        @param magnitudes   receives fftSize / 2 + 1 values, scaled to sine
+                            amplitude
+     */
+    static void applyWindow (const std::complex<float>* spectrum, int fftSize, AnalysisWindow window, float* magnitudes) noexcept
+    {
+        // w[n] = a0 - a1 cos (2 pi n / N) + a2 cos (4 pi n / N)
+        static constexpr float coefficients[][3] = { { 1.0f,  0.0f, 0.0f  },     // rectangular
+                                                     { 0.5f,  0.5f, 0.0f  },     // hann
+                                                     { 0.54f, 0.46f, 0.0f },     // hamming
+                                                     { 0.42f, 0.5f, 0.08f } };   // blackman
+        const auto& a = coefficients[(int) window];
+        const int lastBin = fftSize / 2;
+        const auto scale = 2.0f / ((float) fftSize * a[0]);
+
+        // The spectrum of a real signal is conjugate-symmetric
+        auto bin = [spectrum, lastBin] (int k)
+        {
+            if (k < 0)          return std::conj (spectrum[-k]);
+            if (k > lastBin)    return std::conj (spectrum[2 * lastBin - k]);
+            return spectrum[k];
+        };
+
+        for (int k = 0; k <= lastBin; ++k)
+        {
+            auto windowed = a[0] * spectrum[k];
+
+            if (a[1] != 0.0f)   windowed -= 0.5f * a[1] * (bin (k - 1) + bin (k + 1));
+            if (a[2] != 0.0f)   windowed += 0.5f * a[2] * (bin (k - 2) + bin (k + 2));
+
+            magnitudes[k] = scale * std::abs (windowed);
+        }
+    }
+
+private:
+    //==========================================================================
+    static constexpr int numWindows = 4;
+
+    struct Transform
+    {
+        Transform (int order, int hop) : fft (order), hopSize (hop)
+        {
+            const auto size = (size_t) fft.getSize();
+            frame.assign (size, 0.0f);
+            fftData.assign (2 * size, 0.0f);
+            scratch.assign ((size_t) fft.getScratchSize(), 0.0f);
+
+            for (auto& m : magnitudes)
+                m.assign (size / 2 + 1, 0.0f);
+        }
+
+        void reset (juce::int64 startPosition)
+        {
+            std::fill (frame.begin(), frame.end(), 0.0f);
+            framePosition = 0;
+            position = startPosition;
+            frameCount = 0;
+        }
+
+        juce::dsp::FFT fft;
+        const int hopSize;
+
+        std::vector<float> frame, fftData;
+        std::vector<float> scratch;     // So the FFT doesn't allocate its own on each call
+        std::array<std::vector<float>, numWindows> magnitudes;
+        std::array<bool, numWindows> magnitudesReady {};
+
+        int framePosition = 0;
+        juce::int64 position = 0;       // Of the first sample in frame
+        juce::int64 frameCount = 0;
+    };
+
+    struct StageEntry
+    {
+        Stage* stage;
+        Request request;
+        size_t transform;
+    };
+
+    /** Merges the stages' requests into transforms, keeping the running ones
+        that are still needed as they are.
+     */
+    void rebuild()
+    {
+        std::vector<std::pair<int, int>> needed;     // Order and hop
+
+        for (auto& entry : stages)
+        {
+            auto match = std::find_if (needed.begin(), needed.end(), [&entry] (const std::pair<int, int>& n)
+                                       { return n.first == entry.request.fftOrder; });
+
+            if (match == needed.end())
+                needed.push_back ({ entry.request.fftOrder, entry.request.hopSize });
+            else
+                match->second = greatestCommonDivisor (match->second, entry.request.hopSize);
+        }
+
+        std::vector<std::unique_ptr<Transform>> newTransforms;
+
+        for (auto& n : needed)
+        {
+            auto existing = std::find_if (transforms.begin(), transforms.end(), [&n] (const std::unique_ptr<Transform>& t)
+                                          { return t != nullptr && t->fft.getSize() == (1 << n.first) && t->hopSize == n.second; });
+
+            if (existing != transforms.end())
+            {
+                newTransforms.push_back (std::move (*existing));
+            }
+            else
+            {
+                newTransforms.push_back (std::make_unique<Transform> (n.first, n.second));
+                newTransforms.back()->reset (samplesProcessed);
+            }
+        }
+
+        transforms = std::move (newTransforms);
+
+        for (auto& entry : stages)
+            for (size_t i = 0; i < transforms.size(); ++i)
+                if (transforms[i]->fft.getSize() == (1 << entry.request.fftOrder))
+                    entry.transform = i;
+    }
+
+    static int greatestCommonDivisor (int a, int b) noexcept
+    {
+        while (b != 0)
+        {
+            const int remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+
+        return a;
+    }
+
+    void runTransform (Transform& transform)
+    {
+        const int fftSize = transform.fft.getSize();
+        std::copy (transform.frame.begin(), transform.frame.end(), transform.fftData.begin());
+        transform.fft.performRealOnlyForwardTransform (transform.fftData.data(), true, transform.scratch.data());
+        transform.magnitudesReady.fill (false);
+
+        const auto* spectrum = reinterpret_cast<const std::complex<float>*> (transform.fftData.data());
+
+        for (auto& entry : stages)
+        {
+            if (transforms[entry.transform].get() != &transform
+                 || transform.frameCount % (entry.request.hopSize / transform.hopSize) != 0)
+                continue;
+
+            const auto w = (size_t) entry.request.window;
+
+            if (! transform.magnitudesReady[w])
+            {
+                applyWindow (spectrum, fftSize, entry.request.window, transform.magnitudes[w].data());
+                transform.magnitudesReady[w] = true;
+            }
+
+            FFTFrame frame;
+            frame.fftSize = fftSize;
+            frame.hopSize = entry.request.hopSize;
+            frame.sampleRate = sampleRate;
+            frame.position = transform.position;
+            frame.spectrum = spectrum;
+            frame.magnitudes = transform.magnitudes[w].data();
+            frame.window = entry.request.window;
+
+            entry.stage->processFrame (frame);
+        }
+
+        // Slide the frame along by one hop
+        std::copy (transform.frame.begin() + transform.hopSize, transform.frame.end(), transform.frame.begin());
+        transform.framePosition = fftSize - transform.hopSize;
+        transform.position += transform.hopSize;
+        ++transform.frameCount;
+    }
+
+    //==========================================================================
+    double sampleRate = 0.0;
+
+    juce::CriticalSection graphLock;
+    std::vector<StageEntry> stages;
+    std::vector<std::unique_ptr<Transform>> transforms;
+    juce::int64 samplesProcessed = 0;
+
+    juce::WaitableEvent waitForData;
+    juce::AbstractFifo abstractFifo { 1 };
+    juce::AudioBuffer<float> audioFifo;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisGraph)
+};
@@ -0,0 +1,572 @@
+//
+//  BatchAnalyser.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AnalysisGraph.h"
+#include "OnsetTracker.h"
+#include "LoudnessMeter.h"
+#include "TruePeakMeter.h"
+#include "ScopeAnalysis.h"
+#include <set>
+#include <vector>
+
+/** Analyses audio files for quality control, writing one JSON file per
+    audio file: loudness, true peak, the spectral centroid, warmth and cool
+    over time, and the onset times.
+
+    Files are split into chunks of Options::chunkLength, and each chunk is a
+    ThreadPool job of its own, so a folder of deliveries and a single long
+    recording both keep every core busy. A chunk starts reading a little
+    early, to warm up its meters and transforms on the audio before it, and
+    keeps the loudness blocks and FFT frames where a run over the whole file
+    would put them. The chunks' results then merge exactly: gated loudness
+    histograms add, peaks take the maximum, and the curves and onsets are
+    concatenated.
+
+    WAV and AIFF files are read through a MemoryMappedAudioFormatReader that
+    maps just the chunk, which lets the OS page it in rather than each job
+    streaming through a file; other formats fall back to the
+    AudioFormatManager's readers.
+ */
+class BatchAnalyser
+{
+public:
+    struct Options
+    {
+        int numThreads = juce::SystemStats::getNumCpus();
+
+        /** Samples between the points of the curves, about 93 ms at 44.1 kHz. */
+        int curveHopSize = 4096;
+
+        /** Seconds of audio per job. Longer files are analysed in parallel. */
+        double chunkLength = 300.0;
+    };
+
+    explicit BatchAnalyser (const Options& optionsToUse) : options (optionsToUse)
+    {
+        jassert (options.curveHopSize > 0 && options.chunkLength > 0.0);
+        formatManager.registerBasicFormats();
+    }
+
+    /** Called now and then on the thread running analyse(), with the chunks
+        finished so far.
+     */
+    std::function<void (int numChunksDone, int numChunks)> onProgress;
+
+    /** Analyses the files into outputDirectory, as <file name>.json, and
+        writes summary.json there listing every file with its result or
+        error. Fails if any file could not be analysed.
+     */
+    juce::Result analyse (const juce::Array<juce::File>& files, const juce::File& outputDirectory)
+    {
+        const auto created = outputDirectory.createDirectory();
+
+        if (created.failed())
+            return created;
+
+        std::vector<std::unique_ptr<FileJob>> jobs;
+        std::set<juce::String> usedNames;
+        int numChunks = 0;
+
+        for (auto& file : files)
+        {
+            // Files of the same name from different folders get a number
+            auto name = file.getFileName();
+
+            for (int suffix = 2; usedNames.count (name.toLowerCase()) > 0; ++suffix)
+                name = file.getFileNameWithoutExtension() + "_" + juce::String (suffix) + file.getFileExtension();
+
+            usedNames.insert (name.toLowerCase());
+
+            jobs.push_back (std::make_unique<FileJob>());
+            auto& job = *jobs.back();
+            job.file = file;
+            job.outputFile = outputDirectory.getChildFile (name + ".json");
+
+            std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+            if (reader == nullptr)
+                job.result = makeError (file, "Cannot read the file");
+            else if (reader->sampleRate <= 0.0 || reader->numChannels == 0)
+                job.result = makeError (file, "No audio in the file");
+            else
+                planChunks (job, *reader);
+
+            numChunks += (int) job.chunkRanges.size();
+        }
+
+        // Thousands of chunks, all added at once to a queue per thread
+        juce::ThreadPool pool (juce::jmax (1, options.numThreads), 0, juce::ThreadPool::Scheduling::workStealing);
+        std::vector<std::function<void()>> chunkJobs;
+        numChunksDone = 0;
+
+        for (auto& job : jobs)
+        {
+            job->chunks.resize (job->chunkRanges.size());
+            job->numChunksRemaining = (int) job->chunks.size();
+
+            for (size_t i = 0; i < job->chunks.size(); ++i)
+            {
+                chunkJobs.push_back ([this, &fileJob = *job, i]
+                {
+                    analyseChunk (fileJob, i);
+
+                    // The last chunk of a file to finish writes it
+                    if (--fileJob.numChunksRemaining == 0)
+                        finishFile (fileJob);
+
+                    ++numChunksDone;
+                });
+            }
+        }
+
+        pool.addJobs (chunkJobs);
+
+        while (pool.getNumJobs() > 0)
+        {
+            if (onProgress != nullptr)
+                onProgress (numChunksDone.load(), numChunks);
+
+            juce::Thread::sleep (50);
+        }
+
+        if (onProgress != nullptr)
+            onProgress (numChunksDone.load(), numChunks);
+
+        juce::Array<juce::var> summary;
+        int numFailed = 0;
+
+        for (auto& job : jobs)
+        {
+            summary.add (job->result);
+
+            if (job->result.hasProperty ("error"))
+                ++numFailed;
+        }
+
+        const auto summaryFile = outputDirectory.getChildFile ("summary.json");
+
+        if (! summaryFile.replaceWithText (juce::JSON::toString (summary)))
+            return juce::Result::fail ("Cannot write " + summaryFile.getFullPathName());
+
+        if (numFailed > 0)
+            return juce::Result::fail (juce::String (numFailed) + " of " + juce::String (files.size())
+                                        + " files could not be analysed, see " + summaryFile.getFullPathName());
+
+        return juce::Result::ok();
+    }
+
+    /** Analyses one file on the calling thread, in one piece.
+
+        @returns    the analysis as a JSON object, or an object with an
+                    "error" property
+     */
+    juce::var analyseFile (const juce::File& file)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+        if (reader == nullptr)
+            return makeError (file, "Cannot read the file");
+
+        if (reader->sampleRate <= 0.0 || reader->numChannels == 0)
+            return makeError (file, "No audio in the file");
+
+        FileAnalysis analysis (options, reader->sampleRate, (int) reader->numChannels, { 0, reader->lengthInSamples });
+        analysis.process (*reader);
+
+        auto result = analysis.toVar();
+        result.getDynamicObject()->setProperty ("file", file.getFullPathName());
+        return result;
+    }
+
+    /** True for the files the analyser can read, judged by extension. */
+    bool canAnalyse (const juce::File& file) const
+    {
+        return formatManager.findFormatForFileExtension (file.getFileExtension()) != nullptr;
+    }
+
+    /** The patterns of the files the analyser can read, e.g. for a folder search. */
+    juce::String getWildcardForAllFormats() const
+    {
+        return formatManager.getWildcardForAllFormats();
+    }
+
+private:
+    //==========================================================================
+    /** The analysis of one range of a file. */
+    class FileAnalysis
+    {
+    public:
+        FileAnalysis (const Options& options, double sampleRateToUse, int numChannelsToUse,
+                      juce::Range<juce::int64> rangeToMeasure)
+            : sampleRate (sampleRateToUse), numChannels (numChannelsToUse), range (rangeToMeasure),
+              curves (options.curveHopSize)
+        {
+            loudness.prepare (sampleRate, numChannels);
+            blockSize = LoudnessMeter::getSamplesPerBlock (sampleRate);
+
+            // The gating counts whole loudness blocks from the start of the
+            // range, so it has to start on one
+            jassert (range.getStart() % blockSize == 0);
+
+            graph.addStage (&curves);
+            graph.addStage (&onsets);
+            graph.prepare (sampleRate);
+
+            // Start early enough for the state at the start of the range to
+            // be what it would be in a run from the start of the file, on the
+            // loudness blocks and frames such a run would have
+            const auto curvesRequest = curves.getAnalysisRequest();
+            const auto onsetsRequest = onsets.getAnalysisRequest();
+            const auto warmUpTime = juce::jmax (LoudnessMeter::getHistoryLength(), OnsetTracker::getHistoryLength());
+
+            frameLength = 1 << juce::jmax (curvesRequest.fftOrder, onsetsRequest.fftOrder);
+            const auto warmUp = (juce::int64) std::ceil (warmUpTime * sampleRate) + frameLength;
+            const auto earliest = juce::jmax ((juce::int64) 0, range.getStart() - warmUp);
+            const auto frameStep = leastCommonMultiple (curvesRequest.hopSize, onsetsRequest.hopSize);
+
+            meterStart = earliest / blockSize * blockSize;
+            graphStart = earliest / frameStep * frameStep;
+
+            curves.streamStart = onsets.streamStart = graphStart;
+            curves.range = onsets.range = range;
+
+            // Reading goes one loudness block at a time, so the momentary and
+            // short-term maxima see every reading
+            block.setSize (numChannels, blockSize);
+            mono.setSize (1, blockSize);
+        }
+
+        ~FileAnalysis()
+        {
+            graph.removeStage (&onsets);
+            graph.removeStage (&curves);
+        }
+
+        /** The samples process() reads: the range, the audio before it that
+            warms up the analysis, and the frames that start in the range.
+         */
+        juce::Range<juce::int64> getSamplesToRead (juce::int64 lengthInSamples) const
+        {
+            return { juce::jmin (meterStart, graphStart) / blockSize * blockSize,
+                     juce::jmin (lengthInSamples, range.getEnd() + frameLength) };
+        }
+
+        void process (juce::AudioFormatReader& reader)
+        {
+            const auto samplesToRead = getSamplesToRead (reader.lengthInSamples);
+            const juce::Range<juce::int64> meterRange (meterStart, juce::jmin (range.getEnd(), samplesToRead.getEnd()));
+            const juce::Range<juce::int64> graphRange (graphStart, samplesToRead.getEnd());
+
+            for (auto position = samplesToRead.getStart(); position < samplesToRead.getEnd(); position += blockSize)
+            {
+                const juce::Range<juce::int64> blockRange (position, juce::jmin (position + blockSize, samplesToRead.getEnd()));
+                reader.read (&block, 0, (int) blockRange.getLength(), position, true, true);
+
+                // The readings before the range were for warming up
+                if (position == range.getStart())
+                {
+                    loudness.resetGating();
+                    truePeak.resetPeaks();
+                }
+
+                const auto toMeter = blockRange.getIntersectionWith (meterRange);
+
+                if (! toMeter.isEmpty())
+                {
+                    loudness.process (block, (int) (toMeter.getStart() - position), (int) toMeter.getLength());
+                    truePeak.process (block, (int) (toMeter.getStart() - position), (int) toMeter.getLength());
+
+                    if (toMeter.getStart() >= range.getStart())
+                    {
+                        maxMomentary = juce::jmax (maxMomentary, loudness.getMomentaryLoudness());
+                        maxShortTerm = juce::jmax (maxShortTerm, loudness.getShortTermLoudness());
+                    }
+                }
+
+                // The graph takes the sum of the first two channels, as from
+                // the processor
+                const auto toGraph = blockRange.getIntersectionWith (graphRange);
+
+                if (! toGraph.isEmpty())
+                {
+                    const int offset = (int) (toGraph.getStart() - position);
+                    const int numSamples = (int) toGraph.getLength();
+                    mono.copyFrom (0, 0, block, 0, offset, numSamples);
+
+                    if (numChannels > 1)
+                        mono.addFrom (0, 0, block, 1, offset, numSamples);
+
+                    graph.processSamples (mono.getReadPointer (0), numSamples);
+                }
+            }
+
+            range = range.withEnd (meterRange.getEnd());
+            maxTruePeak = truePeak.getMaxPeakDecibels();
+            bpm = onsets.getBPM();
+        }
+
+        /** Adds the analysis of the range that follows this one, as if this
+            one had gone on to measure it.
+         */
+        void append (const FileAnalysis& next)
+        {
+            jassert (next.range.getStart() == range.getEnd());
+
+            loudness.merge (next.loudness);
+            maxMomentary = juce::jmax (maxMomentary, next.maxMomentary);
+            maxShortTerm = juce::jmax (maxShortTerm, next.maxShortTerm);
+            maxTruePeak = juce::jmax (maxTruePeak, next.maxTruePeak);
+
+            curves.time.addArray (next.curves.time);
+            curves.centroid.addArray (next.curves.centroid);
+            curves.warmth.addArray (next.curves.warmth);
+            curves.cool.addArray (next.curves.cool);
+            onsets.times.addArray (next.onsets.times);
+
+            // The tempo at the end of the file, as in a single run
+            bpm = next.bpm;
+            range = range.withEnd (next.range.getEnd());
+        }
+
+        juce::var toVar() const
+        {
+            auto* result = new juce::DynamicObject();
+            result->setProperty ("sampleRate", sampleRate);
+            result->setProperty ("numChannels", numChannels);
+            result->setProperty ("duration", (double) range.getLength() / sampleRate);
+
+            auto* loudnessResult = new juce::DynamicObject();
+            loudnessResult->setProperty ("integrated", loudness.getIntegratedLoudness());
+            loudnessResult->setProperty ("range", loudness.getLoudnessRange());
+            loudnessResult->setProperty ("maxMomentary", maxMomentary);
+            loudnessResult->setProperty ("maxShortTerm", maxShortTerm);
+            result->setProperty ("loudness", loudnessResult);
+            result->setProperty ("truePeak", maxTruePeak);
+
+            auto* curvesResult = new juce::DynamicObject();
+            curvesResult->setProperty ("time", curves.time);
+            curvesResult->setProperty ("spectralCentroid", curves.centroid);
+            curvesResult->setProperty ("warmth", curves.warmth);
+            curvesResult->setProperty ("cool", curves.cool);
+            result->setProperty ("curves", curvesResult);
+
+            result->setProperty ("onsets", onsets.times);
+            result->setProperty ("bpm", bpm);
+
+            return result;
+        }
+
+    private:
+        /** The spectral centroid and Vizz's warmth and cool, once a hop. */
+        struct Curves : public AnalysisGraph::Stage
+        {
+            explicit Curves (int hopSizeToUse) : hopSize (hopSizeToUse) {}
+
+            AnalysisGraph::Request getAnalysisRequest() const override
+            {
+                auto request = ScopeAnalysis::getBandsRequest();
+                request.hopSize = hopSize;
+                return request;
+            }
+
+            void processFrame (const FFTFrame& frame) override
+            {
+                const auto position = streamStart + frame.position;
+
+                if (! range.contains (position))
+                    return;
+
+                double weighted = 0.0, total = 0.0;
+
+                for (int bin = 1; bin < frame.getNumBins(); ++bin)
+                {
+                    weighted += frame.getBinFrequency (bin) * frame.magnitudes[bin];
+                    total += frame.magnitudes[bin];
+                }
+
+                float frameWarmth, frameCool;
+                ScopeAnalysis::measureBands (frame, frameWarmth, frameCool);
+
+                // Points are stamped with the centre of their frame
+                time.add ((double) (position + frame.fftSize / 2) / frame.sampleRate);
+                centroid.add (total > 0.0 ? weighted / total : 0.0);
+                warmth.add (frameWarmth);
+                cool.add (frameCool);
+            }
+
+            const int hopSize;
+            juce::int64 streamStart = 0;
+            juce::Range<juce::int64> range;
+            juce::Array<juce::var> time, centroid, warmth, cool;
+        };
+
+        /** Records the time of every onset the tracker detects. */
+        struct Onsets : public OnsetTracker
+        {
+            void processFrame (const FFTFrame& frame) override
+            {
+                const int numBefore = getNumOnsets();
+                OnsetTracker::processFrame (frame);
+
+                // The tracker picks peaks one frame late
+                const auto position = streamStart + frame.position - frame.hopSize;
+
+                if (getNumOnsets() != numBefore && range.contains (position))
+                    times.add ((double) (position + frame.fftSize / 2) / frame.sampleRate);
+            }
+
+            juce::int64 streamStart = 0;
+            juce::Range<juce::int64> range;
+            juce::Array<juce::var> times;
+        };
+
+        static int leastCommonMultiple (int a, int b) noexcept
+        {
+            int x = a, y = b;
+
+            while (y != 0)
+            {
+                const int remainder = x % y;
+                x = y;
+                y = remainder;
+            }
+
+            return a / x * b;
+        }
+
+        const double sampleRate;
+        const int numChannels;
+        juce::Range<juce::int64> range;
+        int blockSize = 0, frameLength = 0;
+        juce::int64 meterStart = 0, graphStart = 0;
+
+        LoudnessMeter loudness;
+        TruePeakMeter truePeak;
+        float maxMomentary = LoudnessMeter::minLoudness, maxShortTerm = LoudnessMeter::minLoudness;
+        float maxTruePeak = 0.0f, bpm = 0.0f;
+
+        AnalysisGraph graph;
+        Curves curves;
+        Onsets onsets;
+
+        juce::AudioBuffer<float> block, mono;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileAnalysis)
+    };
+
+    //==========================================================================
+    struct FileJob
+    {
+        juce::File file, outputFile;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        juce::int64 lengthInSamples = 0;
+
+        // A chunk's analysis is made by its job, to keep the memory down
+        std::vector<juce::Range<juce::int64>> chunkRanges;
+        std::vector<std::unique_ptr<FileAnalysis>> chunks;
+        std::atomic<int> numChunksRemaining { 0 };
+        std::atomic<bool> failed { false };
+        juce::var result;
+    };
+
+    /** Splits a file into chunks on loudness block boundaries. */
+    void planChunks (FileJob& job, const juce::AudioFormatReader& reader)
+    {
+        job.sampleRate = reader.sampleRate;
+        job.numChannels = (int) reader.numChannels;
+        job.lengthInSamples = reader.lengthInSamples;
+
+        const auto blockSize = LoudnessMeter::getSamplesPerBlock (job.sampleRate);
+        const auto chunkSize = (juce::int64) juce::jmax (1, juce::roundToInt (options.chunkLength * job.sampleRate / blockSize)) * blockSize;
+        juce::int64 start = 0;
+
+        do
+        {
+            const auto end = juce::jmin (start + chunkSize, job.lengthInSamples);
+            job.chunkRanges.push_back ({ start, end });
+            start = end;
+        }
+        while (start < job.lengthInSamples);
+    }
+
+    void analyseChunk (FileJob& job, size_t index)
+    {
+        auto chunk = std::make_unique<FileAnalysis> (options, job.sampleRate, job.numChannels, job.chunkRanges[index]);
+        auto reader = createReader (job.file, chunk->getSamplesToRead (job.lengthInSamples));
+
+        if (reader == nullptr || reader->lengthInSamples != job.lengthInSamples)
+        {
+            job.failed = true;
+            return;
+        }
+
+        chunk->process (*reader);
+        job.chunks[index] = std::move (chunk);
+    }
+
+    void finishFile (FileJob& job)
+    {
+        if (job.failed)
+        {
+            job.result = makeError (job.file, "Cannot read the file");
+            return;
+        }
+
+        auto& analysis = *job.chunks.front();
+
+        for (size_t i = 1; i < job.chunks.size(); ++i)
+            analysis.append (*job.chunks[i]);
+
+        auto result = analysis.toVar();
+        result.getDynamicObject()->setProperty ("file", job.file.getFullPathName());
+        job.chunks.clear();
+
+        if (! job.outputFile.replaceWithText (juce::JSON::toString (result, false, 6)))
+        {
+            job.result = makeError (job.file, "Cannot write " + job.outputFile.getFullPathName());
+            return;
+        }
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("file", job.file.getFullPathName());
+        entry->setProperty ("result", job.outputFile.getFullPathName());
+        job.result = entry;
+    }
+
+    /** A reader with the samples memory-mapped where the format allows it,
+        else a streaming one.
+     */
+    std::unique_ptr<juce::AudioFormatReader> createReader (const juce::File& file, juce::Range<juce::int64> samplesToMap)
+    {
+        if (auto* format = formatManager.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (file));
+
+            if (mapped != nullptr && mapped->mapSectionOfFile (samplesToMap))
+                return std::unique_ptr<juce::AudioFormatReader> (mapped.release());
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader> (formatManager.createReaderFor (file));
+    }
+
+    static juce::var makeError (const juce::File& file, const juce::String& error)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("file", file.getFullPathName());
+        entry->setProperty ("error", error);
+        return entry;
+    }
+
+    //==========================================================================
+    const Options options;
+    juce::AudioFormatManager formatManager;
+    std::atomic<int> numChunksDone { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchAnalyser)
+};
@@ -0,0 +1,570 @@
+//
+//  Benchmarks.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "RingBuffer.h"
+#include "ScopeAnalysis.h"
+#include "FilterBankAnalyser.h"
+#include "TruePeakMeter.h"
+#include <array>
+#include <map>
+#include <vector>
+
+/** Micro-benchmarks of the hot paths: the RingBuffer, the scope's
+    correlation sync and downmix, FloatVectorOperations with each instruction
+    set the CPU has, the FFT at orders 6 to 15, dsp::BiquadCascade against
+    an IIR::Filter per channel or band, the TruePeakMeter, the third-octave
+    FilterBankAnalyser against a 4096 point FFT, and ThreadPool's throughput
+    of tiny jobs with each kind of scheduling.
+
+    Each benchmark times many batches of calls, and reports the time per
+    sample in nanoseconds over the batches: the minimum, median, 90th and
+    99th percentiles and mean. The results are a JSON object, and can be
+    compared with a stored one to flag regressions.
+ */
+class Benchmarks
+{
+public:
+    struct Options
+    {
+        /** Time spent on each benchmark. */
+        double secondsPerBenchmark = 0.25;
+
+        /** If not empty, only benchmarks whose name contains this are run. */
+        juce::String filter;
+    };
+
+    explicit Benchmarks (const Options& optionsToUse) : options (optionsToUse) {}
+
+    /** Called before each benchmark runs, with its name. */
+    std::function<void (const juce::String& name)> onBenchmarkStarted;
+
+    /** Runs the benchmarks on the calling thread.
+
+        @returns    an object with the machine in "system" and an array of
+                    results in "results", each with its "name" and times
+     */
+    juce::var run()
+    {
+        results.clear();
+
+        // RingBuffer, at the block sizes the audio thread writes and the
+        // sizes the renderers read
+        for (int numChannels : { 1, 2, 8 })
+        {
+            for (int blockSize : { 1, 16, 64, 256, 1024, 4096, 8192 })
+            {
+                const auto suffix = "/channels=" + juce::String (numChannels) + "/block=" + juce::String (blockSize);
+                auto ring = std::make_shared<RingBuffer<float>> (numChannels, ringSize);
+                auto block = std::make_shared<juce::AudioBuffer<float>> (numChannels, blockSize);
+                fillWithNoise (*block);
+
+                runBenchmark ("RingBuffer::writeSamples" + suffix, blockSize * numChannels,
+                              [ring, block, blockSize] { ring->writeSamples (*block, 0, blockSize); });
+
+                runBenchmark ("RingBuffer::readSamples" + suffix, blockSize * numChannels,
+                              [ring, block, blockSize] { ring->readSamples (*block, blockSize); });
+            }
+        }
+
+        // The scope's frame: the downmix (the decimation by zoom) and the
+        // correlation sync over what it leaves
+        juce::AudioBuffer<float> latest (2, ScopeAnalysis::ringBufferSize);
+        fillWithNoise (latest);
+
+        for (int zoom = 1; zoom <= 4; ++zoom)
+        {
+            const auto suffix = "/zoom=" + juce::String (zoom);
+            auto current = std::make_shared<std::vector<float>>();
+            ScopeAnalysis::downmix (latest, ScopeAnalysis::ringBufferSize, zoom, *current);
+
+            runBenchmark ("ScopeAnalysis::downmix" + suffix, ScopeAnalysis::ringBufferSize,
+                          [&latest, current, zoom] { ScopeAnalysis::downmix (latest, ScopeAnalysis::ringBufferSize, zoom, *current); });
+
+            auto analysis = std::make_shared<ScopeAnalysis>();
+            const ScopeAnalysis::Inputs inputs;
+
+            runBenchmark ("ScopeAnalysis::process" + suffix, ScopeAnalysis::ringBufferSize,
+                          [analysis, current, inputs] { analysis->process (*current, 1.0f / 60.0f, inputs); });
+        }
+
+        // The vector operations under the buffers, at audio block sizes. Each
+        // instruction set wider than the standard one reports its speed-up
+        const auto originalInstructionSet = juce::FloatVectorOperations::getInstructionSet();
+
+        for (int blockSize : { 32, 128, 512, 2048 })
+        {
+            auto a = std::make_shared<std::vector<float>> ((size_t) blockSize);
+            auto b = std::make_shared<std::vector<float>> ((size_t) blockSize);
+            auto dest = std::make_shared<std::vector<float>> ((size_t) (2 * blockSize));
+            juce::Random random (blockSize);
+
+            for (auto* vector : { a.get(), b.get(), dest.get() })
+                for (auto& sample : *vector)
+                    sample = random.nextFloat() * 2.0f - 1.0f;
+
+            const std::pair<const char*, std::function<void()>> kernels[] =
+            {
+                { "add",              [a, dest, blockSize] { juce::FloatVectorOperations::add (dest->data(), a->data(), blockSize); } },
+                { "multiply",         [a, b, dest, blockSize] { juce::FloatVectorOperations::multiply (dest->data(), a->data(), b->data(), blockSize); } },
+                { "copyWithMultiply", [a, dest, blockSize] { juce::FloatVectorOperations::copyWithMultiply (dest->data(), a->data(), 0.5f, blockSize); } },
+                { "addWithMultiply",  [a, dest, blockSize] { juce::FloatVectorOperations::addWithMultiply (dest->data(), a->data(), 0.5f, blockSize); } },
+                { "findMinAndMax",    [a, blockSize] { juce::FloatVectorOperations::findMinAndMax (a->data(), blockSize); } },
+                { "addWithMultiply2", [a, b, dest, blockSize] { juce::FloatVectorOperations::addWithMultiply2 (dest->data(), a->data(), 0.5f, b->data(), 0.5f, blockSize); } },
+                { "dotProduct",       [a, b, blockSize] { juce::FloatVectorOperations::dotProduct (a->data(), b->data(), blockSize); } },
+                { "interleave",       [a, b, dest, blockSize]
+                                      {
+                                          const float* sources[] = { a->data(), b->data() };
+                                          juce::FloatVectorOperations::interleave (dest->data(), sources, 2, blockSize);
+                                      } }
+            };
+
+            for (auto& kernel : kernels)
+            {
+                juce::DynamicObject* standard = nullptr;
+
+                for (auto instructionSet : { juce::FloatVectorOperations::InstructionSet::standard,
+                                             juce::FloatVectorOperations::InstructionSet::avx2,
+                                             juce::FloatVectorOperations::InstructionSet::avx512 })
+                {
+                    if (! juce::FloatVectorOperations::setInstructionSet (instructionSet))
+                        continue;
+
+                    const auto name = "FloatVectorOperations::" + juce::String (kernel.first)
+                                        + "/isa=" + getInstructionSetName (instructionSet) + "/block=" + juce::String (blockSize);
+
+                    if (auto* result = runBenchmark (name, blockSize, kernel.second))
+                    {
+                        if (instructionSet == juce::FloatVectorOperations::InstructionSet::standard)
+                            standard = result;
+                        else if (standard != nullptr)
+                            setSpeedup (*result, *standard);
+                    }
+                }
+            }
+        }
+
+        juce::FloatVectorOperations::setInstructionSet (originalInstructionSet);
+
+        // The transforms, over the orders the FFT engines are tuned for. The
+        // analysis graph uses order 10 for the onsets and spectrum, 12 for the
+        // bands, chroma and analyser
+        for (int order = 6; order <= 15; ++order)
+        {
+            auto fft = std::make_shared<juce::dsp::FFT> (order);
+            const int size = fft->getSize();
+            auto input = std::make_shared<std::vector<float>> ((size_t) size);
+            auto data = std::make_shared<std::vector<float>> ((size_t) (2 * size));
+            juce::Random random (order);
+
+            for (auto& sample : *input)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            runBenchmark ("dsp::FFT::performRealOnlyForwardTransform/order=" + juce::String (order), size,
+                          [fft, input, data]
+                          {
+                              std::copy (input->begin(), input->end(), data->begin());
+                              fft->performRealOnlyForwardTransform (data->data(), true);
+                          });
+
+            auto complexInput = std::make_shared<std::vector<juce::dsp::Complex<float>>> ((size_t) size);
+            auto complexOutput = std::make_shared<std::vector<juce::dsp::Complex<float>>> ((size_t) size);
+
+            for (auto& sample : *complexInput)
+                sample = { random.nextFloat() * 2.0f - 1.0f, random.nextFloat() * 2.0f - 1.0f };
+
+            runBenchmark ("dsp::FFT::perform/order=" + juce::String (order), size,
+                          [fft, complexInput, complexOutput] { fft->perform (complexInput->data(), complexOutput->data(), false); });
+
+            // Four channels at once, e.g. L, R, M and S
+            constexpr int numChannels = 4;
+            auto channels = std::make_shared<std::vector<std::vector<float>>> (numChannels, std::vector<float> ((size_t) (2 * size)));
+            auto scratch = std::make_shared<std::vector<float>> ((size_t) fft->getBatchScratchSize());
+
+            runBenchmark ("dsp::FFT::performRealOnlyForwardTransformBatch/order=" + juce::String (order) + "/channels=" + juce::String (numChannels),
+                          numChannels * size,
+                          [fft, input, channels, scratch]
+                          {
+                              float* pointers[numChannels];
+
+                              for (int i = 0; i < numChannels; ++i)
+                              {
+                                  auto& channel = (*channels)[(size_t) i];
+                                  std::copy (input->begin(), input->end(), channel.begin());
+                                  pointers[i] = channel.data();
+                              }
+
+                              fft->performRealOnlyForwardTransformBatch (pointers, numChannels, true, scratch->data());
+                          });
+        }
+
+        // The biquad cascades, against an IIR::Filter per lane: a channel of a
+        // block in a ProcessorDuplicator, with the loudness meter's two
+        // stages, or a band of a third-octave bank of fourth order band-passes
+        constexpr int filterBlockSize = 512;
+        constexpr double filterSampleRate = 48000.0;
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+        using Duplicator = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, Coefficients>;
+
+        const Coefficients::Ptr kWeighting[] = { Coefficients::makeHighShelf (filterSampleRate, 1500.0f, 0.71f, 1.58f),
+                                                 Coefficients::makeHighPass (filterSampleRate, 38.0f, 0.5f) };
+
+        for (int numChannels : { 2, 8, 32 })
+        {
+            const auto suffix = "/channels=" + juce::String (numChannels);
+            auto input = std::make_shared<juce::AudioBuffer<float>> (numChannels, filterBlockSize);
+            auto output = std::make_shared<juce::AudioBuffer<float>> (numChannels, filterBlockSize);
+            fillWithNoise (*input);
+
+            auto duplicators = std::make_shared<std::array<Duplicator, 2>>();
+
+            for (size_t stage = 0; stage < duplicators->size(); ++stage)
+            {
+                (*duplicators)[stage].state = kWeighting[stage];
+                (*duplicators)[stage].prepare ({ filterSampleRate, (juce::uint32) filterBlockSize, (juce::uint32) numChannels });
+            }
+
+            auto* duplicated = runBenchmark ("dsp::ProcessorDuplicator<IIR::Filter>::process" + suffix, numChannels * filterBlockSize,
+                                             [duplicators, input, output]
+                                             {
+                                                 juce::dsp::AudioBlock<float> inputBlock (*input), outputBlock (*output);
+                                                 (*duplicators)[0].process (juce::dsp::ProcessContextNonReplacing<float> (inputBlock, outputBlock));
+                                                 (*duplicators)[1].process (juce::dsp::ProcessContextReplacing<float> (outputBlock));
+                                             });
+
+            auto cascade = std::make_shared<juce::dsp::BiquadCascade<float>>();
+            cascade->prepare (numChannels, 2);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int stage = 0; stage < 2; ++stage)
+                    cascade->setCoefficients (ch, stage, *kWeighting[stage]);
+
+            auto* result = runBenchmark ("dsp::BiquadCascade::process" + suffix, numChannels * filterBlockSize,
+                                         [cascade, input, output]
+                                         {
+                                             juce::dsp::AudioBlock<float> inputBlock (*input), outputBlock (*output);
+                                             cascade->process (juce::dsp::ProcessContextNonReplacing<float> (inputBlock, outputBlock));
+                                         });
+
+            if (duplicated != nullptr && result != nullptr)
+                setSpeedup (*result, *duplicated);
+        }
+
+        // The true-peak meter's 4x oversampling of a stereo block, per
+        // sample of each channel
+        {
+            constexpr int numChannels = 2;
+            auto input = std::make_shared<juce::AudioBuffer<float>> (numChannels, filterBlockSize);
+            auto meter = std::make_shared<TruePeakMeter>();
+            fillWithNoise (*input);
+
+            runBenchmark ("TruePeakMeter::process/channels=" + juce::String (numChannels), numChannels * filterBlockSize,
+                          [meter, input] { meter->process (*input, 0, filterBlockSize); });
+        }
+
+        {
+            constexpr int numBands = 31;
+            const auto suffix = "/bands=" + juce::String (numBands);
+            auto input = std::make_shared<std::vector<float>> ((size_t) filterBlockSize);
+            auto outputs = std::make_shared<juce::AudioBuffer<float>> (numBands, filterBlockSize);
+            auto filters = std::make_shared<std::vector<juce::dsp::IIR::Filter<float>>>();
+            auto cascade = std::make_shared<juce::dsp::BiquadCascade<float>>();
+            cascade->prepare (numBands, 2);
+            juce::Random random (numBands);
+
+            for (auto& sample : *input)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            for (int band = 0; band < numBands; ++band)
+            {
+                const auto centre = 20.0f * std::pow (2.0f, (float) band / 3.0f);
+                auto bandPass = Coefficients::makeBandPass (filterSampleRate, centre, 4.3f);
+
+                for (int stage = 0; stage < 2; ++stage)
+                {
+                    filters->emplace_back (bandPass);
+                    cascade->setCoefficients (band, stage, *bandPass);
+                }
+            }
+
+            auto* separate = runBenchmark ("dsp::IIR::Filter::processSample" + suffix, numBands * filterBlockSize,
+                                           [filters, input, outputs]
+                                           {
+                                               for (int band = 0; band < numBands; ++band)
+                                               {
+                                                   auto& first = (*filters)[(size_t) (2 * band)];
+                                                   auto& second = (*filters)[(size_t) (2 * band + 1)];
+                                                   auto* output = outputs->getWritePointer (band);
+
+                                                   for (int i = 0; i < filterBlockSize; ++i)
+                                                       output[i] = second.processSample (first.processSample ((*input)[(size_t) i]));
+                                               }
+                                           });
+
+            auto* result = runBenchmark ("dsp::BiquadCascade::processBank" + suffix, numBands * filterBlockSize,
+                                         [cascade, input, outputs]
+                                         {
+                                             cascade->processBank (input->data(), outputs->getArrayOfWritePointers(), filterBlockSize);
+                                         });
+
+            if (separate != nullptr && result != nullptr)
+                setSpeedup (*result, *separate);
+        }
+
+        // The third-octave bank, against the single 4096 point FFT with 75%
+        // overlap that MultiResolutionAnalyser is measured against: a Hann
+        // window and the magnitudes every 1024 samples
+        {
+            constexpr int fftOrder = 12, fftSize = 1 << fftOrder, hopSize = fftSize / 4;
+            auto input = std::make_shared<std::vector<float>> ((size_t) fftSize);
+            auto frame = std::make_shared<std::vector<float>> ((size_t) (2 * fftSize));
+            auto fft = std::make_shared<juce::dsp::FFT> (fftOrder);
+            auto window = std::make_shared<juce::dsp::WindowingFunction<float>> ((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+            juce::Random random (fftOrder);
+
+            for (auto& sample : *input)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            auto* transformed = runBenchmark ("dsp::FFT::performFrequencyOnlyForwardTransform/order=12/hop=1024", fftSize,
+                                              [input, frame, fft, window]
+                                              {
+                                                  for (int hop = 0; hop < fftSize; hop += hopSize)
+                                                  {
+                                                      std::copy (input->begin(), input->end(), frame->begin());
+                                                      window->multiplyWithWindowingTable (frame->data(), (size_t) fftSize);
+                                                      fft->performFrequencyOnlyForwardTransform (frame->data());
+                                                  }
+                                              });
+
+            auto bank = std::make_shared<FilterBankAnalyser>();
+            bank->prepare (filterSampleRate);
+
+            auto* result = runBenchmark ("FilterBankAnalyser::processSamples/bands=" + juce::String (bank->getNumBands()), fftSize,
+                                         [input, bank] { bank->processSamples (input->data(), fftSize); });
+
+            if (transformed != nullptr && result != nullptr)
+                setSpeedup (*result, *transformed);
+        }
+
+        // ThreadPool with jobs that do next to nothing, so the time per
+        // "sample" is the time per job: added one at a time to the shared
+        // queue as the batch analyser used to, then all at once to the work
+        // stealing queues. The shared queue removes each finished job from the
+        // front of one array, so it only runs the smaller count
+        {
+            using Scheduling = juce::ThreadPool::Scheduling;
+            const int numThreads = juce::SystemStats::getNumCpus();
+            auto sharedPool = std::make_shared<juce::ThreadPool> (numThreads, 0, Scheduling::sharedQueue);
+            auto stealingPool = std::make_shared<juce::ThreadPool> (numThreads, 0, Scheduling::workStealing);
+
+            auto runJobs = [] (juce::ThreadPool& pool, int numJobs, bool addAtOnce)
+            {
+                std::atomic<int> numRemaining { numJobs };
+                juce::WaitableEvent finished;
+
+                auto job = [&numRemaining, &finished]
+                {
+                    if (--numRemaining == 0)
+                        finished.signal();
+                };
+
+                if (addAtOnce)
+                {
+                    pool.addJobs (std::vector<std::function<void()>> ((size_t) numJobs, job));
+                }
+                else
+                {
+                    for (int i = 0; i < numJobs; ++i)
+                        pool.addJob (job);
+                }
+
+                finished.wait();
+            };
+
+            constexpr int numSmallJobs = 10000, numLargeJobs = 1000000;
+            const auto suffix = "/threads=" + juce::String (numThreads) + "/jobs=";
+
+            auto* shared = runBenchmark ("juce::ThreadPool::addJob/sharedQueue" + suffix + juce::String (numSmallJobs), numSmallJobs,
+                                         [sharedPool, runJobs] { runJobs (*sharedPool, numSmallJobs, false); });
+
+            auto* result = runBenchmark ("juce::ThreadPool::addJobs/workStealing" + suffix + juce::String (numSmallJobs), numSmallJobs,
+                                         [stealingPool, runJobs] { runJobs (*stealingPool, numSmallJobs, true); });
+
+            if (shared != nullptr && result != nullptr)
+                setSpeedup (*result, *shared);
+
+            runBenchmark ("juce::ThreadPool::addJobs/workStealing" + suffix + juce::String (numLargeJobs), numLargeJobs,
+                          [stealingPool, runJobs] { runJobs (*stealingPool, numLargeJobs, true); });
+        }
+
+        auto* system = new juce::DynamicObject();
+        system->setProperty ("cpu", juce::SystemStats::getCpuModel());
+        system->setProperty ("numCpus", juce::SystemStats::getNumCpus());
+        system->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+        system->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty ("system", system);
+        result->setProperty ("unit", "ns/sample");
+        result->setProperty ("results", results);
+        return result;
+    }
+
+    /** Compares results with a baseline from an earlier run().
+
+        Adds the baseline median and the relative change to each result that
+        is in the baseline, and lists in regressions those whose median is
+        slower by more than threshold, e.g. 0.1 for 10%.
+     */
+    static void compare (juce::var& current, const juce::var& baseline, double threshold, juce::StringArray& regressions)
+    {
+        std::map<juce::String, double> baselineMedians;
+
+        if (auto* baselineResults = baseline["results"].getArray())
+            for (auto& result : *baselineResults)
+                baselineMedians[result["name"].toString()] = result["median"];
+
+        if (auto* currentResults = current["results"].getArray())
+        {
+            for (auto& result : *currentResults)
+            {
+                const auto name = result["name"].toString();
+                const auto found = baselineMedians.find (name);
+
+                if (found == baselineMedians.end() || found->second <= 0.0)
+                    continue;
+
+                const auto change = (double) result["median"] / found->second - 1.0;
+
+                if (auto* object = result.getDynamicObject())
+                {
+                    object->setProperty ("baselineMedian", found->second);
+                    object->setProperty ("change", change);
+                    object->setProperty ("regression", change > threshold);
+                }
+
+                if (change > threshold)
+                    regressions.add (name + ": " + juce::String (found->second, 3) + " -> "
+                                      + juce::String ((double) result["median"], 3) + " ns/sample (+"
+                                      + juce::String (change * 100.0, 1) + "%)");
+            }
+        }
+    }
+
+private:
+    //==========================================================================
+    static constexpr int ringSize = 16384;
+
+    // Batches shorter than this are mostly timer overhead
+    static constexpr double minBatchSeconds = 50.0e-6;
+    static constexpr int minNumBatches = 20;
+
+    /** Returns the result it adds, or nullptr if the filter skips it. */
+    juce::DynamicObject* runBenchmark (const juce::String& name, int samplesPerCall, std::function<void()> body)
+    {
+        if (options.filter.isNotEmpty() && ! name.containsIgnoreCase (options.filter))
+            return nullptr;
+
+        if (onBenchmarkStarted != nullptr)
+            onBenchmarkStarted (name);
+
+        // Warm up, and find how many calls make a batch
+        int callsPerBatch = 1;
+
+        for (;;)
+        {
+            const auto seconds = timeBatch (body, callsPerBatch);
+
+            if (seconds >= minBatchSeconds || callsPerBatch >= (1 << 24))
+                break;
+
+            callsPerBatch *= 2;
+        }
+
+        std::vector<double> nsPerSample;
+        double elapsed = 0.0;
+
+        while (elapsed < options.secondsPerBenchmark || (int) nsPerSample.size() < minNumBatches)
+        {
+            const auto seconds = timeBatch (body, callsPerBatch);
+            nsPerSample.push_back (seconds * 1.0e9 / ((double) callsPerBatch * samplesPerCall));
+            elapsed += seconds;
+        }
+
+        std::sort (nsPerSample.begin(), nsPerSample.end());
+
+        auto percentile = [&nsPerSample] (double fraction)
+        {
+            return nsPerSample[(size_t) juce::roundToInt (fraction * (double) (nsPerSample.size() - 1))];
+        };
+
+        double sum = 0.0;
+
+        for (auto value : nsPerSample)
+            sum += value;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty ("name", name);
+        result->setProperty ("samplesPerCall", samplesPerCall);
+        result->setProperty ("callsPerBatch", callsPerBatch);
+        result->setProperty ("numBatches", (int) nsPerSample.size());
+        result->setProperty ("min", nsPerSample.front());
+        result->setProperty ("median", percentile (0.5));
+        result->setProperty ("p90", percentile (0.9));
+        result->setProperty ("p99", percentile (0.99));
+        result->setProperty ("mean", sum / (double) nsPerSample.size());
+        results.add (result);
+        return result;
+    }
+
+    static double timeBatch (const std::function<void()>& body, int numCalls)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numCalls; ++i)
+            body();
+
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+    }
+
+    /** Records how many times faster a result is than the one it replaces. */
+    static void setSpeedup (juce::DynamicObject& result, const juce::DynamicObject& baseline)
+    {
+        const double median = result.getProperty ("median");
+        const double baselineMedian = baseline.getProperty ("median");
+
+        if (median > 0.0 && baselineMedian > 0.0)
+            result.setProperty ("speedup", baselineMedian / median);
+    }
+
+    static juce::String getInstructionSetName (juce::FloatVectorOperations::InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case juce::FloatVectorOperations::InstructionSet::avx2:     return "avx2";
+            case juce::FloatVectorOperations::InstructionSet::avx512:   return "avx512";
+            case juce::FloatVectorOperations::InstructionSet::standard: break;
+        }
+
+        return "standard";
+    }
+
+    static void fillWithNoise (juce::AudioBuffer<float>& buffer)
+    {
+        juce::Random random (buffer.getNumSamples());
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    //==========================================================================
+    const Options options;
+    juce::Array<juce::var> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Benchmarks)
+};
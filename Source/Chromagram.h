@@ -0,0 +1,243 @@
+//
+//  Chromagram.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AnalysisGraph.h"
+#include <array>
+#include <vector>
+
+/** Pitch-class (chroma) analysis, with key and chord tracking.
+
+    Each FFT frame from the AnalysisGraph is folded onto the 12 pitch
+    classes through a precomputed sparse matrix: every bin between 65 Hz and
+    5 kHz feeds the pitch class nearest to its frequency, weighted by how
+    close it is to the centre of that semitone. Magnitudes are log-compressed
+    first, so that quiet partials still count.
+
+    Two smoothed copies of the chroma vector are kept. The slow one (about
+    8 s) is correlated with the 24 Krumhansl-Kessler key profiles to find the
+    key, the fast one (about 0.25 s) is matched against the 24 major and
+    minor triads to find the chord. getChordColour() turns the chord into a
+    colour for the visualisers.
+
+    Frames arrive on the graph's thread. The results are atomics, so
+    any thread can poll them.
+ */
+class Chromagram : public AnalysisGraph::Stage
+{
+public:
+    static constexpr int numPitchClasses = 12;
+
+    Chromagram() = default;
+
+    //==========================================================================
+    AnalysisGraph::Request getAnalysisRequest() const override
+    {
+        return { 12, 1024, AnalysisWindow::hann };
+    }
+
+    void processFrame (const FFTFrame& frame) override
+    {
+        if (frame.fftSize != matrixFFTSize || frame.sampleRate != matrixSampleRate)
+            prepareMatrix (frame.fftSize, frame.sampleRate);
+
+        // Time since the last frame, from the stream positions
+        const auto deltaTime = lastPosition >= 0 && frame.position > lastPosition
+                                 ? (double) (frame.position - lastPosition) / frame.sampleRate
+                                 : 0.0;
+        lastPosition = frame.position;
+
+        std::array<float, numPitchClasses> chroma {};
+
+        for (auto& entry : matrix)
+            chroma[(size_t) entry.pitchClass] += entry.weight * std::log1p (compression * frame.magnitudes[entry.bin]);
+
+        float total = 0.0f;
+
+        for (auto value : chroma)
+            total += value;
+
+        // Hold the last reading through silence
+        if (total <= silenceThreshold * (float) matrix.size())
+            return;
+
+        for (auto& value : chroma)
+            value /= total;
+
+        const auto fastAmount = (float) (1.0 - std::exp (-deltaTime / chordTime));
+        const auto slowAmount = (float) (1.0 - std::exp (-deltaTime / keyTime));
+
+        for (size_t i = 0; i < (size_t) numPitchClasses; ++i)
+        {
+            fastChroma[i] += fastAmount * (chroma[i] - fastChroma[i]);
+            slowChroma[i] += slowAmount * (chroma[i] - slowChroma[i]);
+            publishedChroma[i] = fastChroma[i];
+        }
+
+        key = findBestMatch (slowChroma, getKeyProfiles());
+        chord = findBestMatch (fastChroma, getChordTemplates());
+    }
+
+    //==========================================================================
+    /** Smoothed chroma, summing to 1 over the pitch classes (0 = C). */
+    float getChroma (int pitchClass) const noexcept     { return publishedChroma[(size_t) pitchClass].load(); }
+
+    /** The key: 0 to 11 are C major to B major, 12 to 23 C minor to B minor. */
+    int getKey() const noexcept                         { return key.load(); }
+
+    /** The chord, numbered like the keys: triads on each root. */
+    int getChord() const noexcept                       { return chord.load(); }
+
+    static int getRoot (int keyOrChord) noexcept        { return keyOrChord % numPitchClasses; }
+    static bool isMinor (int keyOrChord) noexcept       { return keyOrChord >= numPitchClasses; }
+
+    static juce::String getName (int keyOrChord)
+    {
+        static const char* const names[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+        return juce::String (names[getRoot (keyOrChord)]) + (isMinor (keyOrChord) ? "m" : "");
+    }
+
+    /** A colour for a chord or key. The hue follows the circle of fifths, so
+        related harmonies get neighbouring colours; minor is darker and less
+        saturated than major.
+     */
+    static juce::Colour getColour (int keyOrChord) noexcept
+    {
+        const auto fifths = (getRoot (keyOrChord) * 7) % numPitchClasses;
+        const auto hue = (float) fifths / (float) numPitchClasses;
+
+        return isMinor (keyOrChord) ? juce::Colour::fromHSV (hue, 0.55f, 0.7f, 1.0f)
+                                    : juce::Colour::fromHSV (hue, 0.8f, 1.0f, 1.0f);
+    }
+
+    juce::Colour getChordColour() const noexcept        { return getColour (getChord()); }
+
+private:
+    //==========================================================================
+    struct Entry
+    {
+        int bin;
+        int pitchClass;
+        float weight;
+    };
+
+    using Profiles = std::array<std::array<float, numPitchClasses>, 2 * numPitchClasses>;
+
+    void prepareMatrix (int fftSize, double sampleRate)
+    {
+        matrix.clear();
+
+        const int firstBin = juce::jmax (1, (int) std::ceil (minFrequency * fftSize / sampleRate));
+        const int lastBin = juce::jmin (fftSize / 2, (int) std::floor (maxFrequency * fftSize / sampleRate));
+
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+        {
+            const auto frequency = bin * sampleRate / fftSize;
+            const auto pitch = 69.0 + 12.0 * std::log2 (frequency / 440.0);
+            const auto nearest = std::round (pitch);
+            const auto weight = std::cos (juce::MathConstants<double>::pi * (pitch - nearest));
+
+            matrix.push_back ({ bin, (int) nearest % numPitchClasses, (float) (weight * weight) });
+        }
+
+        matrixFFTSize = fftSize;
+        matrixSampleRate = sampleRate;
+        lastPosition = -1;
+    }
+
+    /** The index of the profile that correlates best with the chroma. */
+    static int findBestMatch (const std::array<float, numPitchClasses>& chroma, const Profiles& profiles) noexcept
+    {
+        const auto mean = 1.0f / numPitchClasses;   // The chroma sums to 1
+        int best = 0;
+        float bestScore = -1.0f;
+
+        for (size_t p = 0; p < profiles.size(); ++p)
+        {
+            float score = 0.0f;
+
+            for (size_t i = 0; i < (size_t) numPitchClasses; ++i)
+                score += (chroma[i] - mean) * profiles[p][i];
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = (int) p;
+            }
+        }
+
+        return best;
+    }
+
+    /** Rotates a major and a minor profile onto every root, with the mean
+        removed, so a dot product with a centred vector is a correlation.
+     */
+    static Profiles makeProfiles (const float (&major)[numPitchClasses], const float (&minor)[numPitchClasses])
+    {
+        Profiles profiles;
+
+        for (int root = 0; root < numPitchClasses; ++root)
+        {
+            for (int mode = 0; mode < 2; ++mode)
+            {
+                const auto& source = mode == 0 ? major : minor;
+                auto& profile = profiles[(size_t) (root + mode * numPitchClasses)];
+                float mean = 0.0f, norm = 0.0f;
+
+                for (auto value : source)
+                    mean += value / numPitchClasses;
+
+                for (int i = 0; i < numPitchClasses; ++i)
+                {
+                    profile[(size_t) ((i + root) % numPitchClasses)] = source[i] - mean;
+                    norm += (source[i] - mean) * (source[i] - mean);
+                }
+
+                for (auto& value : profile)
+                    value /= std::sqrt (norm);
+            }
+        }
+
+        return profiles;
+    }
+
+    static const Profiles& getKeyProfiles()
+    {
+        // Krumhansl & Kessler probe-tone ratings
+        static const float major[] = { 6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f };
+        static const float minor[] = { 6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f };
+        static const Profiles profiles = makeProfiles (major, minor);
+        return profiles;
+    }
+
+    static const Profiles& getChordTemplates()
+    {
+        // Root, third and fifth
+        static const float major[] = { 1, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0 };
+        static const float minor[] = { 1, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0 };
+        static const Profiles templates = makeProfiles (major, minor);
+        return templates;
+    }
+
+    //==========================================================================
+    static constexpr double minFrequency = 65.0, maxFrequency = 5000.0;
+    static constexpr float compression = 100.0f;
+    static constexpr float silenceThreshold = 1.0e-3f;  // Mean compressed magnitude per matrix entry
+    static constexpr double chordTime = 0.25, keyTime = 8.0;
+
+    std::vector<Entry> matrix;
+    int matrixFFTSize = 0;
+    double matrixSampleRate = 0.0;
+    juce::int64 lastPosition = -1;
+
+    std::array<float, numPitchClasses> fastChroma {}, slowChroma {};
+
+    std::array<std::atomic<float>, numPitchClasses> publishedChroma {};
+    std::atomic<int> key { 0 }, chord { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Chromagram)
+};
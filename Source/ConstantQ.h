@@ -0,0 +1,181 @@
+//
+//  ConstantQ.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <complex>
+#include <vector>
+
+/** The frequency axis a spectrum view lays its bins out on.
+ */
+enum class FrequencyAxis
+{
+    linear,     // Plain FFT bins, warped onto a log axis when drawn
+    constantQ   // Log-spaced bins from a ConstantQ transform
+};
+
+/** Constant-Q transform computed from a single FFT frame, using precomputed
+    sparse spectral kernels (Brown & Puckette, "An efficient algorithm for the
+    calculation of a constant Q transform", 1992).
+
+    Every constant-Q bin is a windowed complex exponential whose length is
+    inversely proportional to its frequency. Its FFT is concentrated around a
+    handful of spectral bins, so after thresholding, each bin costs a short
+    complex dot product with the positive half of the FFT of the input frame.
+
+    Kernels are limited to the FFT size, so bins below Q * sampleRate / fftSize
+    get a shorter window (and thus a lower Q) than requested.
+
+    The input frame must not be windowed: the kernels carry their own window.
+ */
+class ConstantQ
+{
+public:
+    ConstantQ() = default;
+
+    /** Precomputes the spectral kernels. This allocates and runs an FFT per
+        bin, so never call it from the audio or rendering thread.
+
+        @param sampleRate       sample rate of the analysed signal
+        @param fftOrder         the FFT size is 2 ^ fftOrder
+        @param minFrequency     centre frequency of the lowest bin
+        @param maxFrequency     upper limit for the centre of the highest bin,
+                                clipped to the Nyquist frequency
+        @param binsPerOctave    number of bins per octave, typically 12 to 48
+     */
+    void prepare (double sampleRate, int fftOrder, float minFrequency, float maxFrequency, int binsPerOctave)
+    {
+        jassert (sampleRate > 0.0 && minFrequency > 0.0f && binsPerOctave > 0);
+
+        fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+        fftSize = fft->getSize();
+
+        const double nyquist = sampleRate / 2.0;
+        const double topFrequency = juce::jmin ((double) maxFrequency, nyquist * 0.95);
+        const double q = 1.0 / (std::pow (2.0, 1.0 / binsPerOctave) - 1.0);
+        const int numBins = juce::jmax (0, (int) std::floor (binsPerOctave * std::log2 (topFrequency / minFrequency)) + 1);
+
+        frequencies.resize ((size_t) numBins);
+        kernelStart.resize ((size_t) numBins);
+        kernelOffset.resize ((size_t) numBins + 1);
+        kernelValues.clear();
+
+        std::vector<std::complex<float>> temporalKernel ((size_t) fftSize), spectralKernel ((size_t) fftSize);
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const double frequency = minFrequency * std::pow (2.0, (double) bin / binsPerOctave);
+            const int length = juce::jlimit (1, fftSize, (int) std::ceil (q * sampleRate / frequency));
+            const int start = (fftSize - length) / 2;
+
+            // Hamming-windowed complex exponential, centred in the frame and
+            // normalised so a sine of amplitude A comes out with magnitude A
+            std::fill (temporalKernel.begin(), temporalKernel.end(), std::complex<float>());
+            double windowSum = 0.0;
+
+            for (int n = 0; n < length; ++n)
+                windowSum += 0.54 - 0.46 * std::cos (juce::MathConstants<double>::twoPi * n / juce::jmax (1, length - 1));
+
+            for (int n = 0; n < length; ++n)
+            {
+                const double window = 0.54 - 0.46 * std::cos (juce::MathConstants<double>::twoPi * n / juce::jmax (1, length - 1));
+                const double phase = juce::MathConstants<double>::twoPi * frequency * (n - length / 2) / sampleRate;
+                temporalKernel[(size_t) (start + n)] = std::polar ((float) (2.0 * window / windowSum), (float) phase);
+            }
+
+            fft->perform (temporalKernel.data(), spectralKernel.data(), false);
+
+            // Only the positive-frequency half matters for real input. Keep
+            // the contiguous run of bins above the threshold.
+            float peak = 0.0f;
+
+            for (int i = 0; i <= fftSize / 2; ++i)
+                peak = juce::jmax (peak, std::abs (spectralKernel[(size_t) i]));
+
+            const float threshold = peak * kernelThreshold;
+            int first = 0, last = fftSize / 2;
+
+            while (first < last && std::abs (spectralKernel[(size_t) first]) < threshold)
+                ++first;
+
+            while (last > first && std::abs (spectralKernel[(size_t) last]) < threshold)
+                --last;
+
+            frequencies[(size_t) bin] = (float) frequency;
+            kernelStart[(size_t) bin] = first;
+            kernelOffset[(size_t) bin] = (int) kernelValues.size();
+
+            // Conjugated and scaled, so applying a kernel is a plain dot product
+            for (int i = first; i <= last; ++i)
+                kernelValues.push_back (std::conj (spectralKernel[(size_t) i]) / (float) fftSize);
+        }
+
+        kernelOffset[(size_t) numBins] = (int) kernelValues.size();
+    }
+
+    /** Applies the kernels to the positive half of a complex spectrum, as
+        returned by juce::dsp::FFT::performRealOnlyForwardTransform().
+
+        @param spectrum     at least (fftSize / 2) + 1 complex bins
+        @param magnitudes   receives getNumBins() values
+     */
+    void applyKernels (const std::complex<float>* spectrum, float* magnitudes) const noexcept
+    {
+        const int numBins = getNumBins();
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto* kernel = kernelValues.data() + kernelOffset[(size_t) bin];
+            const auto* input = spectrum + kernelStart[(size_t) bin];
+            const int length = kernelOffset[(size_t) bin + 1] - kernelOffset[(size_t) bin];
+
+            float re = 0.0f, im = 0.0f;
+
+            for (int i = 0; i < length; ++i)
+            {
+                re += input[i].real() * kernel[i].real() - input[i].imag() * kernel[i].imag();
+                im += input[i].real() * kernel[i].imag() + input[i].imag() * kernel[i].real();
+            }
+
+            magnitudes[bin] = std::sqrt (re * re + im * im);
+        }
+    }
+
+    /** Transforms a frame of raw samples and writes the constant-Q magnitudes.
+
+        @param inputOutputData  2 * getFFTSize() floats, the first half holding
+                                the samples. Used as scratch space.
+        @param magnitudes       receives getNumBins() values
+     */
+    void perform (float* inputOutputData, float* magnitudes) const noexcept
+    {
+        jassert (fft != nullptr);
+
+        fft->performRealOnlyForwardTransform (inputOutputData, true);
+        applyKernels (reinterpret_cast<const std::complex<float>*> (inputOutputData), magnitudes);
+    }
+
+    int getNumBins() const noexcept                 { return (int) frequencies.size(); }
+    int getFFTSize() const noexcept                 { return fftSize; }
+    float getBinFrequency (int bin) const noexcept  { return frequencies[(size_t) bin]; }
+
+    /** Total number of complex multiply-adds per transform, for budgeting. */
+    int getNumKernelCoefficients() const noexcept   { return (int) kernelValues.size(); }
+
+private:
+    // Spectral kernel values below this fraction of the kernel's peak are dropped
+    static constexpr float kernelThreshold = 0.01f;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+
+    std::vector<float> frequencies;
+    std::vector<int> kernelStart;                       // First FFT bin each kernel touches
+    std::vector<int> kernelOffset;                      // Offsets into kernelValues, one extra at the end
+    std::vector<std::complex<float>> kernelValues;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConstantQ)
+};
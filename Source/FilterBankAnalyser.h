@@ -0,0 +1,532 @@
+//
+//  FilterBankAnalyser.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <complex>
+#include <vector>
+
+/** Octave or third-octave band analyser after IEC 61260-1, with the time
+    resolution of a filter bank rather than of an FFT frame.
+
+    Each band is a sixth order Butterworth band-pass (three biquads, the
+    order of a class 1 filter) with base-ten midband frequencies: 31 third
+    octaves from 20 Hz to 20 kHz, or 10 octaves from 31.5 Hz to 16 kHz. Bands
+    whose upper edge lies above the Nyquist frequency are left out.
+
+    The bank is multirate. The input runs through a cascade of 2x decimation
+    stages, and each band is filtered at the lowest rate at which its upper
+    edge is below a quarter of the rate, so most bands run at a fraction of
+    the sample rate. A stage's bands and its decimation low-pass are the
+    lanes of one dsp::BiquadCascade, all fed the same samples, which is why
+    the low-pass costs nothing where it fills a padding lane.
+
+    The level of each band comes from a dsp::BallisticsFilter, peak or RMS,
+    with IEC 61672 exponential time weighting. It is fed every
+    getSamplesPerTick() samples of the input with the mean square or peak of
+    the band over the tick, which leaves the readings unchanged for time
+    constants much longer than a tick.
+
+    At 48 kHz the 31 third-octave bands cost less than the single 4096 point
+    FFT with 75% overlap that MultiResolutionAnalyser is measured against;
+    Benchmarks compares the two.
+
+    Use it like MultiResolutionAnalyser: feed it from the audio thread with
+    addAudioData() and draw it from the message thread with createPath().
+ */
+class FilterBankAnalyser : public juce::Thread
+{
+public:
+    enum class Resolution
+    {
+        octave,
+        thirdOctave
+    };
+
+    using LevelType = juce::dsp::BallisticsFilterLevelCalculationType;
+
+    /** IEC 61672 time constants, in milliseconds. */
+    static constexpr float fastTimeConstant = 125.0f;
+    static constexpr float slowTimeConstant = 1000.0f;
+
+    FilterBankAnalyser() : juce::Thread ("Vizz-FilterBankAnalyser")
+    {
+    }
+
+    ~FilterBankAnalyser() override
+    {
+        stopThread (1000);
+    }
+
+    /** Call these before setupAnalyser() or prepare(). */
+    void setResolution (Resolution newResolution)
+    {
+        jassert (! isThreadRunning());
+        resolution = newResolution;
+    }
+
+    void setLevelType (LevelType newLevelType)
+    {
+        jassert (! isThreadRunning());
+        levelType = newLevelType;
+    }
+
+    void setTimeConstant (float milliseconds)
+    {
+        jassert (! isThreadRunning());
+        timeConstant = milliseconds;
+    }
+
+    void addAudioData (const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels)
+    {
+        if (abstractFifo.getFreeSpace() < buffer.getNumSamples())
+            return;
+
+        int start1, block1, start2, block2;
+        abstractFifo.prepareToWrite (buffer.getNumSamples(), start1, block1, start2, block2);
+        audioFifo.copyFrom (0, start1, buffer.getReadPointer (startChannel), block1);
+        if (block2 > 0)
+            audioFifo.copyFrom (0, start2, buffer.getReadPointer (startChannel, block1), block2);
+
+        for (int channel = startChannel + 1; channel < startChannel + numChannels; ++channel)
+        {
+            if (block1 > 0) audioFifo.addFrom (0, start1, buffer.getReadPointer (channel), block1);
+            if (block2 > 0) audioFifo.addFrom (0, start2, buffer.getReadPointer (channel, block1), block2);
+        }
+        abstractFifo.finishedWrite (block1 + block2);
+        waitForData.signal();
+    }
+
+    /** Designs the bank for a sample rate, sizes the fifo and starts the thread. */
+    void setupAnalyser (int audioFifoSize, double sampleRateToUse)
+    {
+        stopThread (1000);
+        prepare (sampleRateToUse);
+
+        audioFifo.setSize (1, audioFifoSize);
+        abstractFifo.setTotalSize (audioFifoSize);
+
+        startThread (5);
+    }
+
+    /** Designs the bank for a sample rate, without starting the thread. Use it
+        instead of setupAnalyser() to drive the bank with processSamples().
+     */
+    void prepare (double sampleRateToUse)
+    {
+        jassert (sampleRateToUse > 0.0);
+        jassert (! isThreadRunning());
+
+        sampleRate = sampleRateToUse;
+        designBands();
+        designStages();
+
+        const juce::ScopedLock sl (levelLock);
+        levels.assign (bands.size(), 0.0f);
+        bandEdges.clear();
+
+        for (auto& band : bands)
+            bandEdges.push_back ({ band.lowerEdge, band.upperEdge });
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            const int numReady = juce::jmin (abstractFifo.getNumReady(), maxBlockSize);
+
+            if (numReady > 0)
+            {
+                int start1, block1, start2, block2;
+                abstractFifo.prepareToRead (numReady, start1, block1, start2, block2);
+                if (block1 > 0) processSamples (audioFifo.getReadPointer (0, start1), block1);
+                if (block2 > 0) processSamples (audioFifo.getReadPointer (0, start2), block2);
+                abstractFifo.finishedRead (block1 + block2);
+            }
+
+            if (abstractFifo.getNumReady() == 0)
+                waitForData.wait (100);
+        }
+    }
+
+    /** Runs the bank over samples on the calling thread. For offline use,
+        after prepare().
+     */
+    void processSamples (const float* samples, int numSamples)
+    {
+        while (numSamples > 0)
+        {
+            const int count = juce::jmin (numSamples, maxBlockSize);
+            processStage (0, samples, count);
+            samples += count;
+            numSamples -= count;
+        }
+
+        const juce::ScopedLock sl (levelLock);
+
+        for (size_t band = 0; band < bands.size(); ++band)
+            levels[band] = bands[band].level;
+
+        newDataAvailable = true;
+    }
+
+    /** Draws each band as a step across its edges, on the same log axis as
+        the other analysers: ten octaves over the width from minFreq.
+     */
+    void createPath (juce::Path& p, const juce::Rectangle<float> bounds, float minFreq)
+    {
+        const juce::ScopedLock sl (levelLock);
+
+        p.clear();
+        p.preallocateSpace (8 + (int) levels.size() * 6);
+
+        const auto factor = bounds.getWidth() / 10.0f;
+
+        for (size_t band = 0; band < levels.size(); ++band)
+        {
+            const auto left = bounds.getX() + factor * std::log2 (bandEdges[band].getStart() / minFreq);
+            const auto right = bounds.getX() + factor * std::log2 (bandEdges[band].getEnd() / minFreq);
+            const auto y = levelToY (levels[band], bounds);
+
+            if (band == 0)
+                p.startNewSubPath (left, y);
+            else
+                p.lineTo (left, y);
+
+            p.lineTo (right, y);
+        }
+    }
+
+    bool checkForNewData()
+    {
+        auto available = newDataAvailable.load();
+        newDataAvailable.store (false);
+        return available;
+    }
+
+    int getNumBands() const noexcept                        { return (int) bands.size(); }
+    float getBandFrequency (int band) const noexcept        { return bands[(size_t) band].frequency; }
+
+    /** The latest level of a band as a gain, 1 being a full scale sine's peak
+        (or its RMS, for LevelType::RMS).
+     */
+    float getBandLevel (int band) const
+    {
+        const juce::ScopedLock sl (levelLock);
+        return levels[(size_t) band];
+    }
+
+    /** Input samples between two updates of the ballistics. */
+    static constexpr int getSamplesPerTick() noexcept       { return samplesPerTick; }
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int maxBlockSize = 4096;
+    static constexpr int samplesPerTick = 128;
+    static constexpr int numBiquads = 3;
+    static constexpr int framesPerChunk = juce::dsp::BiquadCascade<float>::framesPerChunk;
+
+    struct Band
+    {
+        float frequency, lowerEdge, upperEdge;
+        int stage;
+        float level = 0.0f;     // Written by the analysis thread only
+    };
+
+    /** The bands filtered at one rate, with the decimation low-pass feeding
+        the next stage in the lane after them.
+     */
+    struct Stage
+    {
+        juce::dsp::BiquadCascade<float> filters;
+        juce::dsp::BallisticsFilter<float> ballistics;
+
+        int firstBand = 0, numBands = 0;
+        bool decimates = false;
+        int phase = 0;                      // The next frame to keep, 0 or 1
+
+        int samplesPerTick = 1, samplesInTick = 0;
+
+        juce::HeapBlock<float> storage;
+        float* frames = nullptr;            // framesPerChunk frames of the cascade
+        float* sums = nullptr;              // Per lane, over the current tick
+        float* peaks = nullptr;
+
+        std::vector<float> input;           // Decimated by the stage before
+    };
+
+    //==============================================================================
+    void designBands()
+    {
+        // IEC 61260-1 base-ten midband frequencies, fm = 1000 G^(x / b)
+        const double octaveRatio = std::pow (10.0, 0.3);
+        const int bandsPerOctave = resolution == Resolution::thirdOctave ? 3 : 1;
+        const int first = resolution == Resolution::thirdOctave ? -17 : -5;
+        const int last = resolution == Resolution::thirdOctave ? 13 : 4;
+
+        bands.clear();
+
+        for (int x = first; x <= last; ++x)
+        {
+            const auto frequency = 1000.0 * std::pow (octaveRatio, (double) x / bandsPerOctave);
+            const auto halfBand = std::pow (octaveRatio, 0.5 / bandsPerOctave);
+            const auto upperEdge = frequency * halfBand;
+
+            if (upperEdge >= 0.5 * sampleRate)
+                break;
+
+            // The lowest rate at which the upper edge is below a quarter of it
+            int stage = 0;
+
+            while (upperEdge <= 0.125 * sampleRate / (1 << stage))
+                ++stage;
+
+            bands.push_back ({ (float) frequency, (float) (frequency / halfBand), (float) upperEdge, stage });
+        }
+    }
+
+    void designStages()
+    {
+        stages.clear();
+
+        for (auto& band : bands)
+            while ((int) stages.size() <= band.stage)
+                stages.push_back (std::make_unique<Stage>());
+
+        for (size_t index = 0; index < stages.size(); ++index)
+        {
+            auto& stage = *stages[index];
+            const auto stageRate = sampleRate / (double) (1 << index);
+
+            for (size_t band = bands.size(); band-- > 0;)
+            {
+                if (bands[band].stage == (int) index)
+                {
+                    stage.firstBand = (int) band;
+                    ++stage.numBands;
+                }
+            }
+
+            stage.decimates = index + 1 < stages.size();
+            stage.filters.prepare (stage.numBands + (stage.decimates ? 1 : 0), numBiquads);
+
+            for (int lane = 0; lane < stage.numBands; ++lane)
+            {
+                const auto& band = bands[(size_t) (stage.firstBand + lane)];
+                setBandPass (stage.filters, lane, stageRate, band.lowerEdge, band.upperEdge);
+            }
+
+            // Butterworth low-pass, flat up to the bands of the next stage
+            // and 70 dB down where the decimation would alias onto them
+            if (stage.decimates)
+            {
+                const double qs[] = { 0.5176380902, 0.7071067812, 1.9318516526 };
+
+                for (int biquad = 0; biquad < numBiquads; ++biquad)
+                    stage.filters.setCoefficients (stage.numBands, biquad,
+                                                   *juce::dsp::IIR::Coefficients<float>::makeLowPass (stageRate, (float) (0.18 * stageRate), (float) qs[biquad]));
+            }
+
+            const int numPaddedLanes = stage.filters.getNumPaddedLanes();
+            stage.storage.calloc ((size_t) ((framesPerChunk + 2) * numPaddedLanes) + Register::SIMDNumElements);
+            stage.frames = juce::snapPointerToAlignment (stage.storage.get(), Register::SIMDRegisterSize);
+            stage.sums = stage.frames + framesPerChunk * numPaddedLanes;
+            stage.peaks = stage.sums + numPaddedLanes;
+
+            stage.input.assign ((size_t) (maxBlockSize >> index) + 1, 0.0f);
+            stage.phase = 0;
+
+            stage.samplesPerTick = juce::jmax (1, samplesPerTick >> index);
+            stage.samplesInTick = 0;
+
+            // BallisticsFilter takes 2 pi times the time constant
+            stage.ballistics.setLevelCalculationType (levelType);
+            stage.ballistics.setAttackTime (juce::MathConstants<float>::twoPi * timeConstant);
+            stage.ballistics.setReleaseTime (juce::MathConstants<float>::twoPi * timeConstant);
+
+            if (stage.numBands > 0)
+                stage.ballistics.prepare ({ stageRate / stage.samplesPerTick, 1, (juce::uint32) stage.numBands });
+        }
+    }
+
+    /** Sets the three biquads of a sixth order Butterworth band-pass: the
+        analogue low-pass prototype moved to the band, then the bilinear
+        transform with both edges prewarped.
+     */
+    static void setBandPass (juce::dsp::BiquadCascade<float>& filters, int lane, double rate, double lowerEdge, double upperEdge)
+    {
+        const auto k = 2.0 * rate;
+        const auto w1 = k * std::tan (juce::MathConstants<double>::pi * lowerEdge / rate);
+        const auto w2 = k * std::tan (juce::MathConstants<double>::pi * upperEdge / rate);
+        const auto bandwidth = w2 - w1, centre2 = w1 * w2;
+
+        // Each prototype pole p turns into the poles of s^2 - p B s + w0^2.
+        // The real pole gives one section, the complex pair two
+        const std::complex<double> pole (-0.5, std::sqrt (0.75));
+        const auto root = std::sqrt (pole * pole * bandwidth * bandwidth - 4.0 * centre2);
+        const std::complex<double> poles[] = { 0.5 * (pole * bandwidth + root), 0.5 * (pole * bandwidth - root) };
+
+        // Analogue sections B s / (s^2 + a1 s + a0)
+        const double sections[numBiquads][2] = { { bandwidth, centre2 },
+                                                  { -2.0 * poles[0].real(), std::norm (poles[0]) },
+                                                  { -2.0 * poles[1].real(), std::norm (poles[1]) } };
+
+        for (int biquad = 0; biquad < numBiquads; ++biquad)
+        {
+            const auto a1 = sections[biquad][0], a0 = sections[biquad][1];
+            const auto d0 = k * k + a1 * k + a0;
+
+            filters.setCoefficients (lane, biquad,
+                                     (float) (bandwidth * k / d0), 0.0f, (float) (-bandwidth * k / d0),
+                                     (float) (2.0 * (a0 - k * k) / d0), (float) ((k * k - a1 * k + a0) / d0));
+        }
+    }
+
+    //==============================================================================
+    void processStage (size_t index, const float* input, int numSamples)
+    {
+        auto& stage = *stages[index];
+        const int numPaddedLanes = stage.filters.getNumPaddedLanes();
+        int numDecimated = 0;
+
+        for (int start = 0; start < numSamples; start += framesPerChunk)
+        {
+            const int numFrames = juce::jmin (framesPerChunk, numSamples - start);
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const auto x = Register::expand (input[start + i]);
+
+                for (int lane = 0; lane < numPaddedLanes; lane += (int) Register::SIMDNumElements)
+                    x.copyToRawArray (stage.frames + i * numPaddedLanes + lane);
+            }
+
+            stage.filters.processFrames (stage.frames, numFrames);
+
+            // Every other frame of the low-pass, the phase carrying over
+            // from one chunk to the next
+            if (stage.decimates)
+            {
+                auto* decimated = stages[index + 1]->input.data();
+                int i = stage.phase;
+
+                for (; i < numFrames; i += 2)
+                    decimated[numDecimated++] = stage.frames[i * numPaddedLanes + stage.numBands];
+
+                stage.phase = i - numFrames;
+            }
+
+            accumulate (stage, numFrames);
+        }
+
+        stage.filters.snapToZero();
+
+        if (stage.decimates && numDecimated > 0)
+            processStage (index + 1, stages[index + 1]->input.data(), numDecimated);
+    }
+
+    /** Adds a chunk to the sums of squares or the peaks of the tick,
+        finishing ticks as they fill.
+     */
+    void accumulate (Stage& stage, int numFrames)
+    {
+        for (int frame = 0; frame < numFrames;)
+        {
+            const int count = juce::jmin (numFrames - frame, stage.samplesPerTick - stage.samplesInTick);
+
+            if (levelType == LevelType::RMS)
+                accumulateLanes (stage, frame, count, stage.sums,
+                                 [] (Register sum, Register x) { return sum + x * x; },
+                                 [] (Register a, Register b) { return a + b; });
+            else
+                accumulateLanes (stage, frame, count, stage.peaks,
+                                 [] (Register peak, Register x) { return Register::max (peak, Register::abs (x)); },
+                                 [] (Register a, Register b) { return Register::max (a, b); });
+
+            frame += count;
+            stage.samplesInTick += count;
+
+            if (stage.samplesInTick == stage.samplesPerTick)
+                finishTick (stage);
+        }
+    }
+
+    /** Runs each register of lanes through two accumulators, one for the even
+        frames and one for the odd, which halves the chain of dependent
+        additions (or maxima) that the loop waits on.
+     */
+    template <typename Accumulate, typename Combine>
+    static void accumulateLanes (const Stage& stage, int frame, int count, float* accumulators,
+                                 Accumulate&& accumulateFrame, Combine&& combine)
+    {
+        const int numPaddedLanes = stage.filters.getNumPaddedLanes();
+
+        for (int lane = 0; lane < numPaddedLanes; lane += (int) Register::SIMDNumElements)
+        {
+            auto even = Register::fromRawArray (accumulators + lane);
+            auto odd = Register::expand (0.0f);
+            const auto* samples = stage.frames + frame * numPaddedLanes + lane;
+            int i = 0;
+
+            for (; i + 1 < count; i += 2, samples += 2 * numPaddedLanes)
+            {
+                even = accumulateFrame (even, Register::fromRawArray (samples));
+                odd = accumulateFrame (odd, Register::fromRawArray (samples + numPaddedLanes));
+            }
+
+            if (i < count)
+                even = accumulateFrame (even, Register::fromRawArray (samples));
+
+            combine (even, odd).copyToRawArray (accumulators + lane);
+        }
+    }
+
+    void finishTick (Stage& stage)
+    {
+        for (int lane = 0; lane < stage.numBands; ++lane)
+        {
+            const auto value = levelType == LevelType::RMS ? std::sqrt (stage.sums[lane] / (float) stage.samplesPerTick)
+                                                           : stage.peaks[lane];
+
+            bands[(size_t) (stage.firstBand + lane)].level = stage.ballistics.processSample (lane, value);
+        }
+
+        stage.ballistics.snapToZero();
+
+        const int numPaddedLanes = stage.filters.getNumPaddedLanes();
+        std::fill (stage.sums, stage.sums + numPaddedLanes, 0.0f);
+        std::fill (stage.peaks, stage.peaks + numPaddedLanes, 0.0f);
+        stage.samplesInTick = 0;
+    }
+
+    inline float levelToY (float level, const juce::Rectangle<float> bounds) const
+    {
+        const float infinity = -80.0f;
+        return juce::jmap (juce::Decibels::gainToDecibels (level, infinity),
+                           infinity, 0.0f, bounds.getBottom(), bounds.getY());
+    }
+
+    juce::WaitableEvent waitForData;
+    juce::CriticalSection levelLock;
+
+    Resolution resolution = Resolution::thirdOctave;
+    LevelType levelType = LevelType::RMS;
+    float timeConstant = fastTimeConstant;
+    double sampleRate = 0.0;
+
+    std::vector<Band> bands;
+    std::vector<std::unique_ptr<Stage>> stages;
+    std::vector<float> levels;
+    std::vector<juce::Range<float>> bandEdges;      // A copy of the bands' edges for createPath()
+
+    juce::AbstractFifo abstractFifo        { 48000 };
+    juce::AudioBuffer<float> audioFifo;
+
+    std::atomic<bool> newDataAvailable { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterBankAnalyser)
+};
@@ -0,0 +1,389 @@
+//
+//  Goniometer.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "RingBuffer.h"
+#include <vector>
+
+/** Goniometer (vectorscope) with a phase correlation meter.
+
+    Every stereo sample becomes a point: the mid signal (L + R) goes up, the
+    side signal (R - L) sideways, so a mono signal is a vertical line and
+    out-of-phase content spreads horizontally.
+
+    Points are drawn as additive point sprites into a floating-point
+    framebuffer that is faded every frame, so brightness shows how often the
+    signal visits a spot rather than just whether it did. Only the samples
+    written since the last frame are drawn, interleaved from the two channels
+    of the RingBuffer, in a single draw call: up to maxPointsPerFrame of them.
+    The density is tone mapped onto the screen in a second pass.
+
+    The correlation coefficient of the same samples is computed with
+    FloatVectorOperations reductions, smoothed, and published as an atomic.
+ */
+class Goniometer : public juce::Component,
+                   public juce::OpenGLRenderer
+{
+public:
+    /** The most points drawn in one frame. The ring buffer should be at
+        least twice this size, so reads never overlap the writer.
+     */
+    static constexpr int maxPointsPerFrame = 1 << 17;
+
+    Goniometer (std::shared_ptr<RingBuffer<GLfloat>> ringBufferToUse)
+        : ringBuffer (ringBufferToUse),
+          readBuffer (2, juce::jmin (maxPointsPerFrame, ringBufferToUse->getBufferSize()), juce::AudioBuffer<GLfloat>::AllocationPolicy::aligned),
+          interleavedPoints ((size_t) (2 * readBuffer.getNumSamples()))
+    {
+        openGLContext.setOpenGLVersionRequired (juce::OpenGLContext::OpenGLVersion::openGL3_2);
+        openGLContext.setRenderer (this);
+        openGLContext.attachTo (*this);
+    }
+
+    ~Goniometer() override
+    {
+        openGLContext.setContinuousRepainting (false);
+        openGLContext.detach();
+    }
+
+    void start()    { openGLContext.setContinuousRepainting (true); }
+    void stop()     { openGLContext.setContinuousRepainting (false); }
+
+    /** Phase correlation, smoothed over about 300 ms: +1 for mono, 0 for
+        unrelated channels, -1 for one channel inverted.
+     */
+    float getCorrelation() const noexcept   { return correlation.load(); }
+
+    /** How long a point stays visible, in seconds (the time constant of the
+        fade).
+     */
+    void setPersistence (float seconds)     { persistence = juce::jmax (0.001f, seconds); }
+
+    //==========================================================================
+    void newOpenGLContextCreated() override
+    {
+        fadeProgram = createProgram (quadVertexShader, fadeFragmentShader);
+        pointProgram = createProgram (pointVertexShader, pointFragmentShader);
+        compositeProgram = createProgram (quadVertexShader, compositeFragmentShader);
+
+        auto& ext = openGLContext.extensions;
+        ext.glGenBuffers (1, &quadVBO);
+        ext.glGenBuffers (1, &pointVBO);
+        ext.glGenFramebuffers (1, &densityFBO);
+        glGenTextures (1, &densityTexture);
+
+        const GLfloat quad[] = { -1.0f, -1.0f,   1.0f, -1.0f,   1.0f, 1.0f,   -1.0f, 1.0f };
+        ext.glBindBuffer (GL_ARRAY_BUFFER, quadVBO);
+        ext.glBufferData (GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+        ext.glBindBuffer (GL_ARRAY_BUFFER, 0);
+
+        densityWidth = densityHeight = 0;
+        lastWritePosition = ringBuffer->getWritePosition();
+        lastFrameTime = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    void openGLContextClosing() override
+    {
+        auto& ext = openGLContext.extensions;
+        ext.glDeleteBuffers (1, &quadVBO);
+        ext.glDeleteBuffers (1, &pointVBO);
+        ext.glDeleteFramebuffers (1, &densityFBO);
+        glDeleteTextures (1, &densityTexture);
+
+        fadeProgram.reset();
+        pointProgram.reset();
+        compositeProgram.reset();
+    }
+
+    void renderOpenGL() override
+    {
+        jassert (juce::OpenGLHelpers::isContextActive());
+
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto deltaTime = (float) juce::jlimit (0.0, 0.25, (now - lastFrameTime) * 0.001);
+        lastFrameTime = now;
+
+        const float renderingScale = (float) openGLContext.getRenderingScale();
+        const int width = juce::roundToInt (renderingScale * getWidth());
+        const int height = juce::roundToInt (renderingScale * getHeight());
+
+        if (fadeProgram == nullptr || pointProgram == nullptr || compositeProgram == nullptr
+             || width <= 0 || height <= 0 || ! prepareDensityBuffer (width, height))
+        {
+            juce::OpenGLHelpers::clear (juce::Colours::black);
+            return;
+        }
+
+        const int numPoints = readNewSamples();
+        updateCorrelation (numPoints, deltaTime);
+
+        auto& ext = openGLContext.extensions;
+        glViewport (0, 0, width, height);
+        glEnable (GL_BLEND);
+
+        // Pass 1: fade the accumulated density, then add the new points
+        ext.glBindFramebuffer (GL_FRAMEBUFFER, densityFBO);
+
+        glBlendFunc (GL_ZERO, GL_SRC_COLOR);
+        fadeProgram->use();
+        fadeProgram->setUniform ("decay", deltaTime > 0.0f ? std::exp (-deltaTime / persistence.load()) : 1.0f);
+        drawQuad (*fadeProgram);
+
+        if (numPoints > 0)
+        {
+            // Scaled by the sample rate seen this frame, so brightness does
+            // not depend on the sample rate or the frame rate. At brightness
+            // 1.0, points spread evenly over the view would settle at a
+            // density of 1.0.
+            const auto samplesPerSecond = deltaTime > 0.0f ? numPoints / deltaTime : 48000.0f;
+            const auto pointArea = pointSize * pointSize * renderingScale * renderingScale;
+            const auto intensity = brightness * (float) (width * height) / (samplesPerSecond * persistence.load() * pointArea);
+
+            glBlendFunc (GL_ONE, GL_ONE);
+            glEnable (programPointSize);
+
+            if (juce::OpenGLShaderProgram::getLanguageVersion() < 1.3)
+                glEnable (pointSprite);
+
+            pointProgram->use();
+            pointProgram->setUniform ("pointSize", pointSize * renderingScale);
+            pointProgram->setUniform ("intensity", intensity);
+            drawPoints (*pointProgram, numPoints);
+
+            glDisable (programPointSize);
+        }
+
+        // Pass 2: tone map the density onto the screen
+        ext.glBindFramebuffer (GL_FRAMEBUFFER, openGLContext.getFrameBufferID());
+        glDisable (GL_BLEND);
+
+        ext.glActiveTexture (GL_TEXTURE0);
+        glBindTexture (GL_TEXTURE_2D, densityTexture);
+
+        compositeProgram->use();
+        compositeProgram->setUniform ("density", 0);
+        compositeProgram->setUniform ("resolution", (GLfloat) width, (GLfloat) height);
+        drawQuad (*compositeProgram);
+
+        glBindTexture (GL_TEXTURE_2D, 0);
+    }
+
+    //==========================================================================
+    /** Sums of L * R, L * L and R * R over a block, for the correlation. */
+    static void accumulateProducts (const float* left, const float* right, int numSamples,
+                                    double& sumLR, double& sumLL, double& sumRR) noexcept
+    {
+        sumLR += juce::FloatVectorOperations::dotProduct (left, right, numSamples);
+        sumLL += juce::FloatVectorOperations::sumOfSquares (left, numSamples);
+        sumRR += juce::FloatVectorOperations::sumOfSquares (right, numSamples);
+    }
+
+private:
+    //==========================================================================
+    /** Reads the samples written since the last frame, and returns how many. */
+    int readNewSamples()
+    {
+        const int bufferSize = ringBuffer->getBufferSize();
+        const int writePosition = ringBuffer->getWritePosition();
+        const int numNew = (writePosition - lastWritePosition + bufferSize) % bufferSize;
+        lastWritePosition = writePosition;
+
+        const int numPoints = juce::jmin (numNew, readBuffer.getNumSamples());
+
+        if (numPoints > 0)
+            ringBuffer->readSamples (readBuffer, numPoints);
+
+        return numPoints;
+    }
+
+    void updateCorrelation (int numPoints, float deltaTime)
+    {
+        const double decay = std::exp (-deltaTime / correlationTime);
+        sumLR *= decay;
+        sumLL *= decay;
+        sumRR *= decay;
+
+        if (numPoints > 0)
+            accumulateProducts (readBuffer.getReadPointer (0), readBuffer.getReadPointer (1), numPoints,
+                                sumLR, sumLL, sumRR);
+
+        const double norm = std::sqrt (sumLL * sumRR);
+        correlation = norm > 1.0e-9 ? (float) juce::jlimit (-1.0, 1.0, sumLR / norm) : 0.0f;
+    }
+
+    /** (Re)creates the density texture when the view size changes. */
+    bool prepareDensityBuffer (int width, int height)
+    {
+        if (width == densityWidth && height == densityHeight)
+            return true;
+
+        auto& ext = openGLContext.extensions;
+
+        glBindTexture (GL_TEXTURE_2D, densityTexture);
+        glTexImage2D (GL_TEXTURE_2D, 0, floatTextureFormat, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture (GL_TEXTURE_2D, 0);
+
+        ext.glBindFramebuffer (GL_FRAMEBUFFER, densityFBO);
+        ext.glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, densityTexture, 0);
+        const bool complete = ext.glCheckFramebufferStatus (GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        if (complete)
+        {
+            glViewport (0, 0, width, height);
+            juce::OpenGLHelpers::clear (juce::Colours::transparentBlack);
+            densityWidth = width;
+            densityHeight = height;
+        }
+
+        ext.glBindFramebuffer (GL_FRAMEBUFFER, openGLContext.getFrameBufferID());
+        return complete;
+    }
+
+    void drawQuad (juce::OpenGLShaderProgram& program)
+    {
+        auto& ext = openGLContext.extensions;
+        const juce::OpenGLShaderProgram::Attribute position (program, "position");
+
+        ext.glBindBuffer (GL_ARRAY_BUFFER, quadVBO);
+        ext.glVertexAttribPointer (position.attributeID, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+        ext.glEnableVertexAttribArray (position.attributeID);
+
+        glDrawArrays (GL_TRIANGLE_FAN, 0, 4);
+
+        ext.glDisableVertexAttribArray (position.attributeID);
+        ext.glBindBuffer (GL_ARRAY_BUFFER, 0);
+    }
+
+    /** Interleaves the channels into (left, right) points, uploads them in
+        one go, and draws them as one batch.
+     */
+    void drawPoints (juce::OpenGLShaderProgram& program, int numPoints)
+    {
+        auto& ext = openGLContext.extensions;
+        const juce::OpenGLShaderProgram::Attribute left (program, "left"), right (program, "right");
+        constexpr GLsizei pointBytes = 2 * sizeof (GLfloat);
+
+        juce::FloatVectorOperations::interleave (interleavedPoints.data(), readBuffer.getArrayOfReadPointers(), 2, numPoints);
+
+        ext.glBindBuffer (GL_ARRAY_BUFFER, pointVBO);
+        ext.glBufferData (GL_ARRAY_BUFFER, (GLsizeiptr) numPoints * pointBytes, interleavedPoints.data(), GL_STREAM_DRAW);
+
+        ext.glVertexAttribPointer (left.attributeID, 1, GL_FLOAT, GL_FALSE, pointBytes, nullptr);
+        ext.glVertexAttribPointer (right.attributeID, 1, GL_FLOAT, GL_FALSE, pointBytes, (const GLvoid*) sizeof (GLfloat));
+        ext.glEnableVertexAttribArray (left.attributeID);
+        ext.glEnableVertexAttribArray (right.attributeID);
+
+        glDrawArrays (GL_POINTS, 0, numPoints);
+
+        ext.glDisableVertexAttribArray (left.attributeID);
+        ext.glDisableVertexAttribArray (right.attributeID);
+        ext.glBindBuffer (GL_ARRAY_BUFFER, 0);
+    }
+
+    std::unique_ptr<juce::OpenGLShaderProgram> createProgram (const char* vertexShader, const char* fragmentShader)
+    {
+        auto program = std::make_unique<juce::OpenGLShaderProgram> (openGLContext);
+
+        if (program->addVertexShader (juce::OpenGLHelpers::translateVertexShaderToV3 (vertexShader))
+             && program->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragmentShader))
+             && program->link())
+            return program;
+
+        DBG ("Goniometer shader: " << program->getLastError());
+        return nullptr;
+    }
+
+    //==========================================================================
+    static constexpr const char* quadVertexShader =
+        "attribute vec2 position;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = vec4 (position, 0.0, 1.0);\n"
+        "}\n";
+
+    // Multiplies the framebuffer by decay (blended with GL_ZERO, GL_SRC_COLOR)
+    static constexpr const char* fadeFragmentShader =
+        "uniform float decay;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = vec4 (decay);\n"
+        "}\n";
+
+    // Mid up, side across, scaled so full-scale L or R reaches the edge
+    static constexpr const char* pointVertexShader =
+        "attribute float left;\n"
+        "attribute float right;\n"
+        "uniform float pointSize;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = vec4 (0.5 * (right - left), 0.5 * (left + right), 0.0, 1.0);\n"
+        "    gl_PointSize = pointSize;\n"
+        "}\n";
+
+    static constexpr const char* pointFragmentShader =
+        "uniform float intensity;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 d = 2.0 * gl_PointCoord - 1.0;\n"
+        "    gl_FragColor = vec4 (intensity * max (0.0, 1.0 - dot (d, d)), 0.0, 0.0, 0.0);\n"
+        "}\n";
+
+    static constexpr const char* compositeFragmentShader =
+        "uniform sampler2D density;\n"
+        "uniform vec2 resolution;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 uv = gl_FragCoord.xy / resolution;\n"
+        "    float v = 1.0 - exp (-texture2D (density, uv).r);\n"
+        "\n"
+        // Faint guides: the mono (M) axis and the L and R diagonals
+        "    vec2 p = abs (2.0 * uv - 1.0);\n"
+        "    float guide = 0.08 * max (step (p.x, 1.5 / resolution.x), step (abs (p.x - p.y), 1.5 / resolution.x));\n"
+        "\n"
+        "    vec3 colour = vec3 (0.2, 0.85, 0.6) * v + vec3 (0.8) * v * v * v;\n"
+        "    gl_FragColor = vec4 (colour + vec3 (guide), 1.0);\n"
+        "}\n";
+
+    // Not in every platform's GL headers: GL_RGBA32F, GL_POINT_SPRITE (legacy
+    // contexts only) and GL_PROGRAM_POINT_SIZE, which lets the shader set the size
+    static constexpr GLint floatTextureFormat = 0x8814;
+    static constexpr GLenum pointSprite = 0x8861;
+    static constexpr GLenum programPointSize = 0x8642;
+
+    //==========================================================================
+    juce::OpenGLContext openGLContext;
+
+    std::unique_ptr<juce::OpenGLShaderProgram> fadeProgram, pointProgram, compositeProgram;
+    GLuint quadVBO = 0, pointVBO = 0, densityFBO = 0, densityTexture = 0;
+    int densityWidth = 0, densityHeight = 0;
+
+    std::shared_ptr<RingBuffer<GLfloat>> ringBuffer;
+    juce::AudioBuffer<GLfloat> readBuffer;
+    std::vector<GLfloat> interleavedPoints;
+    int lastWritePosition = 0;
+    double lastFrameTime = 0.0;
+
+    std::atomic<float> persistence { 0.15f };
+    float brightness = 0.05f;
+    float pointSize = 2.0f;
+
+    // Correlation integration time, in seconds
+    static constexpr double correlationTime = 0.3;
+    double sumLR = 0.0, sumLL = 0.0, sumRR = 0.0;
+    std::atomic<float> correlation { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Goniometer)
+};
@@ -0,0 +1,379 @@
+//
+//  LoudnessMeter.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+/** Loudness meter after ITU-R BS.1770-4 and EBU R128 / Tech 3341 / Tech 3342.
+
+    Measures momentary (400 ms), short-term (3 s) and integrated loudness in
+    LUFS, plus the loudness range (LRA) in LU.
+
+    The K-weighting filters (a high shelf followed by a high-pass) are a
+    dsp::BiquadCascade with one lane per channel, so all channels are
+    filtered at once, a chunk of samples per stage. Mean squares are
+    collected in 100 ms blocks: four of them make a 400 ms gating block,
+    thirty a short-term window.
+
+    Integrated loudness and LRA are gated over the whole measurement. Rather
+    than keeping every block, the meter keeps fixed-size histograms of block
+    loudness in 0.01 LU steps (with the exact energy per step), so memory
+    stays constant however long it runs, and two meters can be merged. The
+    gates and the LRA percentiles land on step edges, within 0.01 LU of
+    where they would be with every block kept, well inside the 0.1 LU that
+    Tech 3341 and 3342 allow.
+
+    process() neither allocates nor locks, and the readings are atomics that
+    any thread may poll.
+ */
+class LoudnessMeter
+{
+public:
+    /** The most channels the meter weights. More are ignored. */
+    static constexpr int maxNumChannels = (int) juce::dsp::SIMDRegister<float>::SIMDNumElements;
+
+    /** Readings below this are reported as silence. */
+    static constexpr float minLoudness = -70.0f;
+
+    LoudnessMeter() = default;
+
+    /** Computes the filter coefficients and resets the measurement. */
+    void prepare (double sampleRate, int numChannelsToUse)
+    {
+        jassert (sampleRate > 0.0);
+
+        numChannels = juce::jlimit (0, maxNumChannels, numChannelsToUse);
+        samplesPerBlock = getSamplesPerBlock (sampleRate);
+
+        kWeighting.prepare (numChannels, 2);
+        jassert (numChannels == 0 || kWeighting.getNumPaddedLanes() == numLanes);
+        frameStorage.calloc ((size_t) ((framesPerChunk + 1) * numLanes));
+        frames = juce::snapPointerToAlignment (frameStorage.get(), Register::SIMDRegisterSize);
+
+        // BS.1770 stage 1: high shelf modelling the head
+        {
+            const double f0 = 1681.974450955533, gain = 3.999843853973347, q = 0.7071752369554196;
+            const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const double vh = std::pow (10.0, gain / 20.0);
+            const double vb = std::pow (vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                kWeighting.setCoefficients (ch, 0,
+                                            (float) ((vh + vb * k / q + k * k) / a0),
+                                            (float) (2.0 * (k * k - vh) / a0),
+                                            (float) ((vh - vb * k / q + k * k) / a0),
+                                            (float) (2.0 * (k * k - 1.0) / a0),
+                                            (float) ((1.0 - k / q + k * k) / a0));
+        }
+
+        // BS.1770 stage 2: RLB high-pass
+        {
+            const double f0 = 38.13547087602444, q = 0.5003270373238773;
+            const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const double a0 = 1.0 + k / q + k * k;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                kWeighting.setCoefficients (ch, 1, 1.0f, -2.0f, 1.0f,
+                                            (float) (2.0 * (k * k - 1.0) / a0),
+                                            (float) ((1.0 - k / q + k * k) / a0));
+        }
+
+        reset();
+    }
+
+    /** Starts a new measurement. */
+    void reset()
+    {
+        kWeighting.reset();
+        sumOfSquares = Register (0.0f);
+        samplesInBlock = 0;
+
+        blockEnergies.fill (0.0);
+        blockIndex = 0;
+        numBlocks = 0;
+
+        gatingHistogram.clear();
+        shortTermHistogram.clear();
+
+        momentary = minLoudness;
+        shortTerm = minLoudness;
+        integrated = minLoudness;
+        range = 0.0f;
+    }
+
+    /** Forgets the gated measurement, keeping the filters and the recent
+        blocks. A meter that has run over the audio before a section and is
+        then reset here measures the section as a meter running over the
+        whole programme would, ready to be merged with the sections around
+        it. Reset on a block boundary, see getSamplesPerBlock().
+     */
+    void resetGating()
+    {
+        gatingHistogram.clear();
+        shortTermHistogram.clear();
+
+        integrated = minLoudness;
+        range = 0.0f;
+    }
+
+    /** Measures a block of audio. Call from the audio thread. */
+    void process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        const int channels = juce::jmin (numChannels, buffer.getNumChannels());
+
+        if (channels == 0 || samplesPerBlock == 0)
+            return;
+
+        // A frame holds a sample of each channel, and a chunk never crosses
+        // the end of a block
+        for (int start = 0; start < numSamples;)
+        {
+            const int numFrames = juce::jmin (framesPerChunk, samplesPerBlock - samplesInBlock, numSamples - start);
+
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                const auto* input = buffer.getReadPointer (ch, startSample + start);
+
+                for (int i = 0; i < numFrames; ++i)
+                    frames[i * numLanes + ch] = input[i];
+            }
+
+            // The filters leave their output in the frames, so a channel the
+            // buffer doesn't have would otherwise measure the last chunk again
+            if (channels < numLanes)
+                for (int i = 0; i < numFrames; ++i)
+                    std::fill (frames + i * numLanes + channels, frames + (i + 1) * numLanes, 0.0f);
+
+            kWeighting.processFrames (frames, numFrames);
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const auto y = Register::fromRawArray (frames + i * numLanes);
+                sumOfSquares += y * y;
+            }
+
+            start += numFrames;
+            samplesInBlock += numFrames;
+
+            if (samplesInBlock == samplesPerBlock)
+                finishBlock();
+        }
+
+        kWeighting.snapToZero();
+    }
+
+    /** Merges the gated histograms of another meter, e.g. one that measured
+        a different part of the same programme. The result is the same as if
+        this meter had measured both parts.
+     */
+    void merge (const LoudnessMeter& other)
+    {
+        gatingHistogram.merge (other.gatingHistogram);
+        shortTermHistogram.merge (other.shortTermHistogram);
+        updateGatedReadings();
+    }
+
+    float getMomentaryLoudness() const noexcept     { return momentary.load(); }
+    float getShortTermLoudness() const noexcept     { return shortTerm.load(); }
+    float getIntegratedLoudness() const noexcept    { return integrated.load(); }
+    float getLoudnessRange() const noexcept         { return range.load(); }
+
+    /** The length of the 100 ms blocks the gating works on. */
+    static int getSamplesPerBlock (double sampleRate) noexcept      { return juce::roundToInt (sampleRate * 0.1); }
+
+    /** Seconds of audio the readings depend on, past the gated histograms:
+        the short-term window.
+     */
+    static constexpr double getHistoryLength() noexcept             { return numStoredBlocks * 0.1; }
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    // The cascade pads its frames to a whole register, which holds every channel
+    static constexpr int numLanes = maxNumChannels;
+    static constexpr int framesPerChunk = juce::dsp::BiquadCascade<float>::framesPerChunk;
+
+    //==============================================================================
+    /** Block loudness in 0.01 LU steps, from minLoudness up to +10 LUFS. The
+        bins are on the heap, as a meter may live on a worker thread's stack.
+     */
+    struct Histogram
+    {
+        static constexpr int stepsPerLU = 100;
+        static constexpr int numBins = 80 * stepsPerLU;
+
+        std::vector<uint32_t> counts = std::vector<uint32_t> ((size_t) numBins);
+        std::vector<double> energies = std::vector<double> ((size_t) numBins);
+
+        void clear()
+        {
+            std::fill (counts.begin(), counts.end(), 0u);
+            std::fill (energies.begin(), energies.end(), 0.0);
+        }
+
+        void add (double energy, float loudness)
+        {
+            const int bin = juce::jlimit (0, numBins - 1, (int) ((loudness - minLoudness) * (float) stepsPerLU));
+            ++counts[(size_t) bin];
+            energies[(size_t) bin] += energy;
+        }
+
+        void merge (const Histogram& other)
+        {
+            for (size_t i = 0; i < (size_t) numBins; ++i)
+            {
+                counts[i] += other.counts[i];
+                energies[i] += other.energies[i];
+            }
+        }
+
+        static float binLoudness (int bin)  { return minLoudness + (float) bin / (float) stepsPerLU; }
+
+        /** Mean energy of the blocks at or above a loudness, and their count. */
+        double meanEnergyAbove (float threshold, uint32_t& count) const
+        {
+            double energy = 0.0;
+            count = 0;
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                if (binLoudness (bin) >= threshold)
+                {
+                    count += counts[(size_t) bin];
+                    energy += energies[(size_t) bin];
+                }
+            }
+
+            return count > 0 ? energy / count : 0.0;
+        }
+    };
+
+    static float energyToLoudness (double energy)
+    {
+        return energy > 0.0 ? juce::jmax (minLoudness, (float) (-0.691 + 10.0 * std::log10 (energy))) : minLoudness;
+    }
+
+    double meanOfLastBlocks (int count) const
+    {
+        double energy = 0.0;
+
+        for (int i = 1; i <= count; ++i)
+            energy += blockEnergies[(size_t) ((blockIndex - i + numStoredBlocks) % numStoredBlocks)];
+
+        return energy / count;
+    }
+
+    void finishBlock() noexcept
+    {
+        // Channel weights are all 1.0: the plugin only runs mono or stereo
+        double energy = 0.0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            energy += sumOfSquares.get ((size_t) ch);
+
+        blockEnergies[(size_t) blockIndex] = energy / samplesPerBlock;
+        blockIndex = (blockIndex + 1) % numStoredBlocks;
+        numBlocks = juce::jmin (numBlocks + 1, numStoredBlocks);
+
+        sumOfSquares = Register (0.0f);
+        samplesInBlock = 0;
+
+        // A 400 ms gating block completes every 100 ms (75% overlap)
+        if (numBlocks >= 4)
+        {
+            const auto energy400 = meanOfLastBlocks (4);
+            const auto loudness400 = energyToLoudness (energy400);
+            momentary = loudness400;
+
+            if (loudness400 > minLoudness)
+                gatingHistogram.add (energy400, loudness400);
+        }
+
+        if (numBlocks >= numStoredBlocks)
+        {
+            const auto energy3s = meanOfLastBlocks (numStoredBlocks);
+            const auto loudness3s = energyToLoudness (energy3s);
+            shortTerm = loudness3s;
+
+            if (loudness3s > minLoudness)
+                shortTermHistogram.add (energy3s, loudness3s);
+        }
+
+        updateGatedReadings();
+    }
+
+    void updateGatedReadings() noexcept
+    {
+        // Integrated: absolute gate at -70 LUFS, then relative gate 10 LU
+        // below the loudness of the blocks that passed it
+        uint32_t count = 0;
+        const auto ungated = gatingHistogram.meanEnergyAbove (minLoudness, count);
+
+        if (count > 0)
+            integrated = energyToLoudness (gatingHistogram.meanEnergyAbove (energyToLoudness (ungated) - 10.0f, count));
+
+        // LRA: relative gate 20 LU down, then the spread between the 10th and
+        // 95th percentiles of the short-term loudness
+        const auto ungatedShortTerm = shortTermHistogram.meanEnergyAbove (minLoudness, count);
+
+        if (count > 0)
+        {
+            const auto threshold = energyToLoudness (ungatedShortTerm) - 20.0f;
+            uint32_t gatedCount = 0;
+            shortTermHistogram.meanEnergyAbove (threshold, gatedCount);
+
+            const auto low = (uint32_t) std::floor (0.10 * (gatedCount - 1));
+            const auto high = (uint32_t) std::floor (0.95 * (gatedCount - 1));
+            float lowLoudness = minLoudness, highLoudness = minLoudness;
+            uint32_t seen = 0;
+
+            for (int bin = 0; bin < Histogram::numBins; ++bin)
+            {
+                if (Histogram::binLoudness (bin) < threshold || shortTermHistogram.counts[(size_t) bin] == 0)
+                    continue;
+
+                const auto next = seen + shortTermHistogram.counts[(size_t) bin];
+
+                if (seen <= low && low < next)
+                    lowLoudness = Histogram::binLoudness (bin);
+
+                if (seen <= high && high < next)
+                    highLoudness = Histogram::binLoudness (bin);
+
+                seen = next;
+            }
+
+            range = highLoudness - lowLoudness;
+        }
+    }
+
+    //==============================================================================
+    static constexpr int numStoredBlocks = 30;     // 3 s of 100 ms blocks
+
+    int numChannels = 0;
+    int samplesPerBlock = 0;
+
+    juce::dsp::BiquadCascade<float> kWeighting;
+    juce::HeapBlock<float> frameStorage;
+    float* frames = nullptr;
+    Register sumOfSquares { 0.0f };
+    int samplesInBlock = 0;
+
+    std::array<double, numStoredBlocks> blockEnergies {};
+    int blockIndex = 0;
+    int numBlocks = 0;
+
+    Histogram gatingHistogram, shortTermHistogram;
+
+    std::atomic<float> momentary { minLoudness }, shortTerm { minLoudness },
+                       integrated { minLoudness }, range { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessMeter)
+};
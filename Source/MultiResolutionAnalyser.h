@@ -0,0 +1,413 @@
+/*
+  ==============================================================================
+
+    MultiResolutionAnalyser.h
+    Vizz
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/** Spectrum analyser that runs a different FFT size per frequency band and
+    stitches the bands into one log-spaced spectrum.
+
+    The input is decimated by a cascade of 2x stages, so the low band gets
+    the frequency resolution of a long FFT from a short one. Each band runs
+    its transform whenever its own hop has elapsed: the low band updates
+    rarely with fine resolution, the high band often with coarse resolution.
+
+    With the default bands at 48 kHz (1024 points at 6 kHz below 200 Hz,
+    1024 points at 24 kHz up to 2 kHz, 512 points at 48 kHz above) the
+    resolution matches 8192, 2048 and 512 point FFTs, for about three
+    quarters of the cost of a single 4096 point FFT with 75% overlap. The
+    samples go through a block at a time, each decimator's low-pass is a
+    one-lane dsp::BiquadCascade, and a transform only takes the magnitudes
+    of the bins under its band's points.
+
+    Use it like Analyser: feed it from the audio thread with addAudioData()
+    and draw it from the message thread with createPath().
+*/
+template<typename Type>
+class MultiResolutionAnalyser : public juce::Thread
+{
+public:
+    /** Describes one band of the analyser. */
+    struct Band
+    {
+        float maxFrequency;     // Upper edge of the band, in Hz
+        int decimation;         // Number of 2x decimation stages ahead of the FFT
+        int fftOrder;           // The FFT size is 2 ^ fftOrder, at the decimated rate
+        int hopSize;            // Samples between transforms, at the decimated rate
+    };
+
+    MultiResolutionAnalyser() : juce::Thread ("Vizz-MultiResolutionAnalyser")
+    {
+        setBands ({ {   200.0f, 3, 10, 256 },
+                    {  2000.0f, 1, 10, 512 },
+                    { 24000.0f, 0,  9, 256 } });
+    }
+
+    ~MultiResolutionAnalyser() override
+    {
+        stopThread (1000);
+    }
+
+    /** Replaces the band layout. Bands must be sorted by maxFrequency, and
+        the last one should reach the Nyquist frequency.
+        Call this before setupAnalyser().
+     */
+    void setBands (const std::vector<Band>& newBands)
+    {
+        jassert (! isThreadRunning());
+        jassert (! newBands.empty());
+
+        bands.clear();
+
+        for (auto& layout : newBands)
+        {
+            auto band = std::make_unique<BandState>();
+            band->layout = layout;
+            band->fft = std::make_unique<juce::dsp::FFT> (layout.fftOrder);
+            band->windowing = std::make_unique<juce::dsp::WindowingFunction<Type>> ((size_t) band->fft->getSize(),
+                                                                                    juce::dsp::WindowingFunction<Type>::hann, true);
+            band->history.setSize (1, band->fft->getSize());
+            band->fftBuffer.setSize (1, 2 * band->fft->getSize());
+            band->fftScratch.resize ((size_t) band->fft->getScratchSize());
+            bands.push_back (std::move (band));
+        }
+
+        int numStages = 0;
+
+        for (auto& band : bands)
+            numStages = juce::jmax (numStages, band->layout.decimation);
+
+        decimators.clear();
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            auto decimator = std::make_unique<Decimator>();
+            decimator->filter.prepare (1, 2);
+            decimator->filtered.resize ((size_t) (maxBlockSize >> stage));
+            decimator->output.resize ((size_t) (maxBlockSize >> (stage + 1)) + 1);
+            decimators.push_back (std::move (decimator));
+        }
+    }
+
+    void addAudioData (const juce::AudioBuffer<Type>& buffer, int startChannel, int numChannels)
+    {
+        if (abstractFifo.getFreeSpace() < buffer.getNumSamples())
+            return;
+
+        int start1, block1, start2, block2;
+        abstractFifo.prepareToWrite (buffer.getNumSamples(), start1, block1, start2, block2);
+        audioFifo.copyFrom (0, start1, buffer.getReadPointer (startChannel), block1);
+        if (block2 > 0)
+            audioFifo.copyFrom (0, start2, buffer.getReadPointer (startChannel, block1), block2);
+
+        for (int channel = startChannel + 1; channel < startChannel + numChannels; ++channel)
+        {
+            if (block1 > 0) audioFifo.addFrom (0, start1, buffer.getReadPointer (channel), block1);
+            if (block2 > 0) audioFifo.addFrom (0, start2, buffer.getReadPointer (channel, block1), block2);
+        }
+        abstractFifo.finishedWrite (block1 + block2);
+        waitForData.signal();
+    }
+
+    /** Designs the decimators and output points for a sample rate, sizes the
+        fifo and (re)starts the thread. Call it while addAudioData() cannot
+        run, e.g. from prepareToPlay().
+     */
+    void setupAnalyser (int audioFifoSize, Type sampleRateToUse, int numPointsToUse = 512, float minFrequency = 20.0f)
+    {
+        stopThread (1000);
+
+        sampleRate = sampleRateToUse;
+        audioFifo.setSize (1, audioFifoSize);
+        abstractFifo.setTotalSize (audioFifoSize);
+
+        // Each decimation stage is a 4th order Butterworth low-pass at 80% of
+        // the Nyquist frequency it decimates to
+        for (size_t stage = 0; stage < decimators.size(); ++stage)
+        {
+            const auto stageRate = sampleRate / (Type) (1 << stage);
+            auto& decimator = *decimators[stage];
+
+            decimator.filter.setCoefficients (0, 0, *juce::dsp::IIR::Coefficients<Type>::makeLowPass (stageRate, stageRate * (Type) 0.2, (Type) 0.5412));
+            decimator.filter.setCoefficients (0, 1, *juce::dsp::IIR::Coefficients<Type>::makeLowPass (stageRate, stageRate * (Type) 0.2, (Type) 1.3066));
+            decimator.filter.reset();
+            decimator.phase = 0;
+        }
+
+        for (auto& band : bands)
+        {
+            band->history.clear();
+            band->writePosition = 0;
+            band->samplesUntilHop = band->fft->getSize();
+        }
+
+        // Log-spaced output points, each read from the band that covers it
+        std::vector<Point> newPoints;
+        const auto maxFrequency = (float) sampleRate * 0.5f;
+
+        for (int i = 0; i < numPointsToUse; ++i)
+        {
+            const auto frequency = minFrequency * std::pow (maxFrequency / minFrequency, i / (float) (numPointsToUse - 1));
+            size_t bandIndex = 0;
+
+            while (bandIndex + 1 < bands.size() && frequency > bands[bandIndex]->layout.maxFrequency)
+                ++bandIndex;
+
+            const auto& band = *bands[bandIndex];
+            const auto bandRate = (float) sampleRate / (float) (1 << band.layout.decimation);
+            const auto bin = juce::jlimit (0.0f, (float) (band.fft->getSize() / 2 - 1), frequency * band.fft->getSize() / bandRate);
+
+            newPoints.push_back ({ frequency, (int) bandIndex, bin });
+        }
+
+        // Each band's points are a run, as both go up in frequency
+        for (auto& band : bands)
+            band->firstPoint = band->numPoints = 0;
+
+        for (size_t i = 0; i < newPoints.size(); ++i)
+        {
+            auto& band = *bands[(size_t) newPoints[i].band];
+
+            if (band.numPoints++ == 0)
+                band.firstPoint = (int) i;
+        }
+
+        {
+            // createPath() may be reading the old ones
+            juce::ScopedLock lockedForWriting (pathCreationLock);
+            std::swap (points, newPoints);
+            spectrum.setSize (1, numPointsToUse);
+            spectrum.clear();
+        }
+
+        startThread (5);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            const int numReady = abstractFifo.getNumReady();
+
+            if (numReady > 0)
+            {
+                int start1, block1, start2, block2;
+                abstractFifo.prepareToRead (numReady, start1, block1, start2, block2);
+                if (block1 > 0) processSamples (audioFifo.getReadPointer (0, start1), block1);
+                if (block2 > 0) processSamples (audioFifo.getReadPointer (0, start2), block2);
+                abstractFifo.finishedRead (block1 + block2);
+            }
+
+            if (abstractFifo.getNumReady() == 0)
+                waitForData.wait (100);
+        }
+    }
+
+    void createPath (juce::Path& p, const juce::Rectangle<float> bounds, float minFreq)
+    {
+        p.clear();
+
+        juce::ScopedLock lockedForReading (pathCreationLock);
+
+        // Not set up yet
+        if (points.empty())
+            return;
+
+        p.preallocateSpace (8 + (int) points.size() * 3);
+
+        const auto* data   = spectrum.getReadPointer (0);
+        const auto  factor = bounds.getWidth() / 10.0f;
+
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            const auto x = bounds.getX() + factor * std::log2 (points[i].frequency / minFreq);
+            const auto y = binToY (data [i], bounds);
+
+            if (i == 0)
+                p.startNewSubPath (x, y);
+            else
+                p.lineTo (x, y);
+        }
+    }
+
+    bool checkForNewData()
+    {
+        auto available = newDataAvailable.load();
+        newDataAvailable.store (false);
+        return available;
+    }
+
+    int getNumPoints() const noexcept                   { return (int) points.size(); }
+    float getPointFrequency (int index) const noexcept  { return points[(size_t) index].frequency; }
+
+private:
+    //==============================================================================
+    static constexpr int maxBlockSize = 4096;
+
+    /** The low-pass ahead of a 2x decimation, as the two biquads of a
+        one-lane dsp::BiquadCascade, and the samples it keeps.
+     */
+    struct Decimator
+    {
+        juce::dsp::BiquadCascade<Type> filter;
+        std::vector<Type> filtered;         // A block at the rate it decimates from
+        std::vector<Type> output;           // Every other filtered sample
+        int phase = 0;                      // The next filtered sample to keep, 0 or 1
+    };
+
+    struct BandState
+    {
+        Band layout;
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::unique_ptr<juce::dsp::WindowingFunction<Type>> windowing;
+        juce::AudioBuffer<Type> history;     // Circular, at the decimated rate
+        juce::AudioBuffer<float> fftBuffer;
+        std::vector<float> fftScratch;
+        int writePosition = 0;
+        int samplesUntilHop = 0;
+        int firstPoint = 0, numPoints = 0;  // The output points read from this band
+    };
+
+    struct Point
+    {
+        float frequency;
+        int band;
+        float bin;      // Fractional FFT bin of the band
+    };
+
+    void processSamples (const Type* samples, int numSamples)
+    {
+        while (numSamples > 0)
+        {
+            const int count = juce::jmin (numSamples, maxBlockSize);
+            processStage (0, samples, count);
+            samples += count;
+            numSamples -= count;
+        }
+    }
+
+    /** Pushes a block into every band running at this decimation stage, then
+        hands every other filtered sample down to the next stage.
+     */
+    void processStage (int stage, const Type* samples, int numSamples)
+    {
+        for (size_t b = 0; b < bands.size(); ++b)
+            if (bands[b]->layout.decimation == stage)
+                pushToBand ((int) b, samples, numSamples);
+
+        if (stage >= (int) decimators.size())
+            return;
+
+        auto& decimator = *decimators[(size_t) stage];
+        auto* filtered = decimator.filtered.data();
+
+        const juce::dsp::AudioBlock<const Type> inputBlock (&samples, 1, (size_t) numSamples);
+        juce::dsp::AudioBlock<Type> outputBlock (&filtered, 1, (size_t) numSamples);
+        decimator.filter.process (juce::dsp::ProcessContextNonReplacing<Type> (inputBlock, outputBlock));
+
+        // The phase carries over from one block to the next
+        int numDecimated = 0;
+        int i = decimator.phase;
+
+        for (; i < numSamples; i += 2)
+            decimator.output[(size_t) numDecimated++] = filtered[i];
+
+        decimator.phase = i - numSamples;
+
+        if (numDecimated > 0)
+            processStage (stage + 1, decimator.output.data(), numDecimated);
+    }
+
+    /** Copies a block into a band's history, transforming at each hop. */
+    void pushToBand (int bandIndex, const Type* samples, int numSamples)
+    {
+        auto& band = *bands[(size_t) bandIndex];
+        const int fftSize = band.fft->getSize();
+
+        while (numSamples > 0)
+        {
+            const int count = juce::jmin (numSamples, band.samplesUntilHop, fftSize - band.writePosition);
+            band.history.copyFrom (0, band.writePosition, samples, count);
+            samples += count;
+            numSamples -= count;
+
+            if ((band.writePosition += count) == fftSize)
+                band.writePosition = 0;
+
+            if ((band.samplesUntilHop -= count) == 0)
+            {
+                band.samplesUntilHop = band.layout.hopSize;
+                transformBand (bandIndex);
+            }
+        }
+    }
+
+    void transformBand (int bandIndex)
+    {
+        auto& band = *bands[(size_t) bandIndex];
+        const int fftSize = band.fft->getSize();
+
+        // Unroll the history, oldest sample first, and clear the half of the
+        // buffer that it doesn't fill
+        const int tail = fftSize - band.writePosition;
+        auto* buffer = band.fftBuffer.getWritePointer (0);
+        juce::FloatVectorOperations::copy (buffer, band.history.getReadPointer (0, band.writePosition), tail);
+        juce::FloatVectorOperations::copy (buffer + tail, band.history.getReadPointer (0), band.writePosition);
+        juce::FloatVectorOperations::clear (buffer + fftSize, fftSize);
+
+        band.windowing->multiplyWithWindowingTable (buffer, (size_t) fftSize);
+        band.fft->performRealOnlyForwardTransform (buffer, true, band.fftScratch.data());
+
+        // Only the bins under the band's points are needed, scaled to sine
+        // amplitude so that bands of different sizes line up
+        const auto* bins = reinterpret_cast<const juce::dsp::Complex<float>*> (buffer);
+        const auto scale = 2.0f / (float) fftSize;
+        auto magnitude = [bins, scale] (int bin) { return scale * std::sqrt (std::norm (bins[bin])); };
+
+        juce::ScopedLock lockedForWriting (pathCreationLock);
+        auto* data = spectrum.getWritePointer (0);
+
+        for (int i = band.firstPoint; i < band.firstPoint + band.numPoints; ++i)
+        {
+            const auto& point = points[(size_t) i];
+            const int bin = (int) point.bin;
+            const auto fraction = point.bin - (float) bin;
+            const auto lower = magnitude (bin);
+            data[i] = lower + fraction * (magnitude (bin + 1) - lower);
+        }
+
+        newDataAvailable = true;
+    }
+
+    inline float binToY (float bin, const juce::Rectangle<float> bounds) const
+    {
+        const float infinity = -80.0f;
+        return juce::jmap (juce::Decibels::gainToDecibels (bin, infinity),
+                           infinity, 0.0f, bounds.getBottom(), bounds.getY());
+    }
+
+    juce::WaitableEvent waitForData;
+    juce::CriticalSection pathCreationLock;
+
+    Type sampleRate {};
+
+    std::vector<std::unique_ptr<BandState>> bands;
+    std::vector<std::unique_ptr<Decimator>> decimators;
+    std::vector<Point> points;
+    juce::AudioBuffer<float> spectrum;
+
+    juce::AbstractFifo abstractFifo        { 48000 };
+    juce::AudioBuffer<Type> audioFifo;
+
+    std::atomic<bool> newDataAvailable { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiResolutionAnalyser)
+};
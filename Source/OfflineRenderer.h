@@ -0,0 +1,260 @@
+//
+//  OfflineRenderer.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "RingBuffer.h"
+#include "AnalysisGraph.h"
+#include "OnsetTracker.h"
+#include "Chromagram.h"
+#include "SlidingDFT.h"
+#include "ScopeAnalysis.h"
+#include "ScopeRasteriser.h"
+
+/** Renders the scope for an audio file into a sequence of PNG images, with
+    no GPU and no audio device.
+
+    The file is read through an AudioFormatReader and the analysis is stepped
+    at a fixed frame rate, frame by frame as the plugin would see it, so the
+    same file and options always give the same images. The analysis is cheap
+    next to drawing and compressing the images, so it runs on the calling
+    thread. Each frame is captured as a ScopeFrame, which holds all the state
+    needed to draw it; segments of frames are then drawn and written by a
+    ThreadPool while the analysis moves on.
+ */
+class OfflineRenderer
+{
+public:
+    struct Options
+    {
+        int width = 1280, height = 720;
+        double frameRate = 60.0;
+        int zoom = 2;
+        ScopeAnalysis::AnalysisMode analysisMode = ScopeAnalysis::AnalysisMode::fft;
+
+        int numThreads = juce::SystemStats::getNumCpus();
+        int framesPerSegment = 30;
+
+        /** By default PNGImageFormat tries every row filter at zlib's
+            default level, which takes ten times as long as drawing the
+            frame. Fast compression stores unfiltered rows at level 1, for
+            files about a third larger.
+         */
+        bool fastCompression = true;
+    };
+
+    explicit OfflineRenderer (const Options& optionsToUse) : options (optionsToUse)
+    {
+        jassert (options.width > 0 && options.height > 0 && options.frameRate > 0.0);
+    }
+
+    /** Called now and then on the thread running render(), with the frames
+        written so far.
+     */
+    std::function<void (int numFramesWritten, int numFrames)> onProgress;
+
+    /** Renders the whole file. The images are named frame_000000.png and up,
+        frame n showing the audio up to (n + 1) / frameRate seconds.
+     */
+    juce::Result render (const juce::File& audioFile, const juce::File& outputDirectory)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (audioFile));
+
+        if (reader == nullptr)
+            return juce::Result::fail ("Cannot read " + audioFile.getFullPathName());
+
+        const auto created = outputDirectory.createDirectory();
+
+        if (created.failed())
+            return created;
+
+        const double sampleRate = reader->sampleRate;
+        const int numFrames = (int) ((double) reader->lengthInSamples * options.frameRate / sampleRate);
+
+        // The same stages the editor puts on the graph
+        AnalysisGraph graph;
+        BandLevels bandLevels;
+        OnsetTracker onsetTracker;
+        Chromagram chromagram;
+        graph.addStage (&bandLevels);
+        graph.addStage (&onsetTracker);
+        graph.addStage (&chromagram);
+        graph.prepare (sampleRate);
+
+        SlidingDFT slidingDFT;
+        slidingDFT.setFrequencies (ScopeAnalysis::getSlidingDFTFrequencies());
+        slidingDFT.prepare (sampleRate);
+
+        RingBuffer<float> ringBuffer (2, ScopeAnalysis::ringBufferSize);
+        juce::AudioBuffer<float> readBuffer (2, ScopeAnalysis::ringBufferSize, juce::AudioBuffer<float>::AllocationPolicy::aligned);
+        juce::AudioBuffer<float> block, mono;
+        std::vector<float> current;
+
+        ScopeAnalysis scopeAnalysis;
+        const auto deltaTime = (float) (1.0 / options.frameRate);
+
+        juce::ThreadPool pool (juce::jmax (1, options.numThreads));
+        numFramesWritten = 0;
+        firstError = {};
+
+        std::vector<ScopeFrame> segment;
+        int segmentStart = 0;
+        juce::int64 position = 0;
+
+        for (int frameIndex = 0; frameIndex < numFrames && ! hasFailed(); ++frameIndex)
+        {
+            const auto end = (juce::int64) std::llround ((frameIndex + 1) * sampleRate / options.frameRate);
+            const int numSamples = (int) (end - position);
+
+            block.setSize (2, numSamples, false, false, true);
+            reader->read (&block, 0, numSamples, position, true, true);
+            position = end;
+
+            // The graph takes the sum of the channels, as from the processor
+            mono.setSize (1, numSamples, false, false, true);
+            mono.copyFrom (0, 0, block, 0, 0, numSamples);
+            mono.addFrom (0, 0, block, 1, 0, numSamples);
+            graph.processSamples (mono.getReadPointer (0), numSamples);
+
+            if (options.analysisMode == ScopeAnalysis::AnalysisMode::slidingDFT)
+                slidingDFT.process (block, 0, numSamples);
+
+            // At low frame rates only the newest samples fit in the ring
+            const int numToWrite = juce::jmin (numSamples, ScopeAnalysis::ringBufferSize - 1);
+            ringBuffer.writeSamples (block, numSamples - numToWrite, numToWrite);
+            ringBuffer.readSamples (readBuffer, ScopeAnalysis::ringBufferSize);
+            ScopeAnalysis::downmix (readBuffer, ScopeAnalysis::ringBufferSize, options.zoom, current);
+
+            ScopeAnalysis::Inputs inputs;
+
+            if (options.analysisMode == ScopeAnalysis::AnalysisMode::slidingDFT)
+            {
+                ScopeAnalysis::measureBands (slidingDFT, inputs.warmth, inputs.cool);
+            }
+            else
+            {
+                inputs.warmth = bandLevels.warmth;
+                inputs.cool = bandLevels.cool;
+            }
+
+            inputs.numOnsets = onsetTracker.getNumOnsets();
+            inputs.onsetStrength = onsetTracker.getOnsetStrength();
+            inputs.beatPhase = onsetTracker.getBeatPhase (0.0);
+            inputs.useHarmony = options.analysisMode == ScopeAnalysis::AnalysisMode::chroma;
+            inputs.hasChord = true;
+            inputs.chordColour = chromagram.getChordColour();
+
+            scopeAnalysis.process (current, deltaTime, inputs);
+            segment.push_back (scopeAnalysis.getFrame());
+
+            if ((int) segment.size() == options.framesPerSegment || frameIndex == numFrames - 1)
+            {
+                addSegmentJob (pool, std::move (segment), segmentStart, outputDirectory);
+                segment = {};
+                segmentStart = frameIndex + 1;
+
+                // Keep a few segments queued, not the whole file
+                while (pool.getNumJobs() > 2 * pool.getNumThreads())
+                    waitAndReportProgress (numFrames);
+            }
+        }
+
+        while (pool.getNumJobs() > 0)
+            waitAndReportProgress (numFrames);
+
+        waitAndReportProgress (numFrames);
+
+        if (hasFailed())
+            return juce::Result::fail (firstError);
+
+        return juce::Result::ok();
+    }
+
+    static juce::File getFrameFile (const juce::File& outputDirectory, int frameIndex)
+    {
+        return outputDirectory.getChildFile ("frame_" + juce::String (frameIndex).paddedLeft ('0', 6) + ".png");
+    }
+
+private:
+    //==========================================================================
+    /** Vizz's band measurement, as a stage of its own. */
+    struct BandLevels : public AnalysisGraph::Stage
+    {
+        AnalysisGraph::Request getAnalysisRequest() const override     { return ScopeAnalysis::getBandsRequest(); }
+        void processFrame (const FFTFrame& frame) override              { ScopeAnalysis::measureBands (frame, warmth, cool); }
+
+        float warmth = 0.0f, cool = 0.0f;
+    };
+
+    void addSegmentJob (juce::ThreadPool& pool, std::vector<ScopeFrame>&& frames, int firstFrame, const juce::File& outputDirectory)
+    {
+        auto sharedFrames = std::make_shared<std::vector<ScopeFrame>> (std::move (frames));
+
+        pool.addJob ([this, sharedFrames, firstFrame, outputDirectory]
+        {
+            juce::Image image (juce::Image::RGB, options.width, options.height, false);
+            juce::PNGImageFormat png;
+
+            if (options.fastCompression)
+            {
+                png.setCompressionLevel (1);
+                png.setUsesRowFilters (false);
+            }
+
+            for (size_t i = 0; i < sharedFrames->size() && ! hasFailed(); ++i)
+            {
+                ScopeRasteriser::render ((*sharedFrames)[i], image);
+
+                const auto file = getFrameFile (outputDirectory, firstFrame + (int) i);
+                juce::FileOutputStream stream (file);
+
+                const bool written = stream.openedOk() && stream.setPosition (0) && stream.truncate().wasOk()
+                                       && png.writeImageToStream (image, stream);
+
+                if (! written)
+                {
+                    fail ("Cannot write " + file.getFullPathName());
+                    return;
+                }
+
+                ++numFramesWritten;
+            }
+        });
+    }
+
+    void waitAndReportProgress (int numFrames)
+    {
+        if (onProgress != nullptr)
+            onProgress (numFramesWritten.load(), numFrames);
+
+        juce::Thread::sleep (10);
+    }
+
+    bool hasFailed() const
+    {
+        const juce::ScopedLock sl (errorLock);
+        return firstError.isNotEmpty();
+    }
+
+    void fail (const juce::String& error)
+    {
+        const juce::ScopedLock sl (errorLock);
+
+        if (firstError.isEmpty())
+            firstError = error;
+    }
+
+    //==========================================================================
+    const Options options;
+
+    std::atomic<int> numFramesWritten { 0 };
+    juce::CriticalSection errorLock;
+    juce::String firstError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,312 @@
+//
+//  OnsetTracker.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AnalysisGraph.h"
+#include <vector>
+
+/** Onset detector and beat tracker, run incrementally as an AnalysisGraph
+    stage.
+
+    Every hop (about 10 ms) it computes the half-wave rectified spectral flux
+    of the log-compressed magnitude spectrum: how much energy appeared, summed
+    over the bins where energy rose. A flux peak above an adaptive threshold
+    (a multiple of the recent mean, plus a floor that follows the loudest
+    recent flux) is an onset.
+
+    The flux above its local mean is kept as an onset envelope. Twice a
+    second, its autocorrelation over 60 to 200 BPM, weighted towards 120 BPM,
+    gives the tempo. A phase-locked counter advances by one beat per period
+    and is pulled towards the offset that best lines a comb of beats up with
+    the envelope.
+
+    Register it with the graph's addStage(). The readings are atomics, and
+    getBeatPhase() extrapolates between hops, so a renderer can poll it
+    every frame.
+ */
+class OnsetTracker : public AnalysisGraph::Stage
+{
+public:
+    OnsetTracker() = default;
+
+    //==========================================================================
+    AnalysisGraph::Request getAnalysisRequest() const override
+    {
+        return { 10, 512, AnalysisWindow::hann };
+    }
+
+    void processFrame (const FFTFrame& frame) override
+    {
+        if (frame.fftSize != fftSize || frame.hopSize != hopSize || frame.sampleRate != sampleRate)
+            prepare (frame.fftSize, frame.hopSize, frame.sampleRate);
+
+        // Log-compressed magnitude spectrum, and the flux against the last one
+        const int numBins = fftSize / 2;
+        float frameFlux = 0.0f;
+
+        for (int bin = 1; bin < numBins; ++bin)
+        {
+            const auto magnitude = std::log1p (compression * frame.magnitudes[bin]);
+            frameFlux += juce::jmax (0.0f, magnitude - previousSpectrum[(size_t) bin]);
+            previousSpectrum[(size_t) bin] = magnitude;
+        }
+
+        frameFlux /= (float) numBins;
+        processFlux (frameFlux);
+    }
+
+    //==========================================================================
+    /** Strength of the latest onset, from 0 to 1. */
+    float getOnsetStrength() const noexcept     { return onsetStrength.load(); }
+
+    /** Counts the onsets detected so far; poll it to notice new ones. */
+    int getNumOnsets() const noexcept           { return numOnsets.load(); }
+
+    /** The tempo, or 0 while none has been found. */
+    float getBPM() const noexcept
+    {
+        const auto period = publishedPeriod.load();
+        return period > 0.0f ? 60.0f / period : 0.0f;
+    }
+
+    /** Position within the current beat, from 0 (on the beat) to 1.
+        Stays at 0 while there is no tempo.
+     */
+    float getBeatPhase() const noexcept
+    {
+        return getBeatPhase ((juce::Time::getMillisecondCounterHiRes() - publishedTime.load()) * 0.001);
+    }
+
+    /** The beat phase a given time after the last frame was analysed. Offline
+        callers that step the graph themselves use this, with a time from the
+        stream rather than the clock.
+     */
+    float getBeatPhase (double secondsSinceLastFrame) const noexcept
+    {
+        const auto period = publishedPeriod.load();
+
+        if (period <= 0.0f)
+            return 0.0f;
+
+        const auto beatPhase = publishedPhase.load() + (float) secondsSinceLastFrame / period;
+        return beatPhase - std::floor (beatPhase);
+    }
+
+    /** Seconds of audio the tracker's readings mostly depend on: the onset
+        envelope the tempo is found in.
+     */
+    static constexpr double getHistoryLength() noexcept     { return tempoWindow; }
+
+private:
+    //==========================================================================
+    /** Sizes the state for a frame layout, forgetting the tempo. */
+    void prepare (int newFFTSize, int newHopSize, double newSampleRate)
+    {
+        fftSize = newFFTSize;
+        hopSize = newHopSize;
+        sampleRate = newSampleRate;
+        frameRate = sampleRate / hopSize;
+
+        previousSpectrum.assign ((size_t) (fftSize / 2), 0.0f);
+
+        flux.assign ((size_t) juce::jmax (3, juce::roundToInt (meanTime * frameRate)), 0.0f);
+        envelope.assign ((size_t) juce::roundToInt (tempoWindow * frameRate), 0.0f);
+        autocorrelation.assign ((size_t) lagForBPM (minBPM) + 2, 0.0f);
+        frameIndex = 0;
+        framesSinceOnset = 0;
+        fluxPeak = 0.0f;
+        beatPeriod = 0.0f;
+        phase = 0.0f;
+
+        onsetStrength = 0.0f;
+        publishedPhase = 0.0f;
+        publishedPeriod = 0.0f;
+    }
+
+    void processFlux (float frameFlux)
+    {
+        // Adaptive threshold from the mean of the recent flux
+        const auto numFlux = flux.size();
+        float localMean = 0.0f;
+
+        for (auto f : flux)
+            localMean += f;
+
+        localMean /= (float) numFlux;
+
+        const auto current = frameFlux;
+        const auto previous = flux[(frameIndex + numFlux - 1) % numFlux];
+        const auto beforePrevious = flux[(frameIndex + numFlux - 2) % numFlux];
+        flux[frameIndex % numFlux] = current;
+
+        fluxPeak = juce::jmax (frameFlux, fluxPeak * (float) std::exp (-1.0 / (peakDecayTime * frameRate)));
+        const auto threshold = thresholdRatio * localMean + thresholdFloor * fluxPeak + 1.0e-6f;
+
+        // Peak picking one frame late: the previous frame is an onset if it
+        // beats both neighbours and the threshold
+        ++framesSinceOnset;
+
+        if (previous > threshold && previous > beforePrevious && previous >= current
+             && framesSinceOnset > minOnsetInterval * frameRate)
+        {
+            onsetStrength = juce::jlimit (0.0f, 1.0f, (previous - threshold) / (fluxPeak + 1.0e-6f) * 2.0f);
+            ++numOnsets;
+            framesSinceOnset = 0;
+        }
+
+        // Onset envelope for the tempo: flux above its local mean
+        const auto numEnvelope = envelope.size();
+        envelope[frameIndex % numEnvelope] = juce::jmax (0.0f, frameFlux - localMean);
+        ++frameIndex;
+
+        if (frameIndex >= numEnvelope && frameIndex % (size_t) juce::roundToInt (tempoUpdateTime * frameRate) == 0)
+            updateTempo();
+
+        updatePhase();
+    }
+
+    /** Envelope value a number of frames ago. */
+    float getEnvelope (int framesAgo) const noexcept
+    {
+        const auto size = envelope.size();
+        return envelope[(frameIndex - 1 - (size_t) framesAgo % size + size) % size];
+    }
+
+    int lagForBPM (float bpm) const noexcept     { return juce::roundToInt (60.0 * frameRate / bpm); }
+
+    void updateTempo()
+    {
+        const int minLag = lagForBPM (maxBPM);
+        const int maxLag = lagForBPM (minBPM);
+        const int length = (int) envelope.size();
+        const auto preferredLag = 60.0 * frameRate / preferredBPM;
+
+        float energy = 0.0f;
+
+        for (int i = 0; i < length; ++i)
+            energy += getEnvelope (i) * getEnvelope (i);
+
+        if (energy <= 0.0f)
+            return;
+
+        int bestLag = 0;
+        float bestScore = 0.0f;
+
+        for (int lag = minLag - 1; lag <= maxLag + 1; ++lag)
+        {
+            float sum = 0.0f;
+
+            for (int i = 0; i < length - lag; ++i)
+                sum += getEnvelope (i) * getEnvelope (i + lag);
+
+            autocorrelation[(size_t) lag] = sum / (float) (length - lag);
+        }
+
+        for (int lag = minLag; lag <= maxLag; ++lag)
+        {
+            // Log-Gaussian tempo preference, one octave wide
+            const auto octaves = std::log2 (lag / preferredLag);
+            const auto score = autocorrelation[(size_t) lag] * (float) std::exp (-0.5 * octaves * octaves);
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestLag = lag;
+            }
+        }
+
+        // Too little periodicity: keep the last tempo
+        if (bestLag == 0 || autocorrelation[(size_t) bestLag] < minConfidence * energy / (float) length)
+            return;
+
+        // Parabolic interpolation around the peak
+        const auto left = autocorrelation[(size_t) bestLag - 1];
+        const auto centre = autocorrelation[(size_t) bestLag];
+        const auto right = autocorrelation[(size_t) bestLag + 1];
+        const auto denominator = left - 2.0f * centre + right;
+        const auto offset = denominator < 0.0f ? juce::jlimit (-0.5f, 0.5f, 0.5f * (left - right) / denominator) : 0.0f;
+        const auto period = (float) bestLag + offset;
+
+        // Glide between close estimates, jump to a different tempo
+        beatPeriod = (beatPeriod > 0.0f && std::abs (period - beatPeriod) < 0.1f * beatPeriod)
+                        ? 0.75f * beatPeriod + 0.25f * period
+                        : period;
+    }
+
+    void updatePhase()
+    {
+        if (beatPeriod <= 0.0f)
+            return;
+
+        phase += 1.0f / beatPeriod;
+        phase -= std::floor (phase);
+
+        // The offset whose comb of past beats collects the most onset energy
+        const int period = (int) beatPeriod;
+        int bestOffset = 0;
+        float bestScore = 0.0f;
+
+        for (int offset = 0; offset < period; ++offset)
+        {
+            float score = 0.0f;
+
+            for (int beat = 0; beat < numCombBeats; ++beat)
+                score += getEnvelope (offset + juce::roundToInt ((float) beat * beatPeriod));
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestOffset = offset;
+            }
+        }
+
+        if (bestScore > 0.0f)
+        {
+            auto error = (float) bestOffset / beatPeriod - phase;
+            error -= std::round (error);
+            phase += phaseCorrection * error;
+            phase -= std::floor (phase);
+        }
+
+        publishedPhase = phase;
+        publishedPeriod = beatPeriod / (float) frameRate;
+        publishedTime = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    //==========================================================================
+    static constexpr float compression = 250.0f;        // Log compression of sine amplitudes
+    static constexpr double meanTime = 0.2;             // Window of the local mean, in seconds
+    static constexpr float thresholdRatio = 1.5f;
+    static constexpr float thresholdFloor = 0.1f;       // Fraction of the recent flux peak
+    static constexpr double peakDecayTime = 5.0;
+    static constexpr double minOnsetInterval = 0.05;
+    static constexpr double tempoWindow = 6.0;          // Onset envelope used for the tempo, in seconds
+    static constexpr double tempoUpdateTime = 0.5;
+    static constexpr float minBPM = 60.0f, maxBPM = 200.0f, preferredBPM = 120.0f;
+    static constexpr float minConfidence = 0.1f;
+    static constexpr int numCombBeats = 4;
+    static constexpr float phaseCorrection = 0.1f;
+
+    double sampleRate = 0.0, frameRate = 0.0;
+    int fftSize = 0, hopSize = 0;
+
+    std::vector<float> previousSpectrum;
+
+    std::vector<float> flux, envelope, autocorrelation;
+    size_t frameIndex = 0;
+    int framesSinceOnset = 0;
+    float fluxPeak = 0.0f;
+    float beatPeriod = 0.0f;    // In frames
+    float phase = 0.0f;
+
+    std::atomic<float> onsetStrength { 0.0f };
+    std::atomic<int> numOnsets { 0 };
+    std::atomic<float> publishedPhase { 0.0f }, publishedPeriod { 0.0f };
+    std::atomic<double> publishedTime { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OnsetTracker)
+};
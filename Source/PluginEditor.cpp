@@ -3,28 +3,53 @@
 
 VizzAudioProcessorEditor::VizzAudioProcessorEditor (VizzAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p), //mTextChangesListener(this),
-      ringBuffer(std::make_shared<RingBuffer<GLfloat>>(2, 2048 + 1024)), scope2d(ringBuffer)
+      ringBuffer(std::make_shared<RingBuffer<GLfloat>>(2, ScopeAnalysis::ringBufferSize)),
+      slidingDFT(p.getSlidingDFT()), onsetTracker(std::make_shared<OnsetTracker>()),
+      analysisGraph(p.getAnalysisGraph()), chromagram(std::make_shared<Chromagram>()),
+      scope2d(ringBuffer),
+      goniometerRingBuffer(p.getGoniometerRingBuffer()),
+      goniometer(goniometerRingBuffer)
 
 {
+    scope2d.setSlidingDFT (slidingDFT);
+    scope2d.setOnsetTracker (onsetTracker);
+    scope2d.setAnalysisGraph (analysisGraph);
+    scope2d.setChromagram (chromagram);
+    analysisGraph->addStage (onsetTracker.get());
+    analysisGraph->addStage (chromagram.get());
+    constantQAnalyser.setFrequencyAxis (FrequencyAxis::constantQ);
+    
     addAndMakeVisible(scope2d);
+    scope2d.addChildComponent (spectrumView);
+    addAndMakeVisible(goniometer);
+    addAndMakeVisible(meterLabel);
+    meterLabel.setFont (juce::Font (13.0f));
+    meterLabel.setJustificationType (juce::Justification::centredLeft);
+    meterLabel.addMouseListener (this, false);
   
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (600, 300);
+    setSize (880, 300);
   
     p.addChangeListener (this);
     p.setRingBuffer(ringBuffer);
   
     // This doesn't work for AU
-    setResizeLimits (150, 300, 900, 300);
+    setResizeLimits (430, 300, 1180, 300);
     setResizable (true, true);
   
     scope2d.start();
+    goniometer.start();
+    startTimerHz (10);
 }
 
 VizzAudioProcessorEditor::~VizzAudioProcessorEditor()
 {
     scope2d.stop();
+    goniometer.stop();
+    setAnalysis (-1);
+    analysisGraph->removeStage (onsetTracker.get());
+    analysisGraph->removeStage (chromagram.get());
 
     VizzAudioProcessor& npap = dynamic_cast<VizzAudioProcessor&>(processor);
     npap.removeChangeListener (this);
@@ -38,11 +63,98 @@ void VizzAudioProcessorEditor::paint (juce::Graphics& g)
 
 void VizzAudioProcessorEditor::resized()
 {
-    scope2d.setBounds(0, 0, getWidth(), getHeight());
+    const int goniometerSize = getHeight() - meterHeight;
+    scope2d.setBounds(0, 0, getWidth() - goniometerSize, goniometerSize);
+    spectrumView.setBounds(scope2d.getLocalBounds());
+    goniometer.setBounds(getWidth() - goniometerSize, 0, goniometerSize, goniometerSize);
+    meterLabel.setBounds(0, getHeight() - meterHeight, getWidth(), meterHeight);
 }
 
 void VizzAudioProcessorEditor::changeListenerCallback (juce::ChangeBroadcaster* source)
 {
-    scope2d.setZoom(audioProcessor.zoom->get());
+    scope2d.setZoom(audioProcessor.zoom->get());
+    setAnalysis (audioProcessor.analysis->getIndex());
     repaint();
 }
+
+void VizzAudioProcessorEditor::setAnalysis (int index)
+{
+    if (index == analysisIndex)
+        return;
+    
+    // The spectrum modes colour the scope like the FFT mode, and draw their
+    // trace over it
+    const Vizz::AnalysisMode modes[] = { Vizz::AnalysisMode::fft, Vizz::AnalysisMode::slidingDFT, Vizz::AnalysisMode::chroma,
+                                         Vizz::AnalysisMode::fft, Vizz::AnalysisMode::fft, Vizz::AnalysisMode::fft };
+    
+    if (analysisIndex == 3)
+        analysisGraph->removeStage (&constantQAnalyser);
+    
+    analysisIndex = index;
+    
+    if (index < 0)
+    {
+        spectrumView.setSource<Analyser<float>> (nullptr);
+        return;
+    }
+    
+    scope2d.setAnalysisMode (modes[index]);
+    
+    if (index == 3)
+    {
+        analysisGraph->addStage (&constantQAnalyser);
+        spectrumView.setSource (&constantQAnalyser);
+    }
+    else if (index == 4)
+    {
+        spectrumView.setSource (&audioProcessor.getMultiResolutionAnalyser());
+    }
+    else if (index == 5)
+    {
+        spectrumView.setSource (&audioProcessor.getFilterBankAnalyser());
+    }
+    else
+    {
+        spectrumView.setSource<Analyser<float>> (nullptr);
+    }
+    
+    spectrumView.setVisible (spectrumView.hasSource());
+}
+
+void VizzAudioProcessorEditor::timerCallback()
+{
+    if (showProfile)
+    {
+        meterLabel.setText (audioProcessor.getProfiler().getSummary(), juce::dontSendNotification);
+        return;
+    }
+    
+    auto& loudness = audioProcessor.getLoudnessMeter();
+    auto format = [] (float lufs) { return lufs > LoudnessMeter::minLoudness ? juce::String (lufs, 1) : juce::String ("-inf"); };
+    
+    meterLabel.setText ("M " + format (loudness.getMomentaryLoudness())
+                        + "   S " + format (loudness.getShortTermLoudness())
+                        + "   I " + format (loudness.getIntegratedLoudness()) + " LUFS"
+                        + "   LRA " + juce::String (loudness.getLoudnessRange(), 1) + " LU"
+                        + "   TP " + juce::Decibels::toString (audioProcessor.getTruePeakMeter().getMaxPeakDecibels(), 1, -100.0f, false) + " dBTP"
+                        + "   Corr " + juce::String (goniometer.getCorrelation(), 2)
+                        + "   " + juce::String (onsetTracker->getBPM(), 0) + " BPM"
+                        + "   Key " + Chromagram::getName (chromagram->getKey())
+                        + "   Chord " + Chromagram::getName (chromagram->getChord()),
+                        juce::dontSendNotification);
+}
+
+void VizzAudioProcessorEditor::mouseDown (const juce::MouseEvent& event)
+{
+    if (event.eventComponent != &meterLabel)
+        return;
+    
+    if (event.mods.isShiftDown())
+    {
+        juce::SystemClipboard::copyTextToClipboard (audioProcessor.getProfiler().toString());
+        return;
+    }
+    
+    showProfile = ! showProfile;
+    timerCallback();
+}
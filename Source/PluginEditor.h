@@ -3,8 +3,11 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "Vizz.h"
+#include "Goniometer.h"
+#include "Analyser.h"
+#include "SpectrumView.h"
 
-class VizzAudioProcessorEditor  : public juce::AudioProcessorEditor, juce::ChangeListener
+class VizzAudioProcessorEditor  : public juce::AudioProcessorEditor, juce::ChangeListener, juce::Timer
 {
 public:
     VizzAudioProcessorEditor (VizzAudioProcessor&);
@@ -15,6 +18,9 @@ public:
     void resized() override;
 
     void changeListenerCallback (juce::ChangeBroadcaster* source) override;
+    void timerCallback() override;
+    void mouseDown (const juce::MouseEvent& event) override;
+    void setAnalysis (int index);
 
     std::shared_ptr<RingBuffer<GLfloat>> getRingBuffer() { return ringBuffer; }
   
@@ -24,8 +30,27 @@ private:
     VizzAudioProcessor& audioProcessor;
   
     std::shared_ptr<RingBuffer<GLfloat>> ringBuffer;
+    std::shared_ptr<SlidingDFT> slidingDFT;
+    std::shared_ptr<OnsetTracker> onsetTracker;
+    std::shared_ptr<AnalysisGraph> analysisGraph;
+    std::shared_ptr<Chromagram> chromagram;
     Vizz scope2d;
     
+    // Spectrum trace over the scope, for the analysis modes that draw one
+    Analyser<float> constantQAnalyser;
+    SpectrumView spectrumView;
+    int analysisIndex = -1;
+    
+    // Stereo view, square, to the right of the scope
+    std::shared_ptr<RingBuffer<GLfloat>> goniometerRingBuffer;
+    Goniometer goniometer;
+    
+    // Meter readings, in a strip below the scope. Clicking it switches to
+    // the audio thread's profile, shift-clicking copies the full profile
+    juce::Label meterLabel;
+    static constexpr int meterHeight = 20;
+    bool showProfile = false;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VizzAudioProcessorEditor)
 };
 
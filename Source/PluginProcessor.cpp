@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "ScopeAnalysis.h"
 
 //==============================================================================
 VizzAudioProcessor::VizzAudioProcessor()
@@ -19,10 +20,15 @@ VizzAudioProcessor::VizzAudioProcessor()
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       ), zoom(new juce::AudioParameterInt("zoom", "Zoom", 1, 4, 2))
+                       ), zoom(new juce::AudioParameterInt("zoom", "Zoom", 1, 4, 2)),
+                          analysis(new juce::AudioParameterChoice("analysis", "Analysis", { "FFT", "Sliding DFT", "Chroma", "Constant-Q", "Multi-resolution", "Filter bank" }, 0))
 #endif
-{
-    addParameter (zoom);
+{
+    goniometerRingBuffer = std::make_shared<RingBuffer<GLfloat>> (2, 2 * Goniometer::maxPointsPerFrame);
+    slidingDFT->setFrequencies (ScopeAnalysis::getSlidingDFTFrequencies());
+    
+    addParameter (zoom);
+    addParameter (analysis);
 }
 
 VizzAudioProcessor::~VizzAudioProcessor()
@@ -97,6 +103,14 @@ void VizzAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    slidingDFT->prepare (sampleRate);
+    analysisGraph->setup (sampleRate);
+
+    loudnessMeter.prepare (sampleRate, getTotalNumInputChannels());
+    truePeakMeter.reset();
+    multiResolutionAnalyser.setupAnalyser (juce::roundToInt (sampleRate), (float) sampleRate);
+    filterBankAnalyser.setupAnalyser (juce::roundToInt (sampleRate), sampleRate);
+    profiler.prepare (sampleRate, samplesPerBlock);
 }
 
 void VizzAudioProcessor::releaseResources()
@@ -134,6 +148,7 @@ bool VizzAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
 void VizzAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const ProcessorProfiler::ScopedBlock profileBlock (profiler, buffer.getNumSamples());
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -159,10 +174,49 @@ void VizzAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
         // ..do something to the data...
     }*/
   
-    if (ringBuffer != nullptr) {
-        ringBuffer->writeSamples (buffer, 0, buffer.getNumSamples());
-        sendChangeMessage();
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::loudnessMeter);
+        loudnessMeter.process (buffer, 0, buffer.getNumSamples());
     }
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::truePeakMeter);
+        truePeakMeter.process (buffer, 0, buffer.getNumSamples());
+    }
+  
+    if (analysis->getIndex() == 1)
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::slidingDFT);
+        slidingDFT->process (buffer, 0, buffer.getNumSamples());
+    }
+  
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::analysisGraph);
+        analysisGraph->addAudioData (buffer, 0, juce::jmin (2, totalNumInputChannels));
+    }
+  
+    if (analysis->getIndex() == 4)
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::spectrumAnalyser);
+        multiResolutionAnalyser.addAudioData (buffer, 0, juce::jmin (2, totalNumInputChannels));
+    }
+  
+    if (analysis->getIndex() == 5)
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::spectrumAnalyser);
+        filterBankAnalyser.addAudioData (buffer, 0, juce::jmin (2, totalNumInputChannels));
+    }
+  
+    {
+        const ProcessorProfiler::ScopedStage profileStage (profiler, ProcessorProfiler::ringBuffers);
+        
+        goniometerRingBuffer->writeSamples (buffer, 0, buffer.getNumSamples());
+        
+        if (ringBuffer != nullptr)
+            ringBuffer->writeSamples (buffer, 0, buffer.getNumSamples());
+    }
+  
+    if (ringBuffer != nullptr)
+        sendChangeMessage();
 }
 
 //==============================================================================
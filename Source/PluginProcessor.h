@@ -10,6 +10,13 @@
 
 #include <JuceHeader.h>
 #include "RingBuffer.h"
+#include "SlidingDFT.h"
+#include "AnalysisGraph.h"
+#include "MultiResolutionAnalyser.h"
+#include "FilterBankAnalyser.h"
+#include "LoudnessMeter.h"
+#include "TruePeakMeter.h"
+#include "ProcessorProfiler.h"
 
 //==============================================================================
 /**
@@ -56,10 +63,31 @@ public:
 
     void setRingBuffer(std::shared_ptr<RingBuffer<GLfloat>> ringBuffer) { this->ringBuffer = ringBuffer; }
     
+    // One of each for the processor's lifetime, so that no editor can swap
+    // them out from under processBlock()
+    std::shared_ptr<RingBuffer<GLfloat>> getGoniometerRingBuffer() const { return goniometerRingBuffer; }
+    std::shared_ptr<SlidingDFT> getSlidingDFT() const { return slidingDFT; }
+    std::shared_ptr<AnalysisGraph> getAnalysisGraph() const { return analysisGraph; }
+    
+    const LoudnessMeter& getLoudnessMeter() const { return loudnessMeter; }
+    const TruePeakMeter& getTruePeakMeter() const { return truePeakMeter; }
+    const ProcessorProfiler& getProfiler() const { return profiler; }
+    MultiResolutionAnalyser<float>& getMultiResolutionAnalyser() { return multiResolutionAnalyser; }
+    FilterBankAnalyser& getFilterBankAnalyser() { return filterBankAnalyser; }
+    
     juce::AudioParameterInt* zoom;
+    juce::AudioParameterChoice* analysis;   // 0: FFT, 1: Sliding DFT, 2: Chroma, 3: Constant-Q, 4: Multi-resolution, 5: Filter bank
 
 private:
     std::shared_ptr<RingBuffer<GLfloat>> ringBuffer;
+    std::shared_ptr<RingBuffer<GLfloat>> goniometerRingBuffer;    // Created in the constructor, never replaced
+    const std::shared_ptr<SlidingDFT> slidingDFT { std::make_shared<SlidingDFT>() };
+    const std::shared_ptr<AnalysisGraph> analysisGraph { std::make_shared<AnalysisGraph>() };
+    LoudnessMeter loudnessMeter;
+    TruePeakMeter truePeakMeter;
+    MultiResolutionAnalyser<float> multiResolutionAnalyser;
+    FilterBankAnalyser filterBankAnalyser;
+    ProcessorProfiler profiler;
   
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VizzAudioProcessor)
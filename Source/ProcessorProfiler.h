@@ -0,0 +1,375 @@
+//
+//  ProcessorProfiler.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <array>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+/** Always-on timing of the stages of VizzAudioProcessor::processBlock().
+
+    Each stage is timed with the CPU's cycle counter (the time stamp counter
+    on Intel, the high resolution clock elsewhere) into a histogram of
+    fixed, log-spaced buckets: four per octave, so a percentile read from it
+    is within 25% of the true one. The whole block is also recorded as a
+    fraction of its deadline, numSamples / sampleRate, in 1% buckets, and a
+    block that misses its deadline counts as an overrun. An
+    AudioProcessLoadMeasurer gives the smoothed load, as hosts report it.
+
+    The audio thread is the only writer. It does a relaxed load and store
+    per reading and never allocates or locks. Any other thread can read
+    the histograms at any time, and may see a reading half added, which
+    does not matter for statistics.
+ */
+class ProcessorProfiler
+{
+public:
+    enum Stage
+    {
+        loudnessMeter,
+        truePeakMeter,
+        slidingDFT,
+        analysisGraph,
+        spectrumAnalyser,
+        ringBuffers,
+        wholeBlock,
+        numStages
+    };
+
+    static const char* getStageName (int stage) noexcept
+    {
+        static const char* const names[] = { "Loudness", "True peak", "Sliding DFT", "Analysis graph", "Spectrum", "Ring buffers", "Block" };
+        return names[stage];
+    }
+
+    ProcessorProfiler() = default;
+
+    /** Starts a new profile. Call before the audio thread runs. */
+    void prepare (double sampleRateToUse, int maximumBlockSize)
+    {
+        sampleRate = sampleRateToUse;
+        loadMeasurer.reset (sampleRate, maximumBlockSize);
+
+        for (auto& histogram : stageHistograms)
+            histogram.clear();
+
+        loadHistogram.clear();
+        numOverruns.store (0, std::memory_order_relaxed);
+
+        calibrationTicks = getTicks();
+        calibrationTime = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    //==========================================================================
+    /** Times a stage for as long as it lives. Audio thread only. */
+    class ScopedStage
+    {
+    public:
+        ScopedStage (ProcessorProfiler& profilerToUse, Stage stageToTime) noexcept
+            : profiler (profilerToUse), stage (stageToTime), start (getTicks()) {}
+
+        ~ScopedStage() noexcept     { profiler.stageHistograms[(size_t) stage].add (getTicks() - start); }
+
+    private:
+        ProcessorProfiler& profiler;
+        const Stage stage;
+        const juce::uint64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedStage)
+    };
+
+    /** Times a whole block against its deadline for as long as it lives.
+        Audio thread only.
+     */
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock (ProcessorProfiler& profilerToUse, int numSamplesToUse) noexcept
+            : profiler (profilerToUse), numSamples (numSamplesToUse), timer (profilerToUse.loadMeasurer),
+              startTime (juce::Time::getHighResolutionTicks()), start (getTicks()) {}
+
+        ~ScopedBlock() noexcept
+        {
+            profiler.stageHistograms[wholeBlock].add (getTicks() - start);
+
+            if (profiler.sampleRate > 0.0 && numSamples > 0)
+            {
+                const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTime);
+                const auto load = seconds * profiler.sampleRate / numSamples;
+                profiler.loadHistogram.add (load);
+
+                if (load > 1.0)
+                    profiler.numOverruns.store (profiler.numOverruns.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        ProcessorProfiler& profiler;
+        const int numSamples;
+        juce::AudioProcessLoadMeasurer::ScopedTimer timer;
+        const juce::int64 startTime;
+        const juce::uint64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    //==========================================================================
+    struct StageStatistics
+    {
+        juce::uint64 numReadings = 0;
+        double mean = 0.0, median = 0.0, p99 = 0.0, worst = 0.0;     // Microseconds
+        double meanCycles = 0.0, worstCycles = 0.0;
+    };
+
+    /** The readings of a stage so far. */
+    StageStatistics getStageStatistics (int stage) const
+    {
+        const auto& histogram = stageHistograms[(size_t) stage];
+        const auto microsecondsPerTick = 1.0e6 / getTicksPerSecond();
+
+        StageStatistics statistics;
+        statistics.numReadings = histogram.getNumReadings();
+
+        if (statistics.numReadings == 0)
+            return statistics;
+
+        statistics.meanCycles = (double) histogram.total.load (std::memory_order_relaxed) / (double) statistics.numReadings;
+        statistics.worstCycles = (double) histogram.worst.load (std::memory_order_relaxed);
+        statistics.mean = statistics.meanCycles * microsecondsPerTick;
+        statistics.median = histogram.getPercentile (0.5) * microsecondsPerTick;
+        statistics.p99 = histogram.getPercentile (0.99) * microsecondsPerTick;
+        statistics.worst = statistics.worstCycles * microsecondsPerTick;
+        return statistics;
+    }
+
+    /** The fraction of the deadline blocks take, at a percentile. */
+    double getLoadPercentile (double fraction) const    { return loadHistogram.getPercentile (fraction); }
+
+    /** The smoothed load, as a proportion of the prepared block size's
+        deadline.
+     */
+    double getLoad() const                              { return loadMeasurer.getLoadAsProportion(); }
+
+    /** Blocks that took longer than their own deadline. */
+    juce::uint64 getNumOverruns() const noexcept        { return numOverruns.load (std::memory_order_relaxed); }
+
+    /** One line, for the editor's overlay. */
+    juce::String getSummary() const
+    {
+        const auto block = getStageStatistics (wholeBlock);
+
+        return "DSP " + juce::String (100.0 * getLoad(), 1) + "%"
+                + "   p99 " + juce::String (100.0 * getLoadPercentile (0.99), 1) + "%"
+                + "   worst " + juce::String (block.worst, 1) + " us"
+                + "   overruns " + juce::String ((juce::int64) getNumOverruns())
+                + "   " + juce::String ((juce::int64) block.numReadings) + " blocks";
+    }
+
+    /** A table of every stage, for pasting into a bug report. */
+    juce::String toString() const
+    {
+        juce::String text;
+        text << "Vizz audio thread, " << juce::roundToInt (sampleRate) << " Hz, "
+             << juce::roundToInt (getTicksPerSecond() * 1.0e-6) << " ticks/us" << juce::newLine
+             << "Load " << juce::String (100.0 * getLoad(), 1) << "% (smoothed), "
+             << "median " << juce::String (100.0 * getLoadPercentile (0.5), 1) << "%, "
+             << "p99 " << juce::String (100.0 * getLoadPercentile (0.99), 1) << "%, "
+             << "overruns " << (juce::int64) getNumOverruns() << juce::newLine
+             << juce::newLine
+             << "Stage            Blocks       Mean     Median        p99      Worst   Mean cycles" << juce::newLine;
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            const auto statistics = getStageStatistics (stage);
+
+            text << juce::String (getStageName (stage)).paddedRight (' ', 15)
+                 << juce::String ((juce::int64) statistics.numReadings).paddedLeft (' ', 8)
+                 << juce::String (statistics.mean, 2).paddedLeft (' ', 11)
+                 << juce::String (statistics.median, 2).paddedLeft (' ', 11)
+                 << juce::String (statistics.p99, 2).paddedLeft (' ', 11)
+                 << juce::String (statistics.worst, 2).paddedLeft (' ', 11)
+                 << juce::String ((juce::int64) statistics.meanCycles).paddedLeft (' ', 14) << juce::newLine;
+        }
+
+        return text << "(times in us)" << juce::newLine;
+    }
+
+private:
+    //==========================================================================
+    static juce::uint64 getTicks() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return (juce::uint64) juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    /** The time stamp counter's rate, measured against the clock since
+        prepare().
+     */
+    double getTicksPerSecond() const
+    {
+       #if JUCE_INTEL
+        const auto seconds = (juce::Time::getMillisecondCounterHiRes() - calibrationTime) * 0.001;
+
+        if (seconds > 0.01)
+            return (double) (getTicks() - calibrationTicks) / seconds;
+       #endif
+
+        return (double) juce::Time::getHighResolutionTicksPerSecond();
+    }
+
+    //==========================================================================
+    /** Tick counts in log-spaced buckets, four per octave. */
+    struct StageHistogram
+    {
+        static constexpr int bucketsPerOctave = 4;
+        static constexpr int numBuckets = 48 * bucketsPerOctave;
+
+        std::array<std::atomic<juce::uint64>, numBuckets> counts;
+        std::atomic<juce::uint64> total { 0 }, worst { 0 };
+
+        StageHistogram()        { clear(); }
+
+        void clear()
+        {
+            for (auto& count : counts)
+                count.store (0, std::memory_order_relaxed);
+
+            total.store (0, std::memory_order_relaxed);
+            worst.store (0, std::memory_order_relaxed);
+        }
+
+        void add (juce::uint64 ticks) noexcept
+        {
+            auto& count = counts[(size_t) getBucket (ticks)];
+            count.store (count.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            total.store (total.load (std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+
+            if (ticks > worst.load (std::memory_order_relaxed))
+                worst.store (ticks, std::memory_order_relaxed);
+        }
+
+        juce::uint64 getNumReadings() const noexcept
+        {
+            juce::uint64 numReadings = 0;
+
+            for (auto& count : counts)
+                numReadings += count.load (std::memory_order_relaxed);
+
+            return numReadings;
+        }
+
+        /** The upper edge of the bucket the percentile falls in, in ticks. */
+        double getPercentile (double fraction) const noexcept
+        {
+            const auto numReadings = getNumReadings();
+            const auto target = (juce::uint64) std::ceil (fraction * (double) numReadings);
+            juce::uint64 seen = 0;
+
+            for (int bucket = 0; bucket < numBuckets; ++bucket)
+            {
+                seen += counts[(size_t) bucket].load (std::memory_order_relaxed);
+
+                if (seen >= target && seen > 0)
+                    return getBucketEnd (bucket);
+            }
+
+            return 0.0;
+        }
+
+        /** Values below 4 have a bucket each; above, the octave and the two
+            bits after the leading one pick the bucket.
+         */
+        static int getBucket (juce::uint64 ticks) noexcept
+        {
+            if (ticks < (juce::uint64) bucketsPerOctave)
+                return (int) ticks;
+
+            int octave = 0;
+
+            for (auto value = ticks; value >= 8; value >>= 1)
+                ++octave;
+
+            const auto fraction = (int) (ticks >> octave) & (bucketsPerOctave - 1);
+            return juce::jmin (numBuckets - 1, (octave + 1) * bucketsPerOctave + fraction);
+        }
+
+        static double getBucketEnd (int bucket) noexcept
+        {
+            if (bucket < bucketsPerOctave)
+                return (double) (bucket + 1);
+
+            const int octave = bucket / bucketsPerOctave - 1;
+            const int fraction = bucket % bucketsPerOctave;
+            return std::ldexp ((double) (bucketsPerOctave + fraction + 1), octave);
+        }
+    };
+
+    /** Block load as a fraction of the deadline, in 1% buckets up to 400%. */
+    struct LoadHistogram
+    {
+        static constexpr int numBuckets = 400;
+
+        std::array<std::atomic<juce::uint32>, numBuckets> counts;
+
+        LoadHistogram()         { clear(); }
+
+        void clear()
+        {
+            for (auto& count : counts)
+                count.store (0, std::memory_order_relaxed);
+        }
+
+        void add (double load) noexcept
+        {
+            auto& count = counts[(size_t) juce::jlimit (0, numBuckets - 1, (int) (load * 100.0))];
+            count.store (count.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        double getPercentile (double fraction) const noexcept
+        {
+            juce::uint64 numReadings = 0;
+
+            for (auto& count : counts)
+                numReadings += count.load (std::memory_order_relaxed);
+
+            const auto target = (juce::uint64) std::ceil (fraction * (double) numReadings);
+            juce::uint64 seen = 0;
+
+            for (int bucket = 0; bucket < numBuckets; ++bucket)
+            {
+                seen += counts[(size_t) bucket].load (std::memory_order_relaxed);
+
+                if (seen >= target && seen > 0)
+                    return (bucket + 1) * 0.01;
+            }
+
+            return 0.0;
+        }
+    };
+
+    //==========================================================================
+    double sampleRate = 0.0;
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+
+    std::array<StageHistogram, numStages> stageHistograms;
+    LoadHistogram loadHistogram;
+    std::atomic<juce::uint64> numOverruns { 0 };
+
+    juce::uint64 calibrationTicks = 0;
+    double calibrationTime = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessorProfiler)
+};
@@ -14,6 +14,10 @@
  
     Supports a single writer (producer) and any number of readers (consumers).
  
+    The channels are allocated with AudioBuffer::AllocationPolicy::aligned, so
+    each starts on a cache line and the copies in and out can use aligned
+    vector loads and stores.
+ 
     Make sure that the number of samples read from the RingBuffer in every
     readSamples() call is less than the bufferSize specified in the constructor.
  
@@ -36,7 +40,8 @@ public:
         this->bufferSize = bufferSize;
         this->numChannels = numChannels;
         
-        audioBuffer = std::make_unique<juce::AudioBuffer<Type>> (numChannels, bufferSize);
+        audioBuffer = std::make_unique<juce::AudioBuffer<Type>> (numChannels, bufferSize,
+                                                                 juce::AudioBuffer<Type>::AllocationPolicy::aligned);
         audioBuffer->clear();
         writePosition = 0;
     }
@@ -160,6 +165,14 @@ public:
     int getBufferSize() {
         return bufferSize;
     }
+    
+    /** Returns the position the next sample will be written to. Readers can
+        compare it between calls to find out how many samples are new.
+     */
+    int getWritePosition() const
+    {
+        return writePosition.get() % bufferSize;
+    }
   
 private:
     int bufferSize;
@@ -0,0 +1,251 @@
+//
+//  ScopeAnalysis.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "AnalysisGraph.h"
+#include "SlidingDFT.h"
+#include <array>
+#include <vector>
+
+#define VIZ_POINTS  512
+
+/** Everything the scope's fragment shader draws from: the waveform and the
+    colour and pulse terms. One of these describes a frame completely, so it
+    can be handed to a renderer on another thread, or stored.
+ */
+struct ScopeFrame
+{
+    std::array<float, VIZ_POINTS> samples {};
+
+    float warmth = 0.0f, cool = 0.0f;
+    float beatPhase = 0.0f, onset = 0.0f;
+    std::array<float, 3> harmonyColour { { 1.0f, 1.0f, 1.0f } };
+    float harmonyMix = 0.0f;
+};
+
+//==============================================================================
+/** The per-frame analysis behind the scope, shared by Vizz and the offline
+    renderer.
+
+    It keeps the waveform in sync with the last frame, and smooths the colour,
+    onset and harmony terms over time. Time only enters through the frame's
+    delta time, so stepping it at a fixed rate gives the same frames on any
+    machine. The state is plain data and can be copied.
+ */
+class ScopeAnalysis
+{
+public:
+    /** How the warmth and cool colour terms are measured. */
+    enum class AnalysisMode
+    {
+        fft,        // Band levels from the shared FFT frames
+        slidingDFT, // A few SlidingDFT bins tracked by the processor
+        chroma      // As fft, but coloured by the chord from a Chromagram
+    };
+
+    /** Readings from the analysis stages for one frame. */
+    struct Inputs
+    {
+        float warmth = 0.0f, cool = 0.0f;       // Band levels, see measureBands()
+        int numOnsets = 0;
+        float onsetStrength = 0.0f;
+        float beatPhase = 0.0f;
+        bool useHarmony = false;
+        bool hasChord = false;
+        juce::Colour chordColour;
+    };
+
+    /** The samples the scope reads every frame: the waveform is synced
+        within them.
+     */
+    static constexpr int ringBufferSize = 2048 + 1024;
+
+    ScopeAnalysis() = default;
+
+    /** Averages both channels of the latest samples in blocks of zoom, which
+        stretches the waveform across the view.
+
+        The channels are mixed in one vectorised pass, then each block is
+        summed in place into the front of the result.
+     */
+    static void downmix (const juce::AudioBuffer<float>& samples, int numSamples, int zoom, std::vector<float>& result)
+    {
+        zoom = juce::jlimit (1, 4, zoom);
+        const int numPoints = numSamples / zoom;
+        result.assign ((size_t) (numPoints * zoom), 0.0f);
+
+        const float* left = samples.getReadPointer (0);
+        const float* right = samples.getReadPointer (samples.getNumChannels() > 1 ? 1 : 0);
+        const float scale = 1.0f / (2.0f * (float) zoom);
+
+        juce::FloatVectorOperations::addWithMultiply2 (result.data(), left, scale, right, scale, numPoints * zoom);
+
+        if (zoom > 1)
+        {
+            for (int i = 0; i < numPoints; ++i)
+            {
+                float sum = result[(size_t) (i * zoom)];
+
+                for (int j = 1; j < zoom; ++j)
+                    sum += result[(size_t) (i * zoom + j)];
+
+                result[(size_t) i] = sum;
+            }
+
+            result.resize ((size_t) numPoints);
+        }
+    }
+
+    /** Advances by one frame.
+
+        @param current      the downmixed samples, at least VIZ_POINTS of them
+        @param deltaTime    seconds since the last frame
+     */
+    void process (const std::vector<float>& current, float deltaTime, const Inputs& inputs)
+    {
+        jassert (current.size() >= (size_t) VIZ_POINTS);
+
+        // Keep the waveform where it correlates best with the last frame, so
+        // periodic signals stand still
+        const size_t numOffsets = current.size() - VIZ_POINTS + 1;
+        size_t syncPosition = 0;
+        float bestCorrelation = 0.0f;
+
+        for (size_t offset = 0; offset < numOffsets; ++offset)
+        {
+            const auto sum = juce::FloatVectorOperations::dotProduct (current.data() + offset, frame.samples.data(), VIZ_POINTS);
+
+            if (offset == 0 || sum > bestCorrelation)
+            {
+                bestCorrelation = sum;
+                syncPosition = offset;
+            }
+        }
+
+        std::copy (current.begin() + (long) syncPosition, current.begin() + (long) syncPosition + VIZ_POINTS, frame.samples.begin());
+
+        // Peak hold with an exponential release
+        const float colourDecay = std::exp (-deltaTime / colourDecayTime);
+        frame.warmth = juce::jmin (1.0f, juce::jmax (frame.warmth, inputs.warmth)) * colourDecay;
+        frame.cool = juce::jmin (1.0f, juce::jmax (frame.cool, inputs.cool)) * colourDecay;
+
+        // Onsets jump straight up and then fade
+        frame.onset *= std::exp (-deltaTime / onsetDecayTime);
+
+        if (inputs.numOnsets != lastNumOnsets)
+        {
+            lastNumOnsets = inputs.numOnsets;
+            frame.onset = juce::jmax (frame.onset, inputs.onsetStrength);
+        }
+
+        frame.beatPhase = inputs.beatPhase;
+
+        // Harmony colour: fades in and out with the chroma mode, and from
+        // chord to chord
+        const float harmonyAmount = 1.0f - std::exp (-deltaTime / harmonyFadeTime);
+        frame.harmonyMix += harmonyAmount * ((inputs.useHarmony ? 1.0f : 0.0f) - frame.harmonyMix);
+
+        if (inputs.hasChord)
+        {
+            frame.harmonyColour[0] += harmonyAmount * (inputs.chordColour.getFloatRed() - frame.harmonyColour[0]);
+            frame.harmonyColour[1] += harmonyAmount * (inputs.chordColour.getFloatGreen() - frame.harmonyColour[1]);
+            frame.harmonyColour[2] += harmonyAmount * (inputs.chordColour.getFloatBlue() - frame.harmonyColour[2]);
+        }
+    }
+
+    const ScopeFrame& getFrame() const noexcept     { return frame; }
+
+    //==========================================================================
+    /** The FFT every band measurement expects, see measureBands(). */
+    static AnalysisGraph::Request getBandsRequest() noexcept
+    {
+        return { 12, 1024, AnalysisWindow::hann };
+    }
+
+    /** Measures warmth and cool as the equivalent sine amplitude of the energy
+        below warmthMaxFrequency and above coolMinFrequency. A Hann-windowed
+        sine spreads 1.5 A^2 over its bins.
+     */
+    static void measureBands (const FFTFrame& frame, float& warmth, float& cool) noexcept
+    {
+        float warmthEnergy = 0.0f, coolEnergy = 0.0f;
+
+        for (int bin = 1; bin < frame.getNumBins(); ++bin)
+        {
+            const float frequency = frame.getBinFrequency (bin);
+            const float energy = frame.magnitudes[bin] * frame.magnitudes[bin];
+
+            if (frequency < warmthMaxFrequency)
+                warmthEnergy += energy;
+            else if (frequency > coolMinFrequency)
+                coolEnergy += energy;
+        }
+
+        warmth = warmthScale * std::sqrt (warmthEnergy / 1.5f);
+        cool = coolScale * std::sqrt (coolEnergy / 1.5f);
+    }
+
+    /** The sliding DFT bins are sine amplitudes already: averages the bass
+        bins for warmth and the treble bins for cool.
+     */
+    static void measureBands (const SlidingDFT& slidingDFT, float& warmth, float& cool) noexcept
+    {
+        int numWarmthBins = 0, numCoolBins = 0;
+        warmth = cool = 0.0f;
+
+        for (int bin = 0; bin < slidingDFT.getNumBins(); ++bin)
+        {
+            const float frequency = slidingDFT.getFrequency (bin);
+
+            if (frequency < warmthMaxFrequency)
+            {
+                warmth += slidingDFT.getMagnitude (bin);
+                ++numWarmthBins;
+            }
+            else if (frequency > coolMinFrequency)
+            {
+                cool += slidingDFT.getMagnitude (bin);
+                ++numCoolBins;
+            }
+        }
+
+        warmth = numWarmthBins > 0 ? 10.0f * warmth / numWarmthBins : 0.0f;
+        cool = numCoolBins > 0 ? 10.0f * cool / numCoolBins : 0.0f;
+    }
+
+    /** The frequencies the SlidingDFT should track for the sliding DFT mode:
+        log-spaced from the bass (warmth) to the treble (cool).
+     */
+    static juce::Array<float> getSlidingDFTFrequencies()
+    {
+        juce::Array<float> frequencies;
+
+        for (int i = 0; i < 24; ++i)
+            frequencies.add (40.0f * std::pow (300.0f, i / 23.0f));
+
+        return frequencies;
+    }
+
+private:
+    //==========================================================================
+    static constexpr float warmthMaxFrequency = 200.0f;
+    static constexpr float coolMinFrequency = 2000.0f;
+
+    // The scales keep roughly the response of the per-frame FFT the shared
+    // frames replaced
+    static constexpr float warmthScale = 7.5f;
+    static constexpr float coolScale = 1.0f;
+
+    // Time-based smoothing, in seconds. The colour release matches the old
+    // 0.99 per frame decay at 60 fps.
+    static constexpr float colourDecayTime = 1.66f;
+    static constexpr float onsetDecayTime = 0.15f;
+    static constexpr float harmonyFadeTime = 0.3f;
+
+    ScopeFrame frame;
+    int lastNumOnsets = 0;
+};
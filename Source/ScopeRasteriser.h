@@ -0,0 +1,193 @@
+//
+//  ScopeRasteriser.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ScopeAnalysis.h"
+#include <vector>
+
+/** Draws a ScopeFrame into a juce::Image on the CPU, pixel for pixel as the
+    scope's fragment shader in Vizz does. Keep the two in step.
+
+    It needs no GPU, so it is what the offline renderer uses, and what Vizz
+    falls back to when it cannot get an OpenGL context.
+
+    The waveform's height is the same down a column, and the shader's
+    vertical terms are the same along a row. So the image is drawn column by
+    column: the row terms are computed once, and each column runs down the
+    rows one dsp::SIMDRegister at a time. With a ThreadPool, bands of rows are
+    drawn on several threads.
+ */
+class ScopeRasteriser
+{
+public:
+    /** Fills the whole image, which must be RGB or ARGB.
+
+        @param pool     if not null, bands of rows are drawn on its threads
+                        as well as the calling one, which waits for them
+     */
+    static void render (const ScopeFrame& frame, juce::Image& image, juce::ThreadPool* pool = nullptr)
+    {
+        const int width = image.getWidth();
+        const int height = image.getHeight();
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::writeOnly);
+
+        const float pulse = frame.onset + 0.3f * std::pow (1.0f - frame.beatPhase, 4.0f);
+        const float thickness = 0.01f * (1.0f + pulse);
+
+        // The waveform's height depends on the column only
+        std::vector<float> amplitudes ((size_t) width);
+
+        for (int x = 0; x < width; ++x)
+            amplitudes[(size_t) x] = 0.5f - getAmplitudeForXPos (frame, (float) x + 0.5f, (float) width);
+
+        const int numBands = pool != nullptr ? juce::jmin (pool->getNumThreads() + 1, juce::jmax (1, height / minRowsPerBand)) : 1;
+
+        auto drawBand = [&] (int band)
+        {
+            drawRows (frame, thickness, amplitudes, pixels, image.getFormat(),
+                      height * band / numBands, height * (band + 1) / numBands, height);
+        };
+
+        if (numBands == 1)
+        {
+            drawBand (0);
+            return;
+        }
+
+        std::atomic<int> numRemaining { numBands - 1 };
+        juce::WaitableEvent finished;
+
+        for (int band = 1; band < numBands; ++band)
+        {
+            pool->addJob ([&drawBand, &numRemaining, &finished, band]
+            {
+                drawBand (band);
+
+                if (--numRemaining == 0)
+                    finished.signal();
+            });
+        }
+
+        drawBand (0);
+        finished.wait();
+    }
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+    static constexpr int numLanes = (int) Register::SIMDNumElements;
+    static constexpr int minRowsPerBand = 32;
+
+    /** The shader's getAmplitudeForXPos(): the first 256 points span the view. */
+    static float getAmplitudeForXPos (const ScopeFrame& frame, float xPos, float width) noexcept
+    {
+        const float perfectSamplePosition = 255.0f * xPos / width;
+        const int left = (int) std::floor (perfectSamplePosition);
+        const int right = (int) std::ceil (perfectSamplePosition);
+        const float fraction = perfectSamplePosition - (float) left;
+
+        return frame.samples[(size_t) left] + fraction * (frame.samples[(size_t) right] - frame.samples[(size_t) left]);
+    }
+
+    /** Row terms of the shader, one array per term, padded to whole registers. */
+    struct RowTerms
+    {
+        RowTerms (int numRows) : numPadded ((numRows + numLanes - 1) / numLanes * numLanes)
+        {
+            storage.calloc ((size_t) (numArrays * numPadded + numLanes));
+            auto* base = juce::snapPointerToAlignment (storage.get(), Register::SIMDRegisterSize);
+
+            y = base;
+            green = y + numPadded;
+            red = green + numPadded;
+            blue = red + numPadded;
+        }
+
+        static constexpr int numArrays = 4;
+        const int numPadded;
+        juce::HeapBlock<float> storage;
+        float* y;
+        float* green;   // -1.5 (y - 0.5)^2
+        float* red;     // 1.5 warmth^2 (1 - y)^2
+        float* blue;    // 2.5 cool^2 y^2
+    };
+
+    static void drawRows (const ScopeFrame& frame, float thickness, const std::vector<float>& amplitudes,
+                          const juce::Image::BitmapData& pixels, juce::Image::PixelFormat format,
+                          int startRow, int endRow, int height)
+    {
+        const int numRows = endRow - startRow;
+        RowTerms terms (numRows);
+
+        for (int i = 0; i < numRows; ++i)
+        {
+            // gl_FragCoord is at the pixel centre, with y going up
+            const float y = ((float) (height - 1 - (startRow + i)) + 0.5f) / (float) height;
+
+            terms.y[i] = y;
+            terms.green[i] = -1.5f * (y - 0.5f) * (y - 0.5f);
+            terms.red[i] = 1.5f * frame.warmth * frame.warmth * (1.0f - y) * (1.0f - y);
+            terms.blue[i] = 2.5f * frame.cool * frame.cool * y * y;
+        }
+
+        const auto mix = Register::expand (frame.harmonyMix);
+        const auto harmonyRed = Register::expand (frame.harmonyColour[0]);
+        const auto harmonyGreen = Register::expand (frame.harmonyColour[1]);
+        const auto harmonyBlue = Register::expand (frame.harmonyColour[2]);
+        const auto greenOffset = Register::expand (0.1f * frame.warmth * frame.warmth);
+        const auto zero = Register::expand (0.0f), one = Register::expand (1.0f);
+
+        alignas (Register::SIMDRegisterSize) float distance[numLanes];
+        alignas (Register::SIMDRegisterSize) float red[numLanes], green[numLanes], blue[numLanes];
+
+        for (int x = 0; x < (int) amplitudes.size(); ++x)
+        {
+            const auto amplitude = Register::expand (amplitudes[(size_t) x]);
+            auto* pixel = pixels.getPixelPointer (x, startRow);
+
+            for (int i = 0; i < numRows; i += numLanes)
+            {
+                // intensity = |thickness / (amplitude - y)| + 0.25. SIMDRegister
+                // has no division, but this fixed loop vectorises
+                Register::abs (amplitude - Register::fromRawArray (terms.y + i)).copyToRawArray (distance);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                    distance[lane] = thickness / distance[lane];
+
+                const auto intensity = Register::fromRawArray (distance) + 0.25f;
+                const auto intensity2 = intensity * intensity;
+
+                auto g = intensity * (Register::fromRawArray (terms.green + i) + 0.85f) + greenOffset;
+                auto r = intensity2 + Register::fromRawArray (terms.red + i) * g;
+                auto b = intensity2 * 0.7f + 0.10f + Register::fromRawArray (terms.blue + i) * g;
+
+                // Towards the harmony colour
+                const auto harmonic = intensity * 0.85f + 0.1f;
+                const auto white = intensity2 * 0.3f;
+                r += mix * (harmonyRed * harmonic + white - r);
+                g += mix * (harmonyGreen * harmonic + white - g);
+                b += mix * (harmonyBlue * harmonic + white - b);
+
+                (Register::min (one, Register::max (zero, r)) * 255.0f + 0.5f).copyToRawArray (red);
+                (Register::min (one, Register::max (zero, g)) * 255.0f + 0.5f).copyToRawArray (green);
+                (Register::min (one, Register::max (zero, b)) * 255.0f + 0.5f).copyToRawArray (blue);
+
+                const int numValid = juce::jmin (numLanes, numRows - i);
+
+                for (int lane = 0; lane < numValid; ++lane, pixel += pixels.lineStride)
+                    setPixel (pixel, format, (juce::uint8) red[lane], (juce::uint8) green[lane], (juce::uint8) blue[lane]);
+            }
+        }
+    }
+
+    static void setPixel (juce::uint8* pixel, juce::Image::PixelFormat format, juce::uint8 r, juce::uint8 g, juce::uint8 b) noexcept
+    {
+        if (format == juce::Image::RGB)
+            reinterpret_cast<juce::PixelRGB*> (pixel)->setARGB (255, r, g, b);
+        else
+            reinterpret_cast<juce::PixelARGB*> (pixel)->setARGB (255, r, g, b);
+    }
+};
@@ -0,0 +1,150 @@
+//
+//  SlidingDFT.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <array>
+#include <vector>
+
+/** A bank of sliding DFT bins that tracks a few chosen frequencies sample by
+    sample, without an FFT.
+
+    Every bin is an exponentially damped sliding DFT (a complex one-pole
+    resonator):
+
+        y[n] = x[n] + r * exp (i * w) * y[n - 1]
+
+    so it responds immediately, with no frame to fill and no windowing
+    latency. The time constant sets the trade-off between frequency
+    selectivity and response time: the bandwidth is about 1 / (pi * tau) Hz.
+
+    Bins are laid out as structure-of-arrays and updated several at a time
+    with dsp::SIMDRegister. process() is meant for the audio thread: it
+    neither allocates nor locks. The magnitudes and phases of the latest
+    sample are published through atomics, so any thread can read them.
+ */
+class SlidingDFT
+{
+public:
+    /** The largest number of bins the bank can track. */
+    static constexpr int maxNumBins = 64;
+
+    SlidingDFT() = default;
+
+    /** Sets the frequencies to track. Takes effect on the next prepare(). */
+    void setFrequencies (const juce::Array<float>& newFrequencies)
+    {
+        jassert (newFrequencies.size() <= maxNumBins);
+        frequencies = newFrequencies;
+        frequencies.resize (juce::jmin (frequencies.size(), maxNumBins));
+    }
+
+    /** Computes the coefficients and clears the state. Allocates, so call it
+        while the bank is not being processed.
+
+        @param sampleRate   sample rate of the audio passed to process()
+        @param timeConstant decay time of each bin, in seconds
+     */
+    void prepare (double sampleRate, double timeConstant = 0.05)
+    {
+        jassert (sampleRate > 0.0 && timeConstant > 0.0);
+
+        numBins = frequencies.size();
+        const int numBlocks = (numBins + Register::SIMDNumElements - 1) / Register::SIMDNumElements;
+
+        const auto r = std::exp (-1.0 / (timeConstant * sampleRate));
+        gain = (float) (2.0 * (1.0 - r));
+
+        real.assign ((size_t) numBlocks, Register (0.0f));
+        imag.assign ((size_t) numBlocks, Register (0.0f));
+        rotationReal.assign ((size_t) numBlocks, Register (0.0f));
+        rotationImag.assign ((size_t) numBlocks, Register (0.0f));
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto omega = juce::MathConstants<double>::twoPi * frequencies.getUnchecked (bin) / sampleRate;
+            const auto block = (size_t) (bin / Register::SIMDNumElements);
+            const auto lane = (size_t) (bin % Register::SIMDNumElements);
+
+            rotationReal[block].set (lane, (float) (r * std::cos (omega)));
+            rotationImag[block].set (lane, (float) (r * std::sin (omega)));
+        }
+
+        for (int bin = 0; bin < maxNumBins; ++bin)
+        {
+            magnitudes[(size_t) bin] = 0.0f;
+            phases[(size_t) bin] = 0.0f;
+        }
+    }
+
+    /** Runs the bank over a block, averaging the first two channels like the
+        scope does, and publishes the result.
+     */
+    void process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        const int numChannels = juce::jmin (2, buffer.getNumChannels());
+
+        if (numChannels == 0 || numBins == 0)
+            return;
+
+        const float* left = buffer.getReadPointer (0, startSample);
+        const float* right = buffer.getReadPointer (numChannels - 1, startSample);
+        const size_t numBlocks = real.size();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = Register::expand (0.5f * (left[i] + right[i]));
+
+            for (size_t b = 0; b < numBlocks; ++b)
+            {
+                const auto re = real[b];
+                const auto im = imag[b];
+
+                real[b] = x + rotationReal[b] * re - rotationImag[b] * im;
+                imag[b] = rotationImag[b] * re + rotationReal[b] * im;
+            }
+        }
+
+        publish();
+    }
+
+    int getNumBins() const noexcept                     { return numBins; }
+    float getFrequency (int bin) const noexcept         { return frequencies[bin]; }
+
+    /** Amplitude of the tracked sinusoid, 1.0 for a full-scale sine. */
+    float getMagnitude (int bin) const noexcept         { return magnitudes[(size_t) bin].load (std::memory_order_relaxed); }
+
+    /** Instantaneous phase of the tracked sinusoid, in radians. */
+    float getPhase (int bin) const noexcept             { return phases[(size_t) bin].load (std::memory_order_relaxed); }
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    void publish() noexcept
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto block = (size_t) (bin / Register::SIMDNumElements);
+            const auto lane = (size_t) (bin % Register::SIMDNumElements);
+            const auto re = real[block].get (lane);
+            const auto im = imag[block].get (lane);
+
+            magnitudes[(size_t) bin].store (gain * std::sqrt (re * re + im * im), std::memory_order_relaxed);
+            phases[(size_t) bin].store (std::atan2 (im, re), std::memory_order_relaxed);
+        }
+    }
+
+    juce::Array<float> frequencies;
+    int numBins = 0;
+    float gain = 0.0f;
+
+    // Resonator state and rotation (r * exp (i * w)), one lane per bin
+    std::vector<Register> real, imag, rotationReal, rotationImag;
+
+    std::array<std::atomic<float>, maxNumBins> magnitudes {}, phases {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SlidingDFT)
+};
@@ -9,34 +9,34 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
-#include "RingBuffer.h"
+#include "AnalysisGraph.h"
 
 /** Frequency Spectrum visualizer. Uses basic shaders, and calculates all points
     on the CPU as opposed to the OScilloscope3D which calculates points on the
     GPU.
+ 
+    The spectra come from an AnalysisGraph stage (1024 points, no window);
+    the renderer draws the latest one.
  */
 
 class Spectrum :    public juce::Component,
                     public juce::OpenGLRenderer,
-                    public juce::AsyncUpdater
+                    public juce::AsyncUpdater,
+                    private AnalysisGraph::Stage
 {
     
 public:
-  Spectrum (std::shared_ptr<RingBuffer<GLfloat>> ringBuffer)
-    :   readBuffer (2, ringBuffer->getBufferSize()),
-        forwardFFT (fftOrder)
+  Spectrum (std::shared_ptr<AnalysisGraph> graph)
+    :   analysisGraph (graph)
     {
         // Sets the version to 3.2
         openGLContext.setOpenGLVersionRequired (juce::OpenGLContext::OpenGLVersion::openGL3_2);
      
-        this->ringBuffer = ringBuffer;
+        analysisGraph->addStage (this);
         
         // Set default 3D orientation
         draggableOrientation.reset(juce::Vector3D<float>(0.0, 1.0, 0.0));
         
-        // Allocate FFT data
-        fftData = new GLfloat [2 * fftSize];
-        
         // Attach the OpenGL context but do not start [ see start() ]
         openGLContext.setRenderer(this);
         openGLContext.attachTo(*this);
@@ -53,10 +53,8 @@ public:
         openGLContext.setContinuousRepainting (false);
         openGLContext.detach();
         
-        delete [] fftData;
-        
-        // Detach ringBuffer
-        ringBuffer = nullptr;
+        // Stop receiving frames
+        analysisGraph->removeStage (this);
     }
     
     void handleAsyncUpdate() override
@@ -77,7 +75,7 @@ public:
         openGLContext.setContinuousRepainting (false);
     }
     
-    
+
     //==========================================================================
     // OpenGL Callbacks
     
@@ -162,37 +160,29 @@ public:
         shader->use();
         
         
-        // Copy data from ring buffer into FFT
-        
-        ringBuffer->readSamples (readBuffer, ringBuffer->getBufferSize());
-        juce::FloatVectorOperations::clear (fftData, ringBuffer->getBufferSize());
-        
-        /** Future Feature:
-            Instead of summing channels below, keep the channels seperate and
-            lay out the spectrum so you can see the left and right channels
-            individually on either half of the spectrum.
-         */
-        // Sum channels together
-        for (int i = 0; i < 2; ++i)
+        // Take the latest spectrum from the graph
         {
-            juce::FloatVectorOperations::add (fftData, readBuffer.getReadPointer(i, 0), ringBuffer->getBufferSize());
+            const juce::ScopedLock sl (levelsLock);
+            renderLevels = levels;
         }
         
-        // Calculate FFT Crap
-        forwardFFT.performFrequencyOnlyForwardTransform (fftData);
+        const int numBins = (int) renderLevels.size();
+        const GLfloat* fftData = renderLevels.data();
         
         // Find the range of values produced, so we can scale our rendering to
         // show up the detail clearly
-        juce::Range<float> maxFFTLevel = juce::FloatVectorOperations::findMinAndMax (fftData, fftSize / 2);
+        juce::Range<float> maxFFTLevel = numBins > 0 ? juce::FloatVectorOperations::findMinAndMax (fftData, numBins)
+                                                     : juce::Range<float>();
         
         // Calculate new y values and shift old y values back
-        for (int i = numVertices; i >= 0; --i)
+        for (int i = numVertices - 1; i >= 0; --i)
         {
             // For the first row of points, render the new height via the FFT
             if (i < xFreqResolution)
             {
                 const float skewedProportionY = 1.0f - std::exp (std::log (i / ((float) xFreqResolution - 1.0f)) * 0.2f);
-                const int fftDataIndex = juce::jlimit (0, fftSize / 2, (int) (skewedProportionY * fftSize / 2));
+                const int fftDataIndex = juce::jlimit (0, numBins - 1, (int) (skewedProportionY * (numBins - 1)));
+                
                 float level = 0.0f;
                 
                 if (maxFFTLevel.getEnd() != 0.0f)
@@ -230,9 +220,6 @@ public:
         glDrawArrays (GL_POINTS, 0, numVertices);
         
         
-        // Zero Out FFT for next use
-        juce::zeromem (fftData, sizeof (GLfloat) * 2 * fftSize);
-        
         // Reset the element buffers so child Components draw correctly
 //        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);
 //        openGLContext.extensions.glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -263,6 +250,20 @@ public:
     
 private:
     
+    //==========================================================================
+    // AnalysisGraph::Stage
+    
+    AnalysisGraph::Request getAnalysisRequest() const override
+    {
+        return { 10, 512, AnalysisWindow::rectangular };
+    }
+    
+    void processFrame (const FFTFrame& frame) override
+    {
+        const juce::ScopedLock sl (levelsLock);
+        levels.assign (frame.magnitudes, frame.magnitudes + frame.getNumBins());
+    }
+    
     //==========================================================================
     // Mesh Functions
     
@@ -427,17 +428,10 @@ private:
     juce::Draggable3DOrientation draggableOrientation;
     
     // Audio Structures
-    std::shared_ptr<RingBuffer<GLfloat>> ringBuffer;
-    juce::AudioBuffer<GLfloat> readBuffer;    // Stores data read from ring buffer
-    juce::dsp::FFT forwardFFT;
-    GLfloat * fftData;
-    
-    // This is so that we can initialize fowardFFT in the constructor with the order
-    enum
-    {
-        fftOrder = 10,
-        fftSize  = 1 << fftOrder // set 10th bit to one
-    };
+    std::shared_ptr<AnalysisGraph> analysisGraph;
+    std::vector<GLfloat> levels;          // Latest spectrum, written by the graph's thread
+    std::vector<GLfloat> renderLevels;    // The renderer's copy
+    juce::CriticalSection levelsLock;
     
     // Overlay GUI
     juce::String statusText;
@@ -0,0 +1,100 @@
+//
+//  SpectrumView.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <functional>
+
+/** Draws a spectrum trace from one of the analysers, over the scope.
+
+    Any analyser with createPath() and checkForNewData() will do: Analyser,
+    MultiResolutionAnalyser and FilterBankAnalyser all lay their traces out on
+    the same axis, ten octaves across the width from minFrequency. The view
+    polls its source on a timer and only rebuilds the path when there is new
+    data. It is transparent and lets the mouse through.
+ */
+class SpectrumView : public juce::Component,
+                     private juce::Timer
+{
+public:
+    static constexpr float minFrequency = 20.0f;
+
+    SpectrumView()
+    {
+        setInterceptsMouseClicks (false, false);
+    }
+
+    ~SpectrumView() override
+    {
+        stopTimer();
+    }
+
+    /** Draws from an analyser, which must outlive the view or be replaced
+        first. nullptr hides the trace.
+     */
+    template <typename AnalyserType>
+    void setSource (AnalyserType* analyser)
+    {
+        path.clear();
+        repaint();
+
+        if (analyser == nullptr)
+        {
+            stopTimer();
+            checkForNewData = nullptr;
+            createPath = nullptr;
+            return;
+        }
+
+        checkForNewData = [analyser] { return analyser->checkForNewData(); };
+        createPath = [analyser] (juce::Path& p, juce::Rectangle<float> bounds, float minFreq) { analyser->createPath (p, bounds, minFreq); };
+        startTimerHz (frameRate);
+    }
+
+    bool hasSource() const noexcept     { return createPath != nullptr; }
+
+    //==========================================================================
+    void paint (juce::Graphics& g) override
+    {
+        if (! hasSource())
+            return;
+
+        const auto bounds = getLocalBounds().toFloat();
+
+        // One line per octave
+        g.setColour (juce::Colours::white.withAlpha (0.12f));
+
+        for (int octave = 1; octave < 10; ++octave)
+            g.drawVerticalLine (juce::roundToInt (bounds.getX() + bounds.getWidth() * (float) octave / 10.0f), bounds.getY(), bounds.getBottom());
+
+        g.setColour (juce::Colours::white.withAlpha (0.8f));
+        g.strokePath (path, juce::PathStrokeType (1.5f));
+    }
+
+    void resized() override
+    {
+        if (hasSource())
+            createPath (path, getLocalBounds().toFloat(), minFrequency);
+    }
+
+private:
+    void timerCallback() override
+    {
+        if (! checkForNewData())
+            return;
+
+        createPath (path, getLocalBounds().toFloat(), minFrequency);
+        repaint();
+    }
+
+    static constexpr int frameRate = 30;
+
+    std::function<bool()> checkForNewData;
+    std::function<void (juce::Path&, juce::Rectangle<float>, float)> createPath;
+    juce::Path path;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumView)
+};
@@ -0,0 +1,318 @@
+//
+//  StandaloneApp.cpp
+//  Vizz
+//
+
+#include <JuceHeader.h>
+
+#if JucePlugin_Build_Standalone && JUCE_USE_CUSTOM_PLUGIN_STANDALONE_APP
+
+#include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#include "OfflineRenderer.h"
+#include "BatchAnalyser.h"
+#include "Benchmarks.h"
+#include <iostream>
+
+//==============================================================================
+/** Command-line tools of the standalone app. They run instead of the window
+    when the app is started with one of their options.
+ */
+static juce::ConsoleApplication createCommandLineTools()
+{
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand ("--help|-h", "Usage:", false);
+
+    app.addCommand ({ "--render",
+                      "--render <audio file> <output folder> [--size=1280x720] [--fps=60] [--zoom=2] "
+                      "[--mode=fft|sliding-dft|chroma] [--threads=n]",
+                      "Renders the scope for an audio file into a PNG sequence.",
+                      "Analyses the file at a fixed frame rate and draws every frame on the CPU, "
+                      "so it needs no GPU and gives the same images on every machine.",
+                      [] (const juce::ArgumentList& args)
+                      {
+                          args.checkMinNumArguments (3);
+                          const auto index = args.indexOfOption ("--render");
+                          const auto audioFile = args[index + 1].resolveAsExistingFile();
+                          const auto outputDirectory = args[index + 2].resolveAsFile();
+
+                          OfflineRenderer::Options options;
+
+                          if (args.containsOption ("--size"))
+                          {
+                              const auto size = args.getValueForOption ("--size");
+                              options.width = size.upToFirstOccurrenceOf ("x", false, true).getIntValue();
+                              options.height = size.fromFirstOccurrenceOf ("x", false, true).getIntValue();
+                          }
+
+                          if (args.containsOption ("--fps"))
+                              options.frameRate = args.getValueForOption ("--fps").getDoubleValue();
+
+                          if (args.containsOption ("--zoom"))
+                              options.zoom = args.getValueForOption ("--zoom").getIntValue();
+
+                          if (args.containsOption ("--threads"))
+                              options.numThreads = args.getValueForOption ("--threads").getIntValue();
+
+                          if (args.containsOption ("--mode"))
+                          {
+                              const auto mode = args.getValueForOption ("--mode");
+
+                              if (mode == "fft")                  options.analysisMode = ScopeAnalysis::AnalysisMode::fft;
+                              else if (mode == "sliding-dft")     options.analysisMode = ScopeAnalysis::AnalysisMode::slidingDFT;
+                              else if (mode == "chroma")          options.analysisMode = ScopeAnalysis::AnalysisMode::chroma;
+                              else                                juce::ConsoleApplication::fail ("Unknown mode: " + mode);
+                          }
+
+                          if (options.width <= 0 || options.height <= 0 || options.frameRate <= 0.0)
+                              juce::ConsoleApplication::fail ("Invalid size or frame rate");
+
+                          OfflineRenderer renderer (options);
+                          int lastReported = -1;
+
+                          renderer.onProgress = [&lastReported] (int numFramesWritten, int numFrames)
+                          {
+                              const auto percent = numFrames > 0 ? 100 * numFramesWritten / numFrames : 100;
+
+                              if (percent != lastReported)
+                              {
+                                  lastReported = percent;
+                                  std::cout << "\rRendering: " << percent << "%" << std::flush;
+                              }
+                          };
+
+                          const auto startTime = juce::Time::getMillisecondCounterHiRes();
+                          const auto result = renderer.render (audioFile, outputDirectory);
+                          std::cout << std::endl;
+
+                          if (result.failed())
+                              juce::ConsoleApplication::fail (result.getErrorMessage());
+
+                          std::cout << "Rendered in " << (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001
+                                    << " s" << std::endl;
+                      } });
+
+    app.addCommand ({ "--analyse",
+                      "--analyse <output folder> <audio files or folders>... [--threads=n] [--hop=4096] [--chunk=300]",
+                      "Analyses audio files into one JSON file each, for quality control.",
+                      "Measures the loudness, true peak, spectral centroid, warmth and cool curves and onset "
+                      "times of every file, searching folders recursively, and lists the results in summary.json. "
+                      "Long files are split into chunks of --chunk seconds, analysed in parallel.",
+                      [] (const juce::ArgumentList& args)
+                      {
+                          args.checkMinNumArguments (3);
+                          const auto index = args.indexOfOption ("--analyse");
+                          const auto outputDirectory = args[index + 1].resolveAsFile();
+
+                          BatchAnalyser::Options options;
+
+                          if (args.containsOption ("--threads"))
+                              options.numThreads = args.getValueForOption ("--threads").getIntValue();
+
+                          if (args.containsOption ("--hop"))
+                              options.curveHopSize = args.getValueForOption ("--hop").getIntValue();
+
+                          if (args.containsOption ("--chunk"))
+                              options.chunkLength = args.getValueForOption ("--chunk").getDoubleValue();
+
+                          if (options.curveHopSize <= 0 || options.chunkLength <= 0.0)
+                              juce::ConsoleApplication::fail ("Invalid hop size or chunk length");
+
+                          BatchAnalyser analyser (options);
+                          juce::Array<juce::File> files;
+
+                          for (int i = index + 2; i < args.size(); ++i)
+                          {
+                              if (args[i].isOption())
+                                  continue;
+
+                              const auto file = args[i].resolveAsFile();
+
+                              if (file.isDirectory())
+                              {
+                                  for (const auto& entry : juce::RangedDirectoryIterator (file, true, analyser.getWildcardForAllFormats()))
+                                      files.add (entry.getFile());
+                              }
+                              else if (file.existsAsFile())
+                              {
+                                  files.add (file);
+                              }
+                              else
+                              {
+                                  juce::ConsoleApplication::fail ("Could not find " + file.getFullPathName());
+                              }
+                          }
+
+                          if (files.isEmpty())
+                              juce::ConsoleApplication::fail ("No audio files to analyse");
+
+                          int lastReported = -1;
+
+                          analyser.onProgress = [&lastReported] (int numChunksDone, int numChunks)
+                          {
+                              const auto percent = numChunks > 0 ? 100 * numChunksDone / numChunks : 100;
+
+                              if (percent != lastReported)
+                              {
+                                  lastReported = percent;
+                                  std::cout << "\rAnalysing: " << percent << "%" << std::flush;
+                              }
+                          };
+
+                          const auto startTime = juce::Time::getMillisecondCounterHiRes();
+                          const auto result = analyser.analyse (files, outputDirectory);
+                          std::cout << std::endl;
+
+                          if (result.failed())
+                              juce::ConsoleApplication::fail (result.getErrorMessage());
+
+                          std::cout << "Analysed " << files.size() << " files in "
+                                    << (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001 << " s" << std::endl;
+                      } });
+
+    app.addCommand ({ "--benchmark",
+                      "--benchmark [--output=results.json] [--baseline=results.json] [--threshold=0.1] "
+                      "[--filter=name] [--time=0.25]",
+                      "Times the hot paths and writes the results as JSON.",
+                      "Runs micro-benchmarks of the RingBuffer, the scope's downmix and correlation sync and the "
+                      "FFT sizes in use, in ns/sample. With a baseline from an earlier run, fails if any median "
+                      "is slower than the baseline's by more than the threshold.",
+                      [] (const juce::ArgumentList& args)
+                      {
+                          Benchmarks::Options options;
+
+                          if (args.containsOption ("--filter"))
+                              options.filter = args.getValueForOption ("--filter");
+
+                          if (args.containsOption ("--time"))
+                              options.secondsPerBenchmark = args.getValueForOption ("--time").getDoubleValue();
+
+                          const auto threshold = args.containsOption ("--threshold")
+                                                    ? args.getValueForOption ("--threshold").getDoubleValue() : 0.1;
+
+                          juce::var baseline;
+
+                          if (args.containsOption ("--baseline"))
+                          {
+                              const auto baselineFile = args.getExistingFileForOption ("--baseline");
+                              const auto parsed = juce::JSON::parse (baselineFile.loadFileAsString(), baseline);
+
+                              if (parsed.failed())
+                                  juce::ConsoleApplication::fail ("Cannot parse " + baselineFile.getFullPathName() + ": " + parsed.getErrorMessage());
+                          }
+
+                          Benchmarks benchmarks (options);
+                          benchmarks.onBenchmarkStarted = [] (const juce::String& name) { std::cerr << name << std::endl; };
+
+                          auto results = benchmarks.run();
+                          juce::StringArray regressions;
+
+                          if (! baseline.isVoid())
+                              Benchmarks::compare (results, baseline, threshold, regressions);
+
+                          const auto json = juce::JSON::toString (results);
+
+                          if (args.containsOption ("--output"))
+                          {
+                              const auto outputFile = args.getFileForOption ("--output");
+
+                              if (! outputFile.replaceWithText (json))
+                                  juce::ConsoleApplication::fail ("Cannot write " + outputFile.getFullPathName());
+                          }
+                          else
+                          {
+                              std::cout << json << std::endl;
+                          }
+
+                          if (! regressions.isEmpty())
+                              juce::ConsoleApplication::fail ("Regressions against the baseline:\n  " + regressions.joinIntoString ("\n  "));
+                      } });
+
+    return app;
+}
+
+//==============================================================================
+/** JUCE's standalone plugin app, with the command-line tools above. */
+class VizzStandaloneApp : public juce::JUCEApplication
+{
+public:
+    VizzStandaloneApp()
+    {
+        juce::PluginHostType::jucePlugInClientCurrentWrapperType = juce::AudioProcessor::wrapperType_Standalone;
+
+        juce::PropertiesFile::Options options;
+
+        options.applicationName     = getApplicationName();
+        options.filenameSuffix      = ".settings";
+        options.osxLibrarySubFolder = "Application Support";
+       #if JUCE_LINUX
+        options.folderName          = "~/.config";
+       #else
+        options.folderName          = "";
+       #endif
+
+        appProperties.setStorageParameters (options);
+    }
+
+    const juce::String getApplicationName() override            { return JucePlugin_Name; }
+    const juce::String getApplicationVersion() override         { return JucePlugin_VersionString; }
+    bool moreThanOneInstanceAllowed() override                  { return true; }
+    void anotherInstanceStarted (const juce::String&) override  {}
+
+    //==========================================================================
+    void initialise (const juce::String& commandLine) override
+    {
+        const auto tools = createCommandLineTools();
+        const juce::ArgumentList args (getApplicationName(), commandLine);
+
+        if (tools.findCommand (args, false) != nullptr)
+        {
+            setApplicationReturnValue (tools.findAndRunCommand (args));
+            quit();
+            return;
+        }
+
+        mainWindow.reset (new juce::StandaloneFilterWindow (getApplicationName(),
+                                                            juce::LookAndFeel::getDefaultLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId),
+                                                            appProperties.getUserSettings(),
+                                                            false));
+        mainWindow->setVisible (true);
+    }
+
+    void shutdown() override
+    {
+        mainWindow = nullptr;
+        appProperties.saveIfNeeded();
+    }
+
+    //==========================================================================
+    void systemRequestedQuit() override
+    {
+        if (mainWindow != nullptr)
+            mainWindow->pluginHolder->savePluginState();
+
+        if (juce::ModalComponentManager::getInstance()->cancelAllModalComponents())
+        {
+            juce::Timer::callAfterDelay (100, []()
+            {
+                if (auto app = juce::JUCEApplicationBase::getInstance())
+                    app->systemRequestedQuit();
+            });
+        }
+        else
+        {
+            quit();
+        }
+    }
+
+private:
+    juce::ApplicationProperties appProperties;
+    std::unique_ptr<juce::StandaloneFilterWindow> mainWindow;
+};
+
+juce::JUCEApplicationBase* juce_CreateApplication()
+{
+    return new VizzStandaloneApp();
+}
+
+#endif
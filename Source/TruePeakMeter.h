@@ -0,0 +1,153 @@
+//
+//  TruePeakMeter.h
+//  Vizz
+//
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <array>
+
+/** True-peak meter after ITU-R BS.1770-4 Annex 2.
+
+    The signal is upsampled 4x by a 48-tap polyphase FIR, and the peak is
+    taken over the upsampled signal, catching the inter-sample overs that
+    a sample-peak meter misses.
+
+    Unlike dsp::Oversampling, the upsampled signal is never stored: the
+    four polyphase branches are evaluated together, one branch per
+    dsp::SIMDRegister lane, and only their running maximum is kept.
+
+    process() neither allocates nor locks, and the readings are atomics.
+ */
+class TruePeakMeter
+{
+public:
+    static constexpr int maxNumChannels = 8;
+
+    TruePeakMeter()
+    {
+        // Kaiser-windowed sinc with its cutoff at the original Nyquist
+        // frequency, scaled by the upsampling factor so each branch has
+        // unity gain
+        std::array<float, numTaps> prototype;
+        const double cutoff = 0.5 / upsampling;
+
+        for (int i = 0; i < numTaps; ++i)
+        {
+            const double t = i - 0.5 * (numTaps - 1);
+            prototype[(size_t) i] = (float) (upsampling * 2.0 * cutoff
+                                             * (t == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::twoPi * cutoff * t)
+                                                                  / (juce::MathConstants<double>::twoPi * cutoff * t)));
+        }
+
+        juce::dsp::WindowingFunction<float> window ((size_t) numTaps, juce::dsp::WindowingFunction<float>::kaiser, false, 5.0f);
+        window.multiplyWithWindowingTable (prototype.data(), (size_t) numTaps);
+
+        // Tap t of branch p is prototype[t * upsampling + p]
+        coefficients.fill (Register (0.0f));
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+            for (int phase = 0; phase < upsampling; ++phase)
+                coefficients[(size_t) tap].set ((size_t) phase, prototype[(size_t) (tap * upsampling + phase)]);
+
+        reset();
+    }
+
+    /** Clears the filter history and the held peaks. */
+    void reset()
+    {
+        for (auto& channelHistory : history)
+            channelHistory.fill (0.0f);
+
+        historyPosition.fill (0);
+        resetPeaks();
+    }
+
+    /** Clears the held peaks, keeping the filter history. */
+    void resetPeaks()
+    {
+        for (auto& peak : blockPeaks)
+            peak = 0.0f;
+
+        for (auto& peak : maxPeaks)
+            peak = 0.0f;
+    }
+
+    /** Measures a block of audio. Call from the audio thread. */
+    void process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        const int numChannels = juce::jmin (maxNumChannels, buffer.getNumChannels());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* samples = buffer.getReadPointer (ch, startSample);
+            auto& channelHistory = history[(size_t) ch];
+            int position = historyPosition[(size_t) ch];
+            Register peak (0.0f);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // The history is stored twice, so the newest tapsPerPhase
+                // samples are always contiguous
+                position = (position == 0 ? tapsPerPhase : position) - 1;
+                channelHistory[(size_t) position] = channelHistory[(size_t) (position + tapsPerPhase)] = samples[i];
+
+                Register out (0.0f);
+
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                    out += coefficients[(size_t) tap] * channelHistory[(size_t) (position + tap)];
+
+                peak = Register::max (peak, Register::abs (out));
+            }
+
+            historyPosition[(size_t) ch] = position;
+
+            float blockPeak = 0.0f;
+
+            for (size_t lane = 0; lane < Register::SIMDNumElements; ++lane)
+                blockPeak = juce::jmax (blockPeak, peak.get (lane));
+
+            blockPeaks[(size_t) ch] = blockPeak;
+
+            if (blockPeak > maxPeaks[(size_t) ch].load())
+                maxPeaks[(size_t) ch] = blockPeak;
+        }
+    }
+
+    /** The true peak of the last block, as linear gain. */
+    float getBlockPeak (int channel) const noexcept     { return blockPeaks[(size_t) channel].load(); }
+
+    /** The highest true peak since reset(), as linear gain. */
+    float getMaxPeak (int channel) const noexcept       { return maxPeaks[(size_t) channel].load(); }
+
+    /** The highest true peak on any channel since reset(), in dBTP. */
+    float getMaxPeakDecibels() const noexcept
+    {
+        float peak = 0.0f;
+
+        for (auto& channelPeak : maxPeaks)
+            peak = juce::jmax (peak, channelPeak.load());
+
+        return juce::Decibels::gainToDecibels (peak);
+    }
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int upsampling = 4;
+    static constexpr int numTaps = 48;
+    static constexpr int tapsPerPhase = numTaps / upsampling;
+
+    // With wider registers the spare lanes keep zero coefficients
+    static_assert (Register::SIMDNumElements >= upsampling, "One polyphase branch per SIMD lane");
+
+    std::array<Register, tapsPerPhase> coefficients;
+
+    std::array<std::array<float, 2 * tapsPerPhase>, maxNumChannels> history;
+    std::array<int, maxNumChannels> historyPosition;
+
+    std::array<std::atomic<float>, maxNumChannels> blockPeaks, maxPeaks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TruePeakMeter)
+};
@@ -2,20 +2,27 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "RingBuffer.h"
+#include "SlidingDFT.h"
+#include "OnsetTracker.h"
+#include "AnalysisGraph.h"
+#include "Chromagram.h"
+#include "ScopeAnalysis.h"
+#include "ScopeRasteriser.h"
 
 //#define RING_BUFFER_READ_SIZE   4096
-#define VIZ_POINTS  512
 
 #define _STR_HELPER(x) #x
 #define STR(x) _STR_HELPER(x)
 
 class Vizz : public juce::Component,
              public juce::OpenGLRenderer,
-             public juce::AsyncUpdater
+             public juce::AsyncUpdater,
+             private AnalysisGraph::Stage,
+             private juce::Timer
 {
 public:
     Vizz (std::shared_ptr<RingBuffer<GLfloat>> ringBuffer)
-            : readBuffer (2, ringBuffer->getBufferSize()), forwardFFT (fftOrder)
+            : readBuffer (2, ringBuffer->getBufferSize(), juce::AudioBuffer<GLfloat>::AllocationPolicy::aligned)
     {
         // Sets the OpenGL version to 3.2
         openGLContext.setOpenGLVersionRequired (juce::OpenGLContext::OpenGLVersion::openGL3_2);
@@ -41,14 +48,11 @@ public:
         //statusLabel.setJustificationType (juce::Justification::topLeft);
         //statusLabel.setFont (juce::Font (14.0f));
         
-        juce::FloatVectorOperations::clear (visualizationBuffer, VIZ_POINTS);
-
-        warmth = 0.0f;
-        cool = 0.0f;
     }
     
     ~Vizz()
     {
+        stopTimer();
         
         shader.release();
         uniforms.release();
@@ -61,6 +65,9 @@ public:
 
         // Detach ringBuffer
         ringBuffer = nullptr;
+        
+        // Stop receiving FFT frames
+        setAnalysisGraph (nullptr);
     }
     
     void handleAsyncUpdate() override
@@ -73,14 +80,29 @@ public:
 
     void start()
     {
+        if (softwareRendering)
+        {
+            startTimerHz (softwareFrameRate);
+            return;
+        }
+        
         openGLContext.setContinuousRepainting (true);
+        
+        // Give the context a moment to render once it is on screen, see
+        // timerCallback()
+        openGLCountdownStarted = false;
+        startTimer (openGLPollMs);
     }
   
     void stop()
     {
+        stopTimer();
         openGLContext.setContinuousRepainting (false);
     }
     
+    /** True once the scope has fallen back to drawing on the CPU. */
+    bool isSoftwareRendering() const noexcept   { return softwareRendering; }
+    
     
     //==========================================================================
     // OpenGL Callbacks
@@ -108,28 +130,19 @@ public:
         uniforms.release();
     }
     
-    // Normalized to the kernel_size
-    void convolution(float* arr, size_t arr_size, float* kernel, size_t kernel_size, std::vector<float>& res) {
-        if (res.size() != arr_size - kernel_size + 1) {
-            res = std::vector<float>(arr_size - kernel_size + 1, 0.0f);
-        }
-        
-        for (size_t start = 0; start < res.size(); start++) {
-            // Integrating
-            double sum = 0.0;
-            for (size_t i = 0; i < kernel_size; i++) {
-                sum += arr[i + start] * kernel[i];
-            }
-            res[start] = sum;
-        }
-    }
-    
     /** The OpenGL rendering callback.
      */
     void renderOpenGL() override
     {
         jassert (juce::OpenGLHelpers::isContextActive());
         
+        // A context that cannot compile the shader is as good as none, see
+        // timerCallback()
+        if (shader == nullptr || uniforms == nullptr)
+            return;
+        
+        openGLFrameRendered = true;
+        
         // Setup Viewport
         const float renderingScale = (float) openGLContext.getRenderingScale();
         glViewport (0, 0,
@@ -154,100 +167,25 @@ public:
         // Read in samples from ring buffer
         if (uniforms->audioSampleData != nullptr && ringBuffer != nullptr)
         {
-            if (zoom < 1) zoom = 1;
-            if (zoom > 4) zoom = 4;
-            float K = zoom;
-          
-            if (current.size() != ringBuffer->getBufferSize() / K) {
-                current = std::vector<float>(ringBuffer->getBufferSize() / K, 0.0);
-            } else {
-                std::fill(current.begin(), current.end(), 0.0);
-            }
-            
-            ringBuffer->readSamples (readBuffer, ringBuffer->getBufferSize());
-            
-            // Copying the data
-            for (int smp = 0; smp < ringBuffer->getBufferSize(); smp++) {
-                current[smp / K] += (*(float*)readBuffer.getReadPointer(0, smp) + *(float*)readBuffer.getReadPointer(1, smp)) / (2.0 * K);
-            }
+            const auto& frame = updateScopeFrame();
             
-            // Finding the correlation between current buffer and the former visualizationBuffer
-            convolution(&current[0], current.size(), visualizationBuffer, VIZ_POINTS, correlation);
+            uniforms->warmth->set ((GLfloat) frame.warmth);
+            uniforms->cool->set ((GLfloat) frame.cool);
             
-            float corr_max = correlation[0];
-            size_t sync_pos = 0;
-            for (int i = 0; i < correlation.size(); i++) {
-                if (correlation[i] > corr_max) {
-                    corr_max = correlation[i];
-                    sync_pos = i;
-                }
-            }
-            
-            //std::cout << "corr_max: " << corr_max << ", sync_pos: " << sync_pos << std::endl;
-            for (int i = 0; i < VIZ_POINTS; i++) {
-                visualizationBuffer[i] = current[i + sync_pos];
-            }
+            if (uniforms->beatPhase != nullptr)
+                uniforms->beatPhase->set ((GLfloat) frame.beatPhase);
             
-            // Using FFT to measure warmth
-            std::vector<std::complex<float>> input(fftSize), output(fftSize);
-            std::fill(std::begin(input), std::end(input), 0.0);
-            std::fill(std::begin(output), std::end(output), 0.0);
+            if (uniforms->onset != nullptr)
+                uniforms->onset->set ((GLfloat) frame.onset);
             
-            // Putting the samples into FFT buffer
-            for (int smp = 0; smp < fftSize; smp++) {
-                input[smp] += visualizationBuffer[smp];
-            }
-            forwardFFT.perform (&input[0], &output[0], false);
-            
-            // Searching for the max harmonic amplitude among the lowest ones
-            float max_harm = 0.0f;
-            
-            float avg_harm_warmth = 0.0f;
-            float avg_harm_warmth_norm = 0.0f;
-            float avg_harm_cool = 0.0f;
-            float avg_harm_cool_norm = 0.0f;
-
-            // Warmth should reflect low frequencies
-            for (int i = 0; i < 4; i++) {
-                if (std::abs(output[i].real()) > max_harm) {
-                    max_harm = std::abs(output[i].real());
-                }
-                avg_harm_warmth += std::abs(output[i].real()) / (i + 2);
-                avg_harm_warmth_norm += 12.0 / (i + 3);
-            }
-            avg_harm_warmth /= avg_harm_warmth_norm;
-            if (warmth < avg_harm_warmth) warmth = avg_harm_warmth;
-            if (warmth > 1.0) warmth = 1.0;
-            warmth *= 0.99;
-
-            // Cool should reflex high frequencies
-            for (int i = 20; i < fftSize / 2; i++) {
-                if (std::abs(output[i].real()) > max_harm) {
-                    max_harm = std::abs(output[i].real());
-                }
-                avg_harm_cool += 2.0 * std::abs(output[i].real()) * i;
-                avg_harm_cool_norm += i;
-            }
-            avg_harm_cool /= avg_harm_cool_norm;
-            if (cool < avg_harm_cool) cool = avg_harm_cool;
-            if (cool > 1.0) cool = 1.0;
-            cool *= 0.99;
-
-            /*int band = fftSize / 64;
-             if (max_harm_index < band) {
-             warmth = 1.0;
-             } else {
-             warmth = band / max_harm_index;
-             }*/
+            if (uniforms->harmonyColour != nullptr)
+                uniforms->harmonyColour->set (frame.harmonyColour[0], frame.harmonyColour[1], frame.harmonyColour[2]);
             
-            std::cout << "warmth: " << warmth << ", cool: " << cool << std::endl;
+            if (uniforms->harmonyMix != nullptr)
+                uniforms->harmonyMix->set ((GLfloat) frame.harmonyMix);
             
-
+            uniforms->audioSampleData->set (frame.samples.data(), VIZ_POINTS);
         }
-        
-        uniforms->warmth->set((GLfloat)warmth);
-        uniforms->cool->set((GLfloat)cool);
-        uniforms->audioSampleData->set(visualizationBuffer, VIZ_POINTS);
 
         // Define Vertices for a Square (the view plane)
         GLfloat vertices[] = {
@@ -303,11 +241,46 @@ public:
         this->zoom = zoom;
     }
     
+    using AnalysisMode = ScopeAnalysis::AnalysisMode;
+    
+    void setAnalysisMode(AnalysisMode mode)
+    {
+        analysisMode = mode;
+    }
+    
+    void setSlidingDFT(std::shared_ptr<SlidingDFT> slidingDFT)
+    {
+        this->slidingDFT = slidingDFT;
+    }
+    
+    void setOnsetTracker(std::shared_ptr<OnsetTracker> onsetTracker)
+    {
+        this->onsetTracker = onsetTracker;
+    }
+    
+    void setAnalysisGraph(std::shared_ptr<AnalysisGraph> analysisGraph)
+    {
+        if (this->analysisGraph != nullptr)
+            this->analysisGraph->removeStage (this);
+        
+        this->analysisGraph = analysisGraph;
+        
+        if (analysisGraph != nullptr)
+            analysisGraph->addStage (this);
+    }
+    
+    void setChromagram(std::shared_ptr<Chromagram> chromagram)
+    {
+        this->chromagram = chromagram;
+    }
+    
     //==========================================================================
     // JUCE Callbacks
     
     void paint (juce::Graphics& g) override
     {
+        if (softwareRendering && softwareImage.isValid())
+            g.drawImage (softwareImage, getLocalBounds().toFloat());
     }
     
     void resized () override
@@ -317,6 +290,139 @@ public:
     
 private:
     
+    //==========================================================================
+    /** Reads the latest samples and steps the scope's analysis by the time
+        since the last frame. Called from whichever renderer is active.
+     */
+    const ScopeFrame& updateScopeFrame()
+    {
+        // Time since the last frame, so that smoothing does not depend on
+        // the frame rate
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        const float deltaTime = lastFrameTime > 0.0 ? (float) juce::jlimit (0.0, 0.25, (now - lastFrameTime) * 0.001) : 0.0f;
+        lastFrameTime = now;
+        
+        ringBuffer->readSamples (readBuffer, ringBuffer->getBufferSize());
+        ScopeAnalysis::downmix (readBuffer, ringBuffer->getBufferSize(), zoom, current);
+        
+        ScopeAnalysis::Inputs inputs;
+        const auto mode = analysisMode.load();
+        
+        if (mode == AnalysisMode::slidingDFT && slidingDFT != nullptr)
+        {
+            ScopeAnalysis::measureBands (*slidingDFT, inputs.warmth, inputs.cool);
+        }
+        else
+        {
+            // Band levels from the shared FFT frames, see processFrame()
+            inputs.warmth = frameWarmth.load();
+            inputs.cool = frameCool.load();
+        }
+        
+        // The beat phase is already extrapolated to this frame by the
+        // tracker
+        if (onsetTracker != nullptr)
+        {
+            inputs.numOnsets = onsetTracker->getNumOnsets();
+            inputs.onsetStrength = onsetTracker->getOnsetStrength();
+            inputs.beatPhase = onsetTracker->getBeatPhase();
+        }
+        
+        if (chromagram != nullptr)
+        {
+            inputs.useHarmony = mode == AnalysisMode::chroma;
+            inputs.hasChord = true;
+            inputs.chordColour = chromagram->getChordColour();
+        }
+        
+        scopeAnalysis.process (current, deltaTime, inputs);
+        return scopeAnalysis.getFrame();
+    }
+    
+    //==========================================================================
+    // Software fallback
+    
+    /** While OpenGL is starting up, checks that it rendered a frame, and falls
+        back to the CPU if it did not. After that, draws the software frames.
+     */
+    void timerCallback() override
+    {
+        if (! softwareRendering)
+        {
+            // A hidden component gets no frames, so the countdown only runs
+            // while it is showing, and starts over each time it is shown
+            if (! isShowing())
+            {
+                if (openGLCountdownStarted)
+                {
+                    openGLCountdownStarted = false;
+                    startTimer (openGLPollMs);
+                }
+                
+                return;
+            }
+            
+            if (! openGLCountdownStarted)
+            {
+                openGLCountdownStarted = true;
+                startTimer (openGLTimeoutMs);
+                return;
+            }
+            
+            stopTimer();
+            
+            if (! openGLFrameRendered)
+                switchToSoftwareRendering();
+            
+            return;
+        }
+        
+        if (ringBuffer == nullptr || getWidth() <= 0 || getHeight() <= 0)
+            return;
+        
+        // Draw at the display's resolution
+        const float scale = (float) juce::Component::getApproximateScaleFactorForComponent (this);
+        const int width = juce::roundToInt (scale * getWidth());
+        const int height = juce::roundToInt (scale * getHeight());
+        
+        if (softwareImage.getWidth() != width || softwareImage.getHeight() != height)
+            softwareImage = juce::Image (juce::Image::RGB, width, height, false);
+        
+        ScopeRasteriser::render (updateScopeFrame(), softwareImage, softwareRasterPool.get());
+        repaint();
+    }
+    
+    /** For machines where no OpenGL context can be created, such as remote
+        desktops, VMs and CI: the context is dropped and the scope is drawn
+        by ScopeRasteriser on a timer instead.
+     */
+    void switchToSoftwareRendering()
+    {
+        openGLContext.setContinuousRepainting (false);
+        openGLContext.detach();
+        
+        softwareRendering = true;
+        softwareRasterPool = std::make_unique<juce::ThreadPool> (juce::jlimit (1, 3, juce::SystemStats::getNumCpus() - 1));
+        lastFrameTime = 0.0;
+        startTimerHz (softwareFrameRate);
+    }
+    
+    //==========================================================================
+    // AnalysisGraph::Stage
+    
+    AnalysisGraph::Request getAnalysisRequest() const override
+    {
+        return ScopeAnalysis::getBandsRequest();
+    }
+    
+    void processFrame (const FFTFrame& frame) override
+    {
+        float warmth, cool;
+        ScopeAnalysis::measureBands (frame, warmth, cool);
+        frameWarmth = warmth;
+        frameCool = cool;
+    }
+    
     //==========================================================================
     // OpenGL Functions
     
@@ -337,6 +443,10 @@ private:
         "uniform vec2  resolution;\n"
         "uniform float warmth;\n"
         "uniform float cool;\n"
+        "uniform float beatPhase;\n"
+        "uniform float onset;\n"
+        "uniform vec3  harmonyColour;\n"
+        "uniform float harmonyMix;\n"
         "uniform float audioSampleData[" STR(VIZ_POINTS) "];\n"
         "\n"
         "void getAmplitudeForXPos (in float xPos, out float audioAmplitude)\n"
@@ -357,12 +467,15 @@ private:
         "\n"
         // Centers & Reduces Wave Amplitude
         "    amplitude = 0.5 - amplitude;\n"
-        "    float intensity = abs (THICKNESS / (amplitude - y)) + 0.25;\n"
+        // The line swells on onsets and pulses on the beat
+        "    float pulse = onset + 0.3 * pow (1.0 - beatPhase, 4.0);\n"
+        "    float intensity = abs (THICKNESS * (1.0 + pulse) / (amplitude - y)) + 0.25;\n"
         "    float g = -1.5 * intensity * max(0, (y - 0.5) * (y - 0.5)) + 0.85 * intensity + 0.1 * warmth * warmth;\n"
         "    float r = intensity * intensity + 1.5 * warmth * warmth * g * (1 - y) * (1 - y); \n"
         "    float b = 0.7 * intensity * intensity + 0.10 + 2.5 * cool * cool * g * y * y; \n"
         "\n"
-        "    gl_FragColor = vec4 (r, g, b, 1.0);\n"
+        "    vec3 harmonic = harmonyColour * (0.85 * intensity + 0.1) + vec3 (0.3 * intensity * intensity);\n"
+        "    gl_FragColor = vec4 (mix (vec3 (r, g, b), harmonic, harmonyMix), 1.0);\n"
         "}\n";
         
         std::unique_ptr<juce::OpenGLShaderProgram> shaderProgramAttempt = std::make_unique<juce::OpenGLShaderProgram> (openGLContext);
@@ -400,6 +513,10 @@ private:
             warmth.reset (createUniform (openGLContext, shaderProgram, "warmth"));
             resolution.reset (createUniform (openGLContext, shaderProgram, "resolution"));
             audioSampleData.reset (createUniform (openGLContext, shaderProgram, "audioSampleData"));
+            beatPhase.reset (createUniform (openGLContext, shaderProgram, "beatPhase"));
+            onset.reset (createUniform (openGLContext, shaderProgram, "onset"));
+            harmonyColour.reset (createUniform (openGLContext, shaderProgram, "harmonyColour"));
+            harmonyMix.reset (createUniform (openGLContext, shaderProgram, "harmonyMix"));
             
         }
         
@@ -408,9 +525,14 @@ private:
             warmth = nullptr;
             resolution = nullptr;
             audioSampleData = nullptr;
+            beatPhase = nullptr;
+            onset = nullptr;
+            harmonyColour = nullptr;
+            harmonyMix = nullptr;
         }
         
-        std::unique_ptr<juce::OpenGLShaderProgram::Uniform> resolution, warmth, cool, audioSampleData;
+        std::unique_ptr<juce::OpenGLShaderProgram::Uniform> resolution, warmth, cool, audioSampleData, beatPhase, onset,
+                                                            harmonyColour, harmonyMix;
         
     private:
         static juce::OpenGLShaderProgram::Uniform* createUniform (juce::OpenGLContext& openGLContext,
@@ -431,38 +553,53 @@ private:
     std::unique_ptr<juce::OpenGLShaderProgram> shader;
     std::unique_ptr<Uniforms> uniforms;
     
-    float warmth, cool;
-    
     const char* vertexShader;
     const char* fragmentShader;
 
-    enum
-    {
-        fftOrder = 9,
-        fftSize  = 1 << fftOrder // set 10th bit to one
-    };
-    
     // Audio Buffer
     std::shared_ptr<RingBuffer<GLfloat>> ringBuffer;
     juce::AudioBuffer<GLfloat> readBuffer;    // Stores data read from ring buffer
-    GLfloat visualizationBuffer [VIZ_POINTS];    // Single channel to visualize
   
     int zoom;
     
+    // Waveform sync and the colour terms, stepped once per rendered frame
+    ScopeAnalysis scopeAnalysis;
+    double lastFrameTime = 0.0;
+    
+    // Software fallback, see switchToSoftwareRendering()
+    static constexpr int openGLTimeoutMs = 2000;
+    static constexpr int openGLPollMs = 100;        // While waiting to be shown
+    static constexpr int softwareFrameRate = 60;
+    std::atomic<bool> openGLFrameRendered { false };
+    bool openGLCountdownStarted = false;
+    bool softwareRendering = false;
+    juce::Image softwareImage;
+    std::unique_ptr<juce::ThreadPool> softwareRasterPool;
+    
+    // Sliding DFT analysis mode. Set on the message thread, read on the
+    // GL thread
+    std::atomic<AnalysisMode> analysisMode { AnalysisMode::fft };
+    std::shared_ptr<SlidingDFT> slidingDFT;
+    
+    // Warmth and cool from the shared FFT frames
+    std::shared_ptr<AnalysisGraph> analysisGraph;
+    std::atomic<float> frameWarmth { 0.0f }, frameCool { 0.0f };
+    
+    // Harmony colouring, see AnalysisMode::chroma
+    std::shared_ptr<Chromagram> chromagram;
+    
+    // Onset and beat tracking
+    std::shared_ptr<OnsetTracker> onsetTracker;
+    
     // Overlay GUI
     /*juce::String statusText;
     juce::Label statusLabel;*/
   
-    // FFT
-    juce::dsp::FFT forwardFFT;
     //GLfloat * fftData;
     //size_t sample_index[1];
                 
     std::vector<float> current;
-    std::vector<float> correlation;
 
-    // This is so that we can initialize fowardFFT in the constructor with the order
-    
    
     /** DEV NOTE
         If I wanted to optionally have an interchangeable shader system,